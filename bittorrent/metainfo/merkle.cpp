@@ -0,0 +1,206 @@
+#include "merkle.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <openssl/sha.h>
+
+
+using namespace bittorrent::metainfo;
+
+
+
+static std::size_t next_pow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+static unsigned log2_exact(std::size_t n) {
+    unsigned l = 0;
+    while ((std::size_t(1) << l) < n) ++l;
+    return l;
+}
+
+// Reduce one row in place until a single node remains; 'row' must be a power of two.
+static Sha256Hash reduce_row(std::vector<Sha256Hash> row) {
+    while (row.size() > 1) {
+        for (std::size_t i = 0; i < row.size() / 2; ++i) {
+            row[i] = merkle::hashPair(row[2*i], row[2*i + 1]);
+        }
+        row.resize(row.size() / 2);
+    }
+    return row.front();
+}
+
+
+// -------------------------- merkle helpers ---------------------------
+
+Sha256Hash merkle::sha256(const void* data, std::size_t len) {
+    Sha256Hash out;
+    SHA256(static_cast<const unsigned char*>(data), len, out.data());
+    return out;
+}
+
+Sha256Hash merkle::hashPair(const Sha256Hash& left, const Sha256Hash& right) {
+    unsigned char buf[64];
+    std::memcpy(buf, left.data(), 32);
+    std::memcpy(buf + 32, right.data(), 32);
+    return sha256(buf, sizeof(buf));
+}
+
+Sha256Hash merkle::padHash(unsigned level) {
+    Sha256Hash h{};
+    for (unsigned i = 0; i < level; ++i) h = hashPair(h, h);
+    return h;
+}
+
+std::vector<Sha256Hash> merkle::blockHashes(std::string_view data) {
+    std::vector<Sha256Hash> out;
+    out.reserve((data.size() + kBlockSize - 1) / kBlockSize);
+    for (std::size_t off = 0; off < data.size(); off += kBlockSize) {
+        auto len = std::min(kBlockSize, data.size() - off);
+        out.push_back(sha256(data.data() + off, len));
+    }
+    return out;
+}
+
+Sha256Hash merkle::rootFromLeaves(const std::vector<Sha256Hash>& leaves, std::size_t minLeaves) {
+    std::vector<Sha256Hash> row(leaves);
+    row.resize(next_pow2(std::max(minLeaves, leaves.size())), Sha256Hash{});
+    return reduce_row(std::move(row));
+}
+
+std::vector<Sha256Hash> merkle::pieceLayerFromLeaves(const std::vector<Sha256Hash>& leaves, uint32_t pieceLength) {
+    const std::size_t per = pieceLength / kBlockSize;
+    std::vector<Sha256Hash> layer;
+    layer.reserve((leaves.size() + per - 1) / per);
+
+    for (std::size_t i = 0; i < leaves.size(); i += per) {
+        std::vector<Sha256Hash> sub(leaves.begin() + i, leaves.begin() + std::min(i + per, leaves.size()));
+        layer.push_back(rootFromLeaves(sub, per));
+    }
+    return layer;
+}
+
+Sha256Hash merkle::rootFromPieceLayer(const std::vector<Sha256Hash>& layer, uint32_t pieceLength) {
+    std::vector<Sha256Hash> row(layer);
+    row.resize(next_pow2(row.size()), padHash(log2_exact(pieceLength / kBlockSize)));
+    return reduce_row(std::move(row));
+}
+
+
+// -------------------------- MerkleVerifier ---------------------------
+
+MerkleVerifier::MerkleVerifier(const Sha256Hash& piecesRoot, uint64_t fileLength, uint32_t pieceLength,
+                               std::vector<Sha256Hash> pieceLayer)
+    : fileLength_(fileLength), root_(piecesRoot), layer_(std::move(pieceLayer))
+{
+    if (pieceLength < merkle::kBlockSize || (pieceLength & (pieceLength - 1)) != 0)
+        throw std::runtime_error("merkle: piece length must be a power of two >= 16 KiB");
+    if (fileLength == 0) throw std::runtime_error("merkle: empty files have no tree");
+
+    blocksPerPiece_ = pieceLength / merkle::kBlockSize;
+    blockCount_ = static_cast<std::size_t>((fileLength + merkle::kBlockSize - 1) / merkle::kBlockSize);
+    pieceCount_ = static_cast<std::size_t>((fileLength + pieceLength - 1) / pieceLength);
+
+    if (pieceCount_ > 1) {
+        if (layer_.size() != pieceCount_) throw std::runtime_error("merkle: piece layer size mismatch");
+        if (merkle::rootFromPieceLayer(layer_, pieceLength) != root_)
+            throw std::runtime_error("merkle: piece layer does not match pieces root");
+    }
+
+    known_.resize(blockCount_);
+    received_.resize(blockCount_);
+    pieceDone_.assign(pieceCount_, 0);
+}
+
+Sha256Hash MerkleVerifier::expectedNode(std::size_t piece) const {
+    return pieceCount_ == 1 ? root_ : layer_[piece];
+}
+
+std::size_t MerkleVerifier::leavesInSubtree(std::size_t) const {
+    // A single-piece file is its own tree: leaves padded to a power of two, not to the piece.
+    return pieceCount_ == 1 ? next_pow2(blockCount_) : blocksPerPiece_;
+}
+
+std::pair<std::size_t, std::size_t> MerkleVerifier::blockRange(std::size_t piece) const {
+    const std::size_t first = piece * blocksPerPiece_;
+    return {first, std::min(first + blocksPerPiece_, blockCount_)};
+}
+
+bool MerkleVerifier::addPieceLeaves(std::size_t piece, const std::vector<Sha256Hash>& leaves) {
+    if (piece >= pieceCount_) return false;
+
+    auto [first, last] = blockRange(piece);
+    if (leaves.size() != last - first) return false;
+    if (merkle::rootFromLeaves(leaves, leavesInSubtree(piece)) != expectedNode(piece)) return false;
+
+    for (std::size_t b = first; b < last; ++b) {
+        known_[b] = leaves[b - first];
+
+        // Judge blocks that arrived before their hashes did
+        if (received_[b] && *received_[b] != *known_[b]) {
+            received_[b].reset();
+            failed_.push_back(b);
+        }
+    }
+
+    tryCompletePiece(piece);
+    return true;
+}
+
+MerkleVerifier::BlockStatus MerkleVerifier::submitBlock(std::size_t block, std::string_view data) {
+    if (block >= blockCount_) return BlockStatus::failed;
+
+    const uint64_t expectLen = (block + 1 < blockCount_)
+        ? merkle::kBlockSize
+        : fileLength_ - uint64_t(blockCount_ - 1) * merkle::kBlockSize;
+    if (data.size() != expectLen) return BlockStatus::failed;
+
+    const std::size_t piece = block / blocksPerPiece_;
+    const Sha256Hash h = merkle::sha256(data.data(), data.size());
+
+    if (known_[block]) {
+        if (h != *known_[block]) return BlockStatus::failed;
+        received_[block] = h;
+        tryCompletePiece(piece);
+        return BlockStatus::verified;
+    }
+
+    received_[block] = h;
+    return tryCompletePiece(piece);
+}
+
+MerkleVerifier::BlockStatus MerkleVerifier::tryCompletePiece(std::size_t piece) {
+    if (pieceDone_[piece]) return BlockStatus::verified;
+
+    auto [first, last] = blockRange(piece);
+    std::vector<Sha256Hash> leaves;
+    leaves.reserve(last - first);
+    for (std::size_t b = first; b < last; ++b) {
+        if (!received_[b]) return BlockStatus::pending;
+        leaves.push_back(*received_[b]);
+    }
+
+    if (merkle::rootFromLeaves(leaves, leavesInSubtree(piece)) == expectedNode(piece)) {
+        for (std::size_t b = first; b < last; ++b) known_[b] = received_[b];
+        pieceDone_[piece] = 1;
+        return BlockStatus::verified;
+    }
+
+    // Without leaf hashes the bad block cannot be singled out: drop the whole piece.
+    for (std::size_t b = first; b < last; ++b) {
+        received_[b].reset();
+        failed_.push_back(b);
+    }
+    return BlockStatus::failed;
+}
+
+std::vector<std::size_t> MerkleVerifier::takeFailedBlocks() {
+    std::vector<std::size_t> out;
+    out.swap(failed_);
+    return out;
+}
+
+bool MerkleVerifier::pieceVerified(std::size_t piece) const {
+    return piece < pieceCount_ && pieceDone_[piece] != 0;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <optional>
+
+
+namespace bittorrent::metainfo {
+
+    using Sha256Hash = std::array<uint8_t,32>;
+
+    // BEP 52 merkle helpers. Leaves are SHA-256 of 16 KiB blocks (the last block of a
+    // file may be short); leaf rows are padded to a power of two with zero hashes.
+    namespace merkle {
+
+        constexpr std::size_t kBlockSize = 16 * 1024;
+
+        Sha256Hash sha256(const void* data, std::size_t len);
+        Sha256Hash hashPair(const Sha256Hash& left, const Sha256Hash& right);
+
+        // Root of an all-zero subtree 'level' layers above the leaves (level 0 == zero leaf).
+        Sha256Hash padHash(unsigned level);
+
+        std::vector<Sha256Hash> blockHashes(std::string_view data);
+
+        // Root over 'leaves' padded to max(minLeaves, next power of two) with zero leaves.
+        Sha256Hash rootFromLeaves(const std::vector<Sha256Hash>& leaves, std::size_t minLeaves = 1);
+
+        // "piece layers" entry for a file: one node per pieceLength bytes.
+        std::vector<Sha256Hash> pieceLayerFromLeaves(const std::vector<Sha256Hash>& leaves, uint32_t pieceLength);
+        Sha256Hash rootFromPieceLayer(const std::vector<Sha256Hash>& layer, uint32_t pieceLength);
+
+    } // namespace merkle
+
+
+    /**
+     * @brief Block-level verifier for one file of a v2 torrent.
+     *
+     * Each piece is checked against its node in the piece layer (or against the file
+     * root when the file fits in a single piece). Without leaf hashes, blocks are
+     * buffered as hashes and the whole piece is judged once its last block arrives.
+     * Once the piece's leaf hashes are known (BEP 52 hash messages, already checked
+     * against the piece node), every block is accepted or rejected on arrival.
+     */
+    class MerkleVerifier
+    {
+    public:
+        enum class BlockStatus { verified, failed, pending };
+
+        MerkleVerifier(const Sha256Hash& piecesRoot, uint64_t fileLength, uint32_t pieceLength,
+                       std::vector<Sha256Hash> pieceLayer = {});
+
+        // Install the 16 KiB leaf hashes for one piece. Returns false (and keeps nothing)
+        // when they do not roll up to the expected piece node.
+        bool addPieceLeaves(std::size_t piece, const std::vector<Sha256Hash>& leaves);
+
+        BlockStatus submitBlock(std::size_t block, std::string_view data);
+
+        // Blocks of pieces that failed as a whole since the last call (must be re-requested).
+        std::vector<std::size_t> takeFailedBlocks();
+
+        bool pieceVerified(std::size_t piece) const;
+        std::size_t pieceCount() const noexcept { return pieceCount_; }
+        std::size_t blockCount() const noexcept { return blockCount_; }
+        std::size_t blocksPerPiece() const noexcept { return blocksPerPiece_; }
+
+    private:
+        uint64_t fileLength_;
+        std::size_t blocksPerPiece_;
+        std::size_t blockCount_;
+        std::size_t pieceCount_;
+        Sha256Hash root_;
+        std::vector<Sha256Hash> layer_;
+
+        std::vector<std::optional<Sha256Hash>> known_;     // trusted leaf hashes
+        std::vector<std::optional<Sha256Hash>> received_;  // hashes of received, unjudged blocks
+        std::vector<uint8_t> pieceDone_;
+        std::vector<std::size_t> failed_;
+
+        Sha256Hash expectedNode(std::size_t piece) const;
+        std::size_t leavesInSubtree(std::size_t piece) const;
+        std::pair<std::size_t, std::size_t> blockRange(std::size_t piece) const;
+        BlockStatus tryCompletePiece(std::size_t piece);
+    };
+
+}
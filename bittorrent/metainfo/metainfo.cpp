@@ -108,6 +108,78 @@ static std::vector<FileEntry> multi_file_entries(const bencode::BencodeValue& fi
     return out;
 }
 
+static Sha256Hash to_sha256(const std::string& s, const char* where) {
+    if (s.size() != 32) throw std::runtime_error(std::string(where) + ": expected 32-byte hash");
+    Sha256Hash h{};
+    std::memcpy(h.data(), s.data(), 32);
+    return h;
+}
+
+// BEP 52 "file tree": nested dicts keyed by path segment; a file is a dict whose only
+// key is "" mapping to {length, pieces root}. std::map order == canonical tree order.
+static void walk_file_tree(const bencode::BencodeValue& node, const std::filesystem::path& prefix,
+                           std::vector<FileEntry>& out, uint64_t& running) {
+
+    for (const auto& [name, child] : expect_dict(node, "file tree node").asDict()) {
+        if (name.empty()) throw std::runtime_error("file tree: empty path segment");
+        const auto& cd = expect_dict(child, "file tree node");
+
+        if (const auto* leaf = find_key(cd, "")) {
+            const auto& ld = expect_dict(*leaf, "file tree leaf");
+            const auto* lenv = find_key(ld, "length");
+            if (!lenv || !lenv->isInt() || lenv->asInt() < 0) throw std::runtime_error("file tree: length missing or invalid");
+
+            FileEntry fe;
+            fe.path = prefix / name;
+            fe.length = static_cast<uint64_t>(lenv->asInt());
+            fe.offset = running;
+
+            if (const auto* rootv = find_key(ld, "pieces root")) {
+                fe.piecesRoot = to_sha256(expect_str(*rootv, "file tree: pieces root").asString(), "pieces root");
+            } else if (fe.length > 0) {
+                throw std::runtime_error("file tree: pieces root missing");
+            }
+
+            running += fe.length;
+            out.push_back(std::move(fe));
+        } else {
+            walk_file_tree(child, prefix / name, out, running);
+        }
+    }
+}
+
+static std::map<Sha256Hash, std::vector<Sha256Hash>> decode_piece_layers(const bencode::BencodeValue& root) {
+    std::map<Sha256Hash, std::vector<Sha256Hash>> out;
+
+    const auto* plv = find_key(root, "piece layers");
+    if (!plv) return out;
+
+    for (const auto& [k, v] : expect_dict(*plv, "piece layers").asDict()) {
+        const auto& blob = expect_str(v, "piece layers entry").asString();
+        if (blob.size() % 32 != 0) throw std::runtime_error("piece layer not multiple of 32");
+
+        std::vector<Sha256Hash> layer(blob.size() / 32);
+        for (std::size_t i = 0; i < layer.size(); ++i) std::memcpy(layer[i].data(), blob.data() + i * 32, 32);
+        out.emplace(to_sha256(k, "piece layers key"), std::move(layer));
+    }
+    return out;
+}
+
+// Every layer we were given must roll up to its file's root
+static void validate_piece_layers(const InfoDictionary& info, const std::map<Sha256Hash, std::vector<Sha256Hash>>& layers) {
+    for (const auto& fe : info.fileTree) {
+        if (!fe.piecesRoot || fe.length <= info.pieceLength) continue;
+
+        auto it = layers.find(*fe.piecesRoot);
+        if (it == layers.end()) continue;
+
+        const uint64_t expect = (fe.length + info.pieceLength - 1) / info.pieceLength;
+        if (it->second.size() != expect) throw std::runtime_error("piece layer length mismatch for " + fe.path.string());
+        if (merkle::rootFromPieceLayer(it->second, info.pieceLength) != *fe.piecesRoot)
+            throw std::runtime_error("piece layer does not match pieces root for " + fe.path.string());
+    }
+}
+
 static std::vector<std::vector<std::string>> collect_tracker_tiers(const bencode::BencodeValue& root) {
     std::vector<std::vector<std::string>> tiers;
 
@@ -175,21 +247,40 @@ static InfoDictionary decode_info_dict(const bencode::BencodeValue& root, std::s
         throw std::runtime_error("info.piece length missing");
     }
 
-    // pieces (20-byte concatenation)
+    if (auto* mv = find_key(infod, "meta version")) {
+        if (!mv->isInt()) throw std::runtime_error("info.meta version not int");
+        out.metaVersion = static_cast<int>(mv->asInt());
+        if (out.metaVersion != 1 && out.metaVersion != 2) throw std::runtime_error("info.meta version unsupported");
+    }
+
+    if (out.metaVersion == 2) {
+        if (out.pieceLength < merkle::kBlockSize || (out.pieceLength & (out.pieceLength - 1)) != 0)
+            throw std::runtime_error("info.piece length must be a power of two >= 16 KiB for v2");
+
+        const auto* treev = find_key(infod, "file tree");
+        if (!treev) throw std::runtime_error("info.file tree missing");
+        uint64_t running = 0;
+        walk_file_tree(*treev, {}, out.fileTree, running);
+    }
+
+    // pieces (20-byte concatenation); optional for v2-only torrents
     if (auto* pv = find_key(infod, "pieces")) {
         const auto& blob = expect_str(*pv, "info.pieces").asString();
         out.pieces = split_pieces_blob(blob);
 
-    } else {
+    } else if (out.metaVersion != 2) {
         throw std::runtime_error("info.pieces missing");
     }
 
-    // files vs length
+    // files vs length (v1 or hybrid); v2-only derives files from the file tree
     if (auto* filesv = find_key(infod, "files")) {
         out.files = multi_file_entries(*filesv);
 
-    } else {
+    } else if (out.metaVersion != 2 || find_key(infod, "length")) {
         out.files = single_file_entries(infod);
+
+    } else {
+        out.files = out.fileTree;
     }
 
     return out;
@@ -209,12 +300,37 @@ Metainfo Metainfo::fromTorrent(std::string_view data) {
 
     mi.announceList = collect_tracker_tiers(root);
 
-    // Compute infohash from exact raw bytes of "info"
-    mi.infoHash_ = compute_infohash_from_slice(mi.info.rawSlice);
+    mi.hasV1_ = find_key(*find_key(root, "info"), "pieces") != nullptr;
+
+    // Compute infohashes from exact raw bytes of "info"
+    if (mi.hasV2()) {
+        mi.pieceLayers = decode_piece_layers(root);
+        validate_piece_layers(mi.info, mi.pieceLayers);
+        mi.infoHashV2_ = merkle::sha256(mi.info.rawSlice.data(), mi.info.rawSlice.size());
+    }
+
+    if (mi.hasV1_) {
+        mi.infoHash_ = compute_infohash_from_slice(mi.info.rawSlice);
+    } else {
+        // BEP 52: where 20 bytes are required (trackers, DHT), use the truncated v2 hash
+        std::memcpy(mi.infoHash_.data(), mi.infoHashV2_.data(), 20);
+    }
 
     return mi;
 }
 
+MerkleVerifier Metainfo::verifierFor(const FileEntry& file) const {
+    if (!file.piecesRoot) throw std::runtime_error("verifierFor: file has no pieces root");
+
+    std::vector<Sha256Hash> layer;
+    if (file.length > info.pieceLength) {
+        auto it = pieceLayers.find(*file.piecesRoot);
+        if (it == pieceLayers.end()) throw std::runtime_error("verifierFor: piece layer missing for " + file.path.string());
+        layer = it->second;
+    }
+    return MerkleVerifier(*file.piecesRoot, file.length, info.pieceLength, std::move(layer));
+}
+
 // Minimal magnet support: xt=urn:btih:<20-byte SHA1 (hex or base32)>, dn, tr
 // This fills only infoHash_ (if present), announceList, and info.name (from dn).
 // pieces/pieceLength/files remain empty until metadata fetch (outside scope here).
@@ -6,7 +6,9 @@
 #include <array>
 #include <filesystem>
 #include <optional>
+#include <map>
 #include "../bencode/bencode.hpp"
+#include "merkle.hpp"
 
 
 namespace bittorrent::metainfo {
@@ -16,6 +18,7 @@ namespace bittorrent::metainfo {
         std::filesystem::path path;
         uint64_t length{0};
         uint64_t offset{0};
+        std::optional<Sha256Hash> piecesRoot;               // v2 only; absent for empty files
     };
 
     struct InfoDictionary 
@@ -24,6 +27,8 @@ namespace bittorrent::metainfo {
         std::vector<FileEntry> files;                       // single-file => size==1
         uint32_t pieceLength{0};
         std::vector<std::array<uint8_t,20>> pieces;
+        int metaVersion{1};                                 // 2 => BEP 52 "file tree" present
+        std::vector<FileEntry> fileTree;                    // v2 view (no pad files), flattened in tree order
         std::string_view rawSlice;                          // exact bencoded bytes of "info"
     };
 
@@ -45,11 +50,22 @@ namespace bittorrent::metainfo {
 
         std::array<uint8_t,20> infoHash() const noexcept { return infoHash_; }
 
+        // BEP 52: v2-only torrents have no v1 "pieces"; hybrids carry both.
+        bool hasV1() const noexcept { return hasV1_; }
+        bool hasV2() const noexcept { return info.metaVersion == 2; }
+        Sha256Hash infoHashV2() const noexcept { return infoHashV2_; }   // full SHA-256 of "info"
+
+        // Verifier for one v2 file; throws if the file is empty or its layer is missing.
+        MerkleVerifier verifierFor(const FileEntry& file) const;
+
         InfoDictionary info;
         std::vector<std::vector<std::string>> announceList;
+        std::map<Sha256Hash, std::vector<Sha256Hash>> pieceLayers;       // pieces root -> piece layer
 
     private:
         std::array<uint8_t,20> infoHash_{};
+        Sha256Hash infoHashV2_{};
+        bool hasV1_{true};
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include <catch2/catch_all.hpp>
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../metainfo.hpp"
+
+using namespace bittorrent::metainfo;
+using bencode::BencodeValue;
+
+// ---------- helpers ----------------------------------------------------------
+
+static std::string random_bytes(std::size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::string s(n, '\0');
+    for (auto& c : s) c = static_cast<char>(rng() & 0xFF);
+    return s;
+}
+
+static std::string hstr(const Sha256Hash& h) {
+    return std::string(reinterpret_cast<const char*>(h.data()), h.size());
+}
+
+static std::string block(const std::string& data, std::size_t i) {
+    return data.substr(i * merkle::kBlockSize, merkle::kBlockSize);
+}
+
+struct V2File { std::vector<std::string> path; std::string data; };
+
+struct TreeNode {
+    std::map<std::string, TreeNode> children;
+    std::optional<BencodeValue> leaf;
+
+    BencodeValue encode() const {
+        std::map<std::string, BencodeValue> d;
+        if (leaf) d[""] = *leaf;
+        for (const auto& [k, c] : children) d[k] = c.encode();
+        return BencodeValue(std::move(d));
+    }
+};
+
+// Builds a v2 (or hybrid, when v1Pieces is set) torrent with matching piece layers
+static std::string make_v2_torrent(const std::vector<V2File>& files, uint32_t pl,
+                                   std::optional<std::string> v1Pieces = std::nullopt) {
+    TreeNode tree;
+    std::map<std::string, BencodeValue> layers;
+
+    for (const auto& f : files) {
+        std::map<std::string, BencodeValue> leaf;
+        leaf["length"] = BencodeValue(static_cast<int64_t>(f.data.size()));
+        if (!f.data.empty()) {
+            auto leaves = merkle::blockHashes(f.data);
+            auto layer = merkle::pieceLayerFromLeaves(leaves, pl);
+            auto root = f.data.size() > pl ? merkle::rootFromPieceLayer(layer, pl) : merkle::rootFromLeaves(leaves);
+            leaf["pieces root"] = BencodeValue(hstr(root));
+            if (f.data.size() > pl) {
+                std::string blob;
+                for (auto& h : layer) blob += hstr(h);
+                layers[hstr(root)] = BencodeValue(std::move(blob));
+            }
+        }
+
+        TreeNode* node = &tree;
+        for (const auto& seg : f.path) node = &node->children[seg];
+        node->leaf = BencodeValue(std::move(leaf));
+    }
+
+    std::map<std::string, BencodeValue> info;
+    info["name"] = BencodeValue(std::string("v2test"));
+    info["piece length"] = BencodeValue(static_cast<int64_t>(pl));
+    info["meta version"] = BencodeValue(int64_t(2));
+    info["file tree"] = tree.encode();
+    if (v1Pieces) {
+        info["pieces"] = BencodeValue(*v1Pieces);
+        info["length"] = BencodeValue(static_cast<int64_t>(files.front().data.size()));
+    }
+
+    std::map<std::string, BencodeValue> root;
+    root["announce"] = BencodeValue(std::string("http://t/announce"));
+    root["info"] = BencodeValue(std::move(info));
+    root["piece layers"] = BencodeValue(std::move(layers));
+    return bencode::BencodeParser::encode(BencodeValue(std::move(root)));
+}
+
+// ---------- merkle helpers ---------------------------------------------------
+
+TEST_CASE("merkle: pad hashes and piece-layer root agree with leaf root") {
+    CHECK(merkle::padHash(0) == Sha256Hash{});
+    CHECK(merkle::padHash(1) == merkle::hashPair(Sha256Hash{}, Sha256Hash{}));
+
+    const uint32_t pl = 64 * 1024; // 4 blocks per piece
+    const std::string data = random_bytes(5 * pl + 1234, 7);
+    auto leaves = merkle::blockHashes(data);
+    REQUIRE(leaves.size() == 5 * 4 + 1);
+
+    auto layer = merkle::pieceLayerFromLeaves(leaves, pl);
+    REQUIRE(layer.size() == 6);
+    CHECK(merkle::rootFromPieceLayer(layer, pl) == merkle::rootFromLeaves(leaves));
+}
+
+// ---------- metainfo v2 parsing ----------------------------------------------
+
+TEST_CASE("Metainfo: v2-only torrent parses file tree, layers and SHA-256 infohash") {
+    const uint32_t pl = 32 * 1024;
+    const std::string big = random_bytes(3 * pl + 100, 1);
+    const std::string small = random_bytes(1000, 2);
+
+    auto bytes = make_v2_torrent({{{"dir", "big.bin"}, big}, {{"dir", "empty"}, ""}, {{"small.txt"}, small}}, pl);
+    auto mi = Metainfo::fromTorrent(bytes);
+
+    CHECK(mi.hasV2());
+    CHECK_FALSE(mi.hasV1());
+    CHECK(mi.info.metaVersion == 2);
+    CHECK(mi.info.pieces.empty());
+
+    REQUIRE(mi.info.fileTree.size() == 3);
+    CHECK(mi.info.fileTree[0].path == std::filesystem::path("dir") / "big.bin");
+    CHECK(mi.info.fileTree[1].path == std::filesystem::path("dir") / "empty");
+    CHECK_FALSE(mi.info.fileTree[1].piecesRoot.has_value());
+    CHECK(mi.info.fileTree[2].offset == big.size());
+    CHECK(mi.totalLength() == big.size() + small.size());
+
+    REQUIRE(mi.pieceLayers.size() == 1);
+    CHECK(mi.pieceLayers.begin()->second.size() == 4);
+
+    auto slice = mi.info.rawSlice;
+    CHECK(mi.infoHashV2() == merkle::sha256(slice.data(), slice.size()));
+    const auto v1 = mi.infoHash();
+    const auto v2 = mi.infoHashV2();
+    CHECK(std::equal(v1.begin(), v1.end(), v2.begin()));
+}
+
+TEST_CASE("Metainfo: hybrid torrent keeps v1 SHA-1 infohash and v2 hash") {
+    const uint32_t pl = 16 * 1024;
+    const std::string data = random_bytes(20'000, 3);
+    auto bytes = make_v2_torrent({{{"one.bin"}, data}}, pl, std::string(40, 'x'));
+
+    auto mi = Metainfo::fromTorrent(bytes);
+    CHECK(mi.hasV1());
+    CHECK(mi.hasV2());
+    CHECK(mi.info.pieces.size() == 2);
+    CHECK(mi.info.files.size() == 1);
+    CHECK(mi.info.fileTree.size() == 1);
+    const auto v1 = mi.infoHash();
+    const auto v2 = mi.infoHashV2();
+    CHECK_FALSE(std::equal(v1.begin(), v1.end(), v2.begin()));
+}
+
+TEST_CASE("Metainfo: corrupted piece layer is rejected") {
+    const uint32_t pl = 16 * 1024;
+    auto bytes = make_v2_torrent({{{"f"}, random_bytes(3 * pl, 4)}}, pl);
+
+    // "piece layers" is the last root key, so the tail of the encoding is its blob + "ee"
+    REQUIRE(bytes.find("12:piece layers") != std::string::npos);
+    bytes[bytes.size() - 5] ^= 0x01;
+    CHECK_THROWS(Metainfo::fromTorrent(bytes));
+}
+
+// ---------- block verification -----------------------------------------------
+
+TEST_CASE("MerkleVerifier: pieces verify once complete; bad block fails whole piece") {
+    const uint32_t pl = 64 * 1024;
+    const std::string data = random_bytes(2 * pl + 5000, 5);
+    auto mi = Metainfo::fromTorrent(make_v2_torrent({{{"f"}, data}}, pl));
+    auto v = mi.verifierFor(mi.info.fileTree.at(0));
+
+    REQUIRE(v.pieceCount() == 3);
+    REQUIRE(v.blockCount() == 9);
+
+    // piece 0 intact
+    for (std::size_t b = 0; b < 3; ++b) CHECK(v.submitBlock(b, block(data, b)) == MerkleVerifier::BlockStatus::pending);
+    CHECK(v.submitBlock(3, block(data, 3)) == MerkleVerifier::BlockStatus::verified);
+    CHECK(v.pieceVerified(0));
+
+    // piece 1 with one corrupted block: only detectable at piece completion
+    std::string bad = block(data, 5); bad[10] ^= 0x55;
+    v.submitBlock(4, block(data, 4));
+    v.submitBlock(5, bad);
+    v.submitBlock(6, block(data, 6));
+    CHECK(v.submitBlock(7, block(data, 7)) == MerkleVerifier::BlockStatus::failed);
+    CHECK(v.takeFailedBlocks() == std::vector<std::size_t>{4, 5, 6, 7});
+    CHECK_FALSE(v.pieceVerified(1));
+
+    // short tail piece (single block)
+    CHECK(v.submitBlock(8, block(data, 8)) == MerkleVerifier::BlockStatus::verified);
+    CHECK(v.submitBlock(8, std::string(10, 'z')) == MerkleVerifier::BlockStatus::failed);
+}
+
+TEST_CASE("MerkleVerifier: with leaf hashes each block is judged on arrival") {
+    const uint32_t pl = 64 * 1024;
+    const std::string data = random_bytes(2 * pl, 6);
+    auto mi = Metainfo::fromTorrent(make_v2_torrent({{{"f"}, data}}, pl));
+    auto v = mi.verifierFor(mi.info.fileTree.at(0));
+
+    auto leaves = merkle::blockHashes(data);
+    std::vector<Sha256Hash> piece1(leaves.begin() + 4, leaves.end());
+
+    // forged leaves do not roll up to the piece layer
+    auto forged = piece1; forged[0][0] ^= 1;
+    CHECK_FALSE(v.addPieceLeaves(1, forged));
+    REQUIRE(v.addPieceLeaves(1, piece1));
+
+    std::string bad = block(data, 6); bad[0] ^= 1;
+    CHECK(v.submitBlock(6, bad) == MerkleVerifier::BlockStatus::failed);
+    CHECK(v.submitBlock(4, block(data, 4)) == MerkleVerifier::BlockStatus::verified);
+    CHECK(v.submitBlock(5, block(data, 5)) == MerkleVerifier::BlockStatus::verified);
+    CHECK(v.submitBlock(6, block(data, 6)) == MerkleVerifier::BlockStatus::verified);
+    CHECK(v.submitBlock(7, block(data, 7)) == MerkleVerifier::BlockStatus::verified);
+    CHECK(v.pieceVerified(1));
+    CHECK(v.takeFailedBlocks().empty());
+}
+
+TEST_CASE("MerkleVerifier: single-piece file verifies against pieces root") {
+    const uint32_t pl = 64 * 1024;
+    const std::string data = random_bytes(40'000, 8); // 3 blocks, tree padded to 4 leaves
+    auto mi = Metainfo::fromTorrent(make_v2_torrent({{{"f"}, data}}, pl));
+    auto v = mi.verifierFor(mi.info.fileTree.at(0));
+
+    REQUIRE(v.pieceCount() == 1);
+    v.submitBlock(0, block(data, 0));
+    v.submitBlock(2, block(data, 2));
+    CHECK(v.submitBlock(1, block(data, 1)) == MerkleVerifier::BlockStatus::verified);
+}
@@ -0,0 +1,150 @@
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <openssl/sha.h>
+
+#include "../torrent_builder.hpp"
+
+using namespace bittorrent::metainfo;
+namespace fs = std::filesystem;
+
+// ---------- helpers ----------------------------------------------------------
+
+struct TempDir {
+    fs::path path;
+    TempDir() {
+        std::random_device rd;
+        path = fs::temp_directory_path() / ("tb_test_" + std::to_string(rd()));
+        fs::create_directories(path);
+    }
+    ~TempDir() { std::error_code ec; fs::remove_all(path, ec); }
+};
+
+static std::string random_bytes(std::size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::string s(n, '\0');
+    for (auto& c : s) c = static_cast<char>(rng() & 0xFF);
+    return s;
+}
+
+static void write_file(const fs::path& p, const std::string& data) {
+    fs::create_directories(p.parent_path());
+    std::ofstream out(p, std::ios::binary);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+// Reference: single-threaded hash over the concatenated payload
+static std::vector<std::array<uint8_t,20>> reference_pieces(const std::string& payload, uint32_t pl) {
+    std::vector<std::array<uint8_t,20>> out;
+    for (std::size_t off = 0; off < payload.size(); off += pl) {
+        std::array<uint8_t,20> h{};
+        auto len = std::min<std::size_t>(pl, payload.size() - off);
+        SHA1(reinterpret_cast<const unsigned char*>(payload.data() + off), len, h.data());
+        out.push_back(h);
+    }
+    return out;
+}
+
+// ---------- tests -------------------------------------------------------------
+
+TEST_CASE("choosePieceLength: power of two within [16 KiB, 16 MiB]") {
+    CHECK(TorrentBuilder::choosePieceLength(0) == 16 * 1024);
+    CHECK(TorrentBuilder::choosePieceLength(1024) == 16 * 1024);
+    CHECK(TorrentBuilder::choosePieceLength(uint64_t(1) << 50) == 16 * 1024 * 1024);
+
+    for (uint64_t total : {uint64_t(100) << 20, uint64_t(4) << 30, uint64_t(20) << 30}) {
+        auto pl = TorrentBuilder::choosePieceLength(total);
+        CHECK((pl & (pl - 1)) == 0);
+        CHECK(total / pl <= 1500);
+    }
+}
+
+TEST_CASE("TorrentBuilder: single file round-trips through Metainfo::fromTorrent") {
+    TempDir tmp;
+    const std::string payload = random_bytes(100'000, 1);
+    write_file(tmp.path / "blob.bin", payload);
+
+    TorrentBuilderOptions opts;
+    opts.pieceLength = 16 * 1024;
+    opts.hashThreads = 3;
+    opts.announceList = {{"http://tracker.example/announce"}};
+    opts.createdBy = "test";
+
+    TorrentBuilder tb(tmp.path / "blob.bin", opts);
+    const std::string bytes = tb.build();
+
+    auto meta = Metainfo::fromTorrent(bytes);
+    CHECK(meta.info.name == "blob.bin");
+    CHECK(meta.isSingleFile());
+    CHECK(meta.totalLength() == payload.size());
+    CHECK(meta.pieceLength() == 16 * 1024);
+    CHECK(meta.pieces() == reference_pieces(payload, 16 * 1024));
+    REQUIRE(meta.announceList.size() == 1);
+    CHECK(meta.announceList[0][0] == "http://tracker.example/announce");
+
+    // Canonical encoding: re-encoding what was parsed yields identical bytes
+    CHECK(bencode::BencodeParser::encode(bencode::BencodeParser::parse(bytes)) == bytes);
+}
+
+TEST_CASE("TorrentBuilder: directory pieces span file boundaries, sorted paths") {
+    TempDir tmp;
+    const fs::path root = tmp.path / "pack";
+    const std::string a = random_bytes(20'000, 2);
+    const std::string b = random_bytes(1, 3);
+    const std::string c = random_bytes(50'001, 4);
+    write_file(root / "sub" / "c.dat", c);
+    write_file(root / "a.dat", a);
+    write_file(root / "b.dat", b);
+    write_file(root / "empty.dat", "");
+
+    TorrentBuilderOptions opts;
+    opts.pieceLength = 16 * 1024;
+    opts.hashThreads = 4;
+    opts.readAheadPieces = 2;
+    opts.announceList = {{"http://a/announce", "http://b/announce"}, {"udp://c:6969"}};
+
+    const std::string bytes = TorrentBuilder(root, opts).build();
+    auto meta = Metainfo::fromTorrent(bytes);
+
+    CHECK(meta.info.name == "pack");
+    REQUIRE(meta.info.files.size() == 4);
+    CHECK(meta.info.files[0].path == fs::path("a.dat"));
+    CHECK(meta.info.files[1].path == fs::path("b.dat"));
+    CHECK(meta.info.files[2].path == fs::path("empty.dat"));
+    CHECK(meta.info.files[3].path == fs::path("sub") / "c.dat");
+    CHECK(meta.info.files[3].offset == a.size() + b.size());
+
+    CHECK(meta.pieces() == reference_pieces(a + b + c, 16 * 1024));
+    CHECK(meta.announceList.size() == 2);
+    CHECK(bencode::BencodeParser::encode(bencode::BencodeParser::parse(bytes)) == bytes);
+}
+
+TEST_CASE("TorrentBuilder: thread count does not change the output") {
+    TempDir tmp;
+    write_file(tmp.path / "d" / "x", random_bytes(300'000, 5));
+    write_file(tmp.path / "d" / "y", random_bytes(7'777, 6));
+
+    TorrentBuilderOptions opts;
+    opts.pieceLength = 32 * 1024;
+    opts.creationDate = 1700000000;
+
+    opts.hashThreads = 1;
+    const auto one = TorrentBuilder(tmp.path / "d", opts).build();
+    opts.hashThreads = 8;
+    const auto many = TorrentBuilder(tmp.path / "d", opts).build();
+
+    CHECK(one == many);
+    CHECK(Metainfo::fromTorrent(one).infoHash() == Metainfo::fromTorrent(many).infoHash());
+}
+
+TEST_CASE("TorrentBuilder: missing path throws") {
+    TempDir tmp;
+    TorrentBuilder tb(tmp.path / "nope");
+    CHECK_THROWS_AS(tb.build(), std::runtime_error);
+}
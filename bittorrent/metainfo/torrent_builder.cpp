@@ -0,0 +1,292 @@
+#include "torrent_builder.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <openssl/sha.h>
+
+
+using namespace bittorrent::metainfo;
+namespace fs = std::filesystem;
+
+
+
+TorrentBuilder::TorrentBuilder(fs::path root, TorrentBuilderOptions opts)
+    : root_(std::move(root)), opts_(std::move(opts)) {}
+
+
+uint32_t TorrentBuilder::choosePieceLength(uint64_t totalLength) noexcept {
+
+    constexpr uint64_t MIN = 16 * 1024;
+    constexpr uint64_t MAX = 16 * 1024 * 1024;
+    constexpr uint64_t TARGET_PIECES = 1500;
+
+    uint64_t pl = MIN;
+    while (pl < MAX && totalLength / pl > TARGET_PIECES) pl <<= 1;
+    return static_cast<uint32_t>(pl);
+}
+
+
+void TorrentBuilder::collectFiles() {
+
+    files_.clear();
+    totalLength_ = 0;
+    singleFile_ = false;
+
+    std::error_code ec;
+    auto st = fs::status(root_, ec);
+    if (ec) throw std::runtime_error("torrent builder: cannot stat " + root_.string() + ": " + ec.message());
+
+    if (fs::is_regular_file(st)) {
+        FileEntry fe;
+        fe.path = root_.filename();
+        fe.length = fs::file_size(root_);
+        fe.offset = 0;
+        totalLength_ = fe.length;
+        files_.push_back(std::move(fe));
+        singleFile_ = true;
+        return;
+    }
+
+    if (!fs::is_directory(st)) throw std::runtime_error("torrent builder: not a file or directory: " + root_.string());
+
+    std::vector<std::pair<fs::path, uint64_t>> found;
+    for (auto it = fs::recursive_directory_iterator(root_); it != fs::recursive_directory_iterator(); ++it) {
+        // symlink_status: do not follow links out of the tree
+        if (!fs::is_regular_file(it->symlink_status())) continue;
+        found.emplace_back(fs::relative(it->path(), root_), it->file_size());
+    }
+
+    if (found.empty()) throw std::runtime_error("torrent builder: no files under " + root_.string());
+
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) {
+        return a.first.generic_string() < b.first.generic_string();
+    });
+
+    files_.reserve(found.size());
+    for (auto& [rel, len] : found) {
+        FileEntry fe;
+        fe.path = std::move(rel);
+        fe.length = len;
+        fe.offset = totalLength_;
+        totalLength_ += len;
+        files_.push_back(std::move(fe));
+    }
+}
+
+
+// Reader -> bounded buffer slots -> hashing workers. Buffers are recycled, so memory is
+// readAheadPieces * pieceLength regardless of payload size.
+std::vector<std::array<uint8_t,20>> TorrentBuilder::hashPieces() const {
+
+    const uint64_t pl = pieceLength_;
+    const std::size_t nPieces = static_cast<std::size_t>((totalLength_ + pl - 1) / pl);
+    std::vector<std::array<uint8_t,20>> pieces(nPieces);
+    if (nPieces == 0) return pieces;
+
+    unsigned nThreads = opts_.hashThreads ? opts_.hashThreads : std::thread::hardware_concurrency();
+    if (nThreads == 0) nThreads = 1;
+    if (nThreads > nPieces) nThreads = static_cast<unsigned>(nPieces);
+
+    std::size_t nSlots = opts_.readAheadPieces ? opts_.readAheadPieces : std::size_t(2) * nThreads;
+    nSlots = std::clamp<std::size_t>(nSlots, 1, nPieces);
+
+    struct Job { std::size_t piece; std::size_t slot; std::size_t len; };
+
+    std::vector<std::vector<uint8_t>> slots(nSlots, std::vector<uint8_t>(pl));
+    std::deque<std::size_t> freeSlots;
+    for (std::size_t i = 0; i < nSlots; ++i) freeSlots.push_back(i);
+    std::deque<Job> ready;
+
+    std::mutex mu;
+    std::condition_variable freeCv, readyCv;
+    bool readerDone = false;
+    bool failed = false;
+    std::exception_ptr error;
+
+    auto fail = [&](std::exception_ptr e) {
+        std::scoped_lock lk(mu);
+        if (!error) error = e;
+        failed = true;
+        readerDone = true;
+        freeCv.notify_all();
+        readyCv.notify_all();
+    };
+
+    auto worker = [&] {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock lk(mu);
+                readyCv.wait(lk, [&] { return !ready.empty() || readerDone; });
+                if (ready.empty() || failed) return;
+                job = ready.front();
+                ready.pop_front();
+            }
+
+            SHA1(slots[job.slot].data(), job.len, pieces[job.piece].data());
+
+            {
+                std::scoped_lock lk(mu);
+                freeSlots.push_back(job.slot);
+            }
+            freeCv.notify_one();
+        }
+    };
+
+    auto reader = [&] {
+        try {
+            std::size_t piece = 0;
+            std::size_t slot = 0;
+            std::size_t fill = 0;
+            bool haveSlot = false;
+
+            auto acquire = [&]() -> bool {
+                std::unique_lock lk(mu);
+                freeCv.wait(lk, [&] { return !freeSlots.empty() || failed; });
+                if (failed) return false;
+                slot = freeSlots.front();
+                freeSlots.pop_front();
+                return true;
+            };
+
+            auto publish = [&] {
+                {
+                    std::scoped_lock lk(mu);
+                    ready.push_back(Job{piece++, slot, fill});
+                }
+                readyCv.notify_one();
+                haveSlot = false;
+                fill = 0;
+            };
+
+            for (const auto& fe : files_) {
+                if (fe.length == 0) continue;
+
+                const fs::path full = singleFile_ ? root_ : root_ / fe.path;
+                std::ifstream in(full, std::ios::binary);
+                if (!in) throw std::runtime_error("torrent builder: cannot open " + full.string());
+
+                uint64_t remaining = fe.length;
+                while (remaining > 0) {
+                    if (!haveSlot) {
+                        if (!acquire()) return;
+                        haveSlot = true;
+                    }
+
+                    const std::size_t want = static_cast<std::size_t>(std::min<uint64_t>(remaining, pl - fill));
+                    in.read(reinterpret_cast<char*>(slots[slot].data() + fill), static_cast<std::streamsize>(want));
+                    if (static_cast<std::size_t>(in.gcount()) != want) {
+                        throw std::runtime_error("torrent builder: short read (file changed?) " + full.string());
+                    }
+
+                    fill += want;
+                    remaining -= want;
+                    if (fill == pl) publish();
+                }
+            }
+
+            if (haveSlot && fill > 0) publish();
+
+            {
+                std::scoped_lock lk(mu);
+                readerDone = true;
+            }
+            readyCv.notify_all();
+
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(nThreads);
+    for (unsigned i = 0; i < nThreads; ++i) pool.emplace_back(worker);
+
+    std::thread io(reader);
+    io.join();
+    for (auto& t : pool) t.join();
+
+    if (error) std::rethrow_exception(error);
+    return pieces;
+}
+
+
+std::string TorrentBuilder::build() {
+
+    using bencode::BencodeValue;
+
+    collectFiles();
+    pieceLength_ = opts_.pieceLength ? opts_.pieceLength : choosePieceLength(totalLength_);
+
+    const auto pieces = hashPieces();
+
+    std::string blob;
+    blob.reserve(pieces.size() * 20);
+    for (const auto& h : pieces) blob.append(reinterpret_cast<const char*>(h.data()), h.size());
+
+    fs::path norm = root_.lexically_normal();
+    std::string name = norm.filename().string();
+    if (name.empty()) name = norm.parent_path().filename().string();
+    if (name.empty()) throw std::runtime_error("torrent builder: cannot derive name from " + root_.string());
+
+    std::map<std::string, BencodeValue> info;
+    info["name"] = BencodeValue(name);
+    info["piece length"] = BencodeValue(static_cast<int64_t>(pieceLength_));
+    info["pieces"] = BencodeValue(std::move(blob));
+    if (opts_.isPrivate) info["private"] = BencodeValue(int64_t(1));
+
+    if (singleFile_) {
+        info["length"] = BencodeValue(static_cast<int64_t>(totalLength_));
+
+    } else {
+        std::vector<BencodeValue> files;
+        files.reserve(files_.size());
+
+        for (const auto& fe : files_) {
+            std::vector<BencodeValue> segs;
+            for (const auto& seg : fe.path) segs.emplace_back(seg.string());
+
+            std::map<std::string, BencodeValue> fd;
+            fd["length"] = BencodeValue(static_cast<int64_t>(fe.length));
+            fd["path"] = BencodeValue(std::move(segs));
+            files.emplace_back(std::move(fd));
+        }
+        info["files"] = BencodeValue(std::move(files));
+    }
+
+    std::map<std::string, BencodeValue> root;
+    root["info"] = BencodeValue(std::move(info));
+
+    const auto& tiers = opts_.announceList;
+    std::size_t urlCount = 0;
+    for (const auto& t : tiers) urlCount += t.size();
+
+    if (urlCount > 0) {
+        for (const auto& t : tiers) {
+            if (!t.empty()) { root["announce"] = BencodeValue(t.front()); break; }
+        }
+    }
+
+    if (urlCount > 1) {
+        std::vector<BencodeValue> al;
+        for (const auto& t : tiers) {
+            if (t.empty()) continue;
+            std::vector<BencodeValue> tier;
+            for (const auto& u : t) tier.emplace_back(u);
+            al.emplace_back(std::move(tier));
+        }
+        root["announce-list"] = BencodeValue(std::move(al));
+    }
+
+    if (opts_.comment) root["comment"] = BencodeValue(*opts_.comment);
+    if (opts_.createdBy) root["created by"] = BencodeValue(*opts_.createdBy);
+    if (opts_.creationDate) root["creation date"] = BencodeValue(*opts_.creationDate);
+
+    return bencode::BencodeParser::encode(BencodeValue(std::move(root)));
+}
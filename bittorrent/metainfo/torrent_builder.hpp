@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+#include <filesystem>
+#include <optional>
+#include "metainfo.hpp"
+
+
+namespace bittorrent::metainfo {
+
+    struct TorrentBuilderOptions
+    {
+        std::vector<std::vector<std::string>> announceList; // BEP 12 tiers; first URL also becomes "announce"
+        uint32_t pieceLength{0};                            // 0 => choosePieceLength(total)
+        unsigned hashThreads{0};                            // 0 => hardware_concurrency
+        std::size_t readAheadPieces{0};                     // buffers in flight; 0 => 2 * hashThreads
+        std::optional<std::string> comment;
+        std::optional<std::string> createdBy;
+        std::optional<int64_t> creationDate;                // unix seconds
+        bool isPrivate{false};
+    };
+
+    /**
+     * @brief Creates v1 .torrent files from a file or directory.
+     *
+     * One I/O thread reads the payload sequentially (pieces span file
+     * boundaries) into a bounded set of piece buffers; a pool of workers
+     * SHA-1 hashes them out of order. The result is encoded with
+     * BencodeParser::encode, so Metainfo::fromTorrent re-encodes it to the
+     * same bytes and computes the same info-hash.
+     *
+     * Directory entries are sorted by path; symlinks and special files are
+     * skipped. I/O errors are rethrown from build() as std::runtime_error.
+     */
+    class TorrentBuilder
+    {
+    public:
+        explicit TorrentBuilder(std::filesystem::path root, TorrentBuilderOptions opts = {});
+
+        std::string build();
+
+        const std::vector<FileEntry>& files() const noexcept { return files_; }
+        uint32_t pieceLength() const noexcept { return pieceLength_; }
+        uint64_t totalLength() const noexcept { return totalLength_; }
+
+        // Power of two in [16 KiB, 16 MiB] aiming for roughly 1500 pieces.
+        static uint32_t choosePieceLength(uint64_t totalLength) noexcept;
+
+    private:
+        std::filesystem::path root_;
+        TorrentBuilderOptions opts_;
+        std::vector<FileEntry> files_;      // paths relative to root_ (single file => its name)
+        uint64_t totalLength_{0};
+        uint32_t pieceLength_{0};
+        bool singleFile_{false};
+
+        void collectFiles();
+        std::vector<std::array<uint8_t,20>> hashPieces() const;
+    };
+
+}
@@ -0,0 +1,193 @@
+#include "hash_backends.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <random>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include "sha1.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+
+namespace bittorrent::sha {
+
+    namespace {
+
+        void bundledSha1(const uint8_t* data, std::size_t len, uint8_t* out) {
+            class ::SHA1 h;     // the bundled class shares its name with OpenSSL's SHA1()
+            h.update(std::string(reinterpret_cast<const char*>(data), len));
+            const std::string hex = h.final();
+            for (std::size_t i = 0; i < 20; ++i) {
+                out[i] = static_cast<uint8_t>(std::stoul(hex.substr(2 * i, 2), nullptr, 16));
+            }
+        }
+
+        void opensslSha1(const uint8_t* data, std::size_t len, uint8_t* out) {
+            ::SHA1(data, len, out);
+        }
+
+        void opensslSha256(const uint8_t* data, std::size_t len, uint8_t* out) {
+            ::SHA256(data, len, out);
+        }
+
+        void evpDigest(const EVP_MD* md, const uint8_t* data, std::size_t len, uint8_t* out) {
+            unsigned int n = 0;
+            if (EVP_Digest(data, len, out, &n, md, nullptr) != 1) {
+                throw std::runtime_error("EVP_Digest failed");
+            }
+        }
+
+        void evpSha1(const uint8_t* data, std::size_t len, uint8_t* out)   { evpDigest(EVP_sha1(), data, len, out); }
+        void evpSha256(const uint8_t* data, std::size_t len, uint8_t* out) { evpDigest(EVP_sha256(), data, len, out); }
+
+        std::string hex(const uint8_t* p, std::size_t n) {
+            static const char* d = "0123456789abcdef";
+            std::string s;
+            for (std::size_t i = 0; i < n; ++i) { s += d[p[i] >> 4]; s += d[p[i] & 0xF]; }
+            return s;
+        }
+
+        struct Vector { std::string input; const char* sha1; const char* sha256; };
+
+        const std::vector<Vector>& knownAnswers() {
+            static const std::vector<Vector> v{
+                {"", "da39a3ee5e6b4b0d3255bfef95601890afd80709",
+                     "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+                {"abc", "a9993e364706816aba3e25717850c26c9cd0d89d",
+                        "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+                {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+                        "84983e441c3bd26ebaae4aa1f95129e5e54670f1",
+                        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+                {std::string(1000000, 'a'), "34aa973cd4c4daa4f61eeb2bdbad27316534016f",
+                        "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+            };
+            return v;
+        }
+
+    } // namespace
+
+
+    const std::vector<HashBackend>& allBackends() {
+        static const std::vector<HashBackend> b{
+            {"openssl-evp-sha1",   Algo::sha1,   evpSha1},
+            {"openssl-sha1",       Algo::sha1,   opensslSha1},
+            {"bundled-sha1",       Algo::sha1,   bundledSha1},
+            {"openssl-evp-sha256", Algo::sha256, evpSha256},
+            {"openssl-sha256",     Algo::sha256, opensslSha256},
+        };
+        return b;
+    }
+
+
+    namespace {
+
+        bool passesKnownAnswers(const HashBackend& b, std::string* why) {
+            uint8_t got[32];
+            const std::size_t n = digestSize(b.algo);
+            try {
+                for (const auto& v : knownAnswers()) {
+                    b.digest(reinterpret_cast<const uint8_t*>(v.input.data()), v.input.size(), got);
+                    const char* want = b.algo == Algo::sha1 ? v.sha1 : v.sha256;
+                    if (hex(got, n) != want) {
+                        if (why) {
+                            *why = std::string(b.name) + ": known-answer mismatch for input of "
+                                   + std::to_string(v.input.size()) + " bytes";
+                        }
+                        return false;
+                    }
+                }
+            } catch (const std::exception& e) {
+                if (why) *why = std::string(b.name) + ": " + e.what();
+                return false;
+            }
+            return true;
+        }
+
+        // OpenSSL one-shot, or nullptr if it fails its own known answers (the cross-check is
+        // then skipped rather than blamed on the backend under test).
+        const HashBackend* reference(Algo algo) {
+            static const HashBackend sha1{"openssl-sha1", Algo::sha1, opensslSha1};
+            static const HashBackend sha256{"openssl-sha256", Algo::sha256, opensslSha256};
+            static const bool ok[2] = {passesKnownAnswers(sha1, nullptr), passesKnownAnswers(sha256, nullptr)};
+            if (algo == Algo::sha1) return ok[0] ? &sha1 : nullptr;
+            return ok[1] ? &sha256 : nullptr;
+        }
+
+    } // namespace
+
+
+    bool selfTest(const HashBackend& b, std::string* why) {
+        auto fail = [&](std::string msg) { if (why) *why = std::move(msg); return false; };
+
+        if (!passesKnownAnswers(b, why)) return false;
+        const HashBackend* ref = reference(b.algo);
+        if (!ref || ref->digest == b.digest) return true;
+
+        // Odd sizes around block boundaries, at an unaligned offset
+        std::mt19937 rng(0xB17);
+        std::vector<uint8_t> buf(70000 + 1);
+        for (auto& c : buf) c = static_cast<uint8_t>(rng());
+        const uint8_t* p = buf.data() + 1;
+
+        uint8_t got[32], want[32];
+        const std::size_t n = digestSize(b.algo);
+        for (std::size_t len : {1u, 55u, 56u, 63u, 64u, 65u, 119u, 16383u, 16384u, 65537u, 70000u}) {
+            try {
+                ref->digest(p, len, want);
+            } catch (const std::exception&) {
+                continue;       // the reference's failure, not b's
+            }
+            try {
+                b.digest(p, len, got);
+            } catch (const std::exception& e) {
+                return fail(std::string(b.name) + ": " + e.what());
+            }
+            if (std::memcmp(got, want, n) != 0) {
+                return fail(std::string(b.name) + " disagrees with " + ref->name
+                            + " at " + std::to_string(len) + " bytes");
+            }
+        }
+        return true;
+    }
+
+
+    const HashBackend* firstPassing(const std::vector<HashBackend>& candidates, Algo algo) {
+        for (const auto& b : candidates) {
+            if (b.algo == algo && selfTest(b)) return &b;
+        }
+        return nullptr;
+    }
+
+
+    const HashBackend& selectBackend(Algo algo) {
+        static const HashBackend* chosen[2] = {firstPassing(allBackends(), Algo::sha1),
+                                               firstPassing(allBackends(), Algo::sha256)};
+
+        const HashBackend* b = chosen[algo == Algo::sha1 ? 0 : 1];
+        if (!b) throw std::runtime_error("no hash backend passed self-test");
+        return *b;
+    }
+
+
+    std::string cpuFeatures() {
+        std::string out;
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned a = 0, b = 0, c = 0, d = 0;
+        if (__get_cpuid_count(7, 0, &a, &b, &c, &d)) {
+            if (b & (1u << 29)) out += "sha-ni ";
+            if (b & (1u << 5))  out += "avx2 ";
+        }
+        if (__get_cpuid(1, &a, &b, &c, &d)) {
+            if (c & (1u << 9))  out += "ssse3 ";
+        }
+#elif defined(__aarch64__)
+        out += "aarch64 ";
+#endif
+        if (out.empty()) return "none detected";
+        out.pop_back();
+        return out;
+    }
+
+} // namespace bittorrent::sha
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace bittorrent::sha {
+
+    enum class Algo { sha1, sha256 };
+
+    constexpr std::size_t digestSize(Algo a) { return a == Algo::sha1 ? 20 : 32; }
+
+    /**
+     * @brief One way of computing a digest (bundled code, OpenSSL one-shot, OpenSSL EVP).
+     *
+     * OpenSSL's EVP path dispatches at runtime to SHA-NI / AVX2 / NEON code when the
+     * CPU supports it, so it doubles as the "accelerated" backend.
+     */
+    struct HashBackend
+    {
+        const char* name;
+        Algo algo;
+        void (*digest)(const uint8_t* data, std::size_t len, uint8_t* out);
+    };
+
+    const std::vector<HashBackend>& allBackends();
+
+    // Known-answer vectors (FIPS 180 "abc", empty, million 'a') plus a cross-check on
+    // unaligned odd-sized inputs against OpenSSL's one-shot digest, which must pass the
+    // known answers first. Only b is ever blamed for a mismatch or an exception.
+    bool selfTest(const HashBackend& b, std::string* why = nullptr);
+
+    // The first of candidates for algo that passes selfTest, or nullptr.
+    const HashBackend* firstPassing(const std::vector<HashBackend>& candidates, Algo algo);
+
+    // firstPassing over allBackends() (EVP, one-shot, bundled), decided once.
+    // Throws std::runtime_error when none passes.
+    const HashBackend& selectBackend(Algo algo);
+
+    // Human-readable CPU hash acceleration summary ("sha-ni", "avx2", ...).
+    std::string cpuFeatures();
+
+} // namespace bittorrent::sha
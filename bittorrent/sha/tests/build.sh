@@ -0,0 +1,18 @@
+#!/usr/bin/env bash
+set -e
+
+BUILD_DIR="build"
+if [ ! -d "$BUILD_DIR" ]; then
+    mkdir "$BUILD_DIR"
+fi
+
+cd "$BUILD_DIR"
+
+cmake -DCMAKE_BUILD_TYPE=Release ..
+cmake --build . -j$(nproc)
+
+if [ "$1" == "test" ]; then
+    ctest --output-on-failure
+elif [ "$1" == "bench" ]; then
+    ./hash_bench
+fi
@@ -0,0 +1,128 @@
+// Usage:
+//   ./hash_bench [--seconds S] [--threads N] [--selftest-only]
+//
+// Cross-checks every hash backend first (exit 1 on any disagreement), then reports
+// GB/s per core for 64 B, 16 KiB, 256 KiB and 4 MiB inputs:
+//   single: the same buffer hashed repeatedly (hot cache)
+//   cold  : round-robin over distinct buffers totalling >= 64 MiB, one digest at a time
+//           (every input comes from memory, not cache)
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../hash_backends.hpp"
+
+using namespace bittorrent::sha;
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<uint8_t> g_sink{0};
+
+struct Options {
+    double seconds{0.3};
+    unsigned threads{1};
+    bool selftestOnly{false};
+};
+
+static Options parseArgs(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--seconds" && i + 1 < argc) o.seconds = std::stod(argv[++i]);
+        else if (a == "--threads" && i + 1 < argc) o.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (a == "--selftest-only") o.selftestOnly = true;
+        else { std::cerr << "unknown option " << a << "\n"; std::exit(2); }
+    }
+    if (o.threads == 0) o.threads = 1;
+    return o;
+}
+
+// Returns bytes hashed per second by one thread
+static double runOne(const HashBackend& b, std::size_t size, bool cold, double seconds) {
+    constexpr std::size_t kColdBytes = std::size_t(64) << 20;
+    const std::size_t nBufs = cold ? std::max<std::size_t>(16, kColdBytes / size) : 1;
+
+    std::mt19937 rng(static_cast<uint32_t>(size));
+    std::vector<std::vector<uint8_t>> bufs(nBufs, std::vector<uint8_t>(size));
+    for (auto& buf : bufs) for (auto& c : buf) c = static_cast<uint8_t>(rng());
+
+    uint8_t out[32];
+    uint8_t acc = 0;
+    std::size_t iters = 0, next = 0;
+
+    const auto deadline = Clock::now() + std::chrono::duration<double>(seconds);
+    const auto t0 = Clock::now();
+    Clock::time_point t1;
+
+    do {
+        for (int k = 0; k < 16; ++k) {
+            b.digest(bufs[next].data(), size, out);
+            acc ^= out[0];
+            if (++next == nBufs) next = 0;
+            ++iters;
+        }
+        t1 = Clock::now();
+    } while (t1 < deadline);
+
+    g_sink ^= acc;
+    return double(iters) * double(size) / std::chrono::duration<double>(t1 - t0).count();
+}
+
+static double runThreads(const HashBackend& b, std::size_t size, bool cold, const Options& o) {
+    std::vector<double> rates(o.threads);
+    std::vector<std::thread> ts;
+    for (unsigned t = 0; t < o.threads; ++t) {
+        ts.emplace_back([&, t] { rates[t] = runOne(b, size, cold, o.seconds); });
+    }
+    for (auto& t : ts) t.join();
+
+    double total = 0;
+    for (double r : rates) total += r;
+    return total / o.threads; // per core
+}
+
+int main(int argc, char** argv) {
+    const Options o = parseArgs(argc, argv);
+
+    std::cout << "CPU hash features: " << cpuFeatures() << "\n\n=== Self-test ===\n";
+
+    bool ok = true;
+    for (const auto& b : allBackends()) {
+        std::string why;
+        const bool pass = selfTest(b, &why);
+        ok = ok && pass;
+        std::cout << "  " << std::left << std::setw(20) << b.name << (pass ? "PASS" : "FAIL  " + why) << "\n";
+    }
+    if (!ok) return 1;
+
+    std::cout << "Selected: sha1=" << selectBackend(Algo::sha1).name
+              << " sha256=" << selectBackend(Algo::sha256).name << "\n";
+    if (o.selftestOnly) return 0;
+
+    const std::size_t sizes[] = {64, 16 * 1024, 256 * 1024, 4 * 1024 * 1024};
+
+    std::cout << "\n=== Throughput (GB/s per core, " << o.threads << " thread(s)) ===\n";
+    std::cout << std::left << std::setw(20) << "backend" << std::setw(8) << "mode";
+    for (auto s : sizes) std::cout << std::right << std::setw(10) << (s >= 1024 ? std::to_string(s / 1024) + "K" : std::to_string(s) + "B");
+    std::cout << "\n";
+
+    for (const auto& b : allBackends()) {
+        for (bool cold : {false, true}) {
+            std::cout << std::left << std::setw(20) << b.name << std::setw(8) << (cold ? "cold" : "single");
+            for (auto s : sizes) {
+                const double gbps = runThreads(b, s, cold, o) / 1e9;
+                std::cout << std::right << std::setw(10) << std::fixed << std::setprecision(3) << gbps;
+            }
+            std::cout << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <openssl/sha.h>
+
+#include "../hash_backends.hpp"
+
+using namespace bittorrent::sha;
+
+// --------------------- broken backends ---------------------
+// Right on the known-answer inputs (0, 3, 56 and 1000000 bytes), wrong on everything else.
+static void wrongSha1(const uint8_t* data, std::size_t len, uint8_t* out) {
+    ::SHA1(data, len, out);
+    if (len != 0 && len != 3 && len != 56 && len != 1000000) out[0] ^= 0xFF;
+}
+
+static void throwingSha256(const uint8_t*, std::size_t, uint8_t*) {
+    throw std::runtime_error("accelerator unavailable");
+}
+
+// --------------------- TESTS ---------------------
+
+TEST_CASE("selfTest: every shipped backend passes") {
+    for (const auto& b : allBackends()) {
+        std::string why;
+        INFO(b.name);
+        CHECK(selfTest(b, &why));
+        CHECK(why.empty());
+    }
+}
+
+TEST_CASE("selfTest: a backend wrong beyond the known answers fails the cross-check") {
+    const HashBackend bad{"wrong-sha1", Algo::sha1, wrongSha1};
+    std::string why;
+    CHECK_FALSE(selfTest(bad, &why));
+    CHECK(why == "wrong-sha1 disagrees with openssl-sha1 at 1 bytes");
+}
+
+TEST_CASE("firstPassing: a broken backend is skipped, not blamed on the others") {
+    std::vector<HashBackend> candidates{
+        {"wrong-sha1", Algo::sha1, wrongSha1},
+        {"throwing-sha256", Algo::sha256, throwingSha256},
+    };
+    candidates.insert(candidates.end(), allBackends().begin(), allBackends().end());
+
+    const HashBackend* sha1 = firstPassing(candidates, Algo::sha1);
+    REQUIRE(sha1 != nullptr);
+    CHECK(std::string(sha1->name) == "openssl-evp-sha1");
+
+    const HashBackend* sha256 = firstPassing(candidates, Algo::sha256);
+    REQUIRE(sha256 != nullptr);
+    CHECK(std::string(sha256->name) == "openssl-evp-sha256");
+
+    std::string why;
+    CHECK_FALSE(selfTest(candidates[1], &why));
+    CHECK(why == "throwing-sha256: accelerator unavailable");
+
+    CHECK(firstPassing({candidates[0]}, Algo::sha1) == nullptr);
+    CHECK(std::string(selectBackend(Algo::sha1).name) == "openssl-evp-sha1");
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "types.hpp"
+
+
+namespace bittorrent::tracker {
+
+
+    // RFC 3986 percent-encoding (unreserved characters pass through, the rest become
+    // %XX with uppercase hex), via a 256-entry lookup table.
+    void appendPercentEncoded(std::string& out, std::string_view raw);
+    std::string percentEncoded(std::string_view raw);
+
+
+    /**
+     * @brief Announce URL builder with the per-(torrent, endpoint) part encoded once.
+     *
+     * The constructor encodes everything that stays fixed for a torrent on one
+     * tracker: base URL, info_hash, peer_id, port, key, compact and no_peer_id.
+     * build() copies that prefix into a buffer it keeps between calls and appends
+     * the per-announce fields (uploaded, downloaded, left, event, numwant, ipv6,
+     * trackerid) with std::to_chars, so steady-state announces do not allocate.
+     *
+     * Not thread-safe; the view returned by build() is valid until the next call.
+     */
+    class AnnounceUrlBuilder
+    {
+    public:
+        AnnounceUrlBuilder(const std::string& baseUrl, const AnnounceRequest& req);
+
+        // Whether req shares the fields baked into the prefix.
+        bool matches(const AnnounceRequest& req) const;
+
+        std::string_view build(const AnnounceRequest& req);
+
+        const std::string& prefix() const noexcept { return prefix_; }
+
+    private:
+        std::string prefix_;
+        std::string buf_;
+
+        InfoHash infoHash_;
+        PeerID peerId_;
+        std::uint16_t port_;
+        std::uint32_t key_;
+        bool compact_;
+        bool noPeerId_;
+    };
+
+} // namespace bittorrent::tracker
@@ -9,8 +9,31 @@ namespace bittorrent::tracker {
 
     struct CompactPeerCodec 
     {
-        static std::vector<PeerAddr> parseIPv4(std::string_view raw);
-        static std::vector<PeerAddr> parseIPv6(std::string_view raw);
+        // BEP 23 "peers" (6-byte records) and BEP 7 "peers6" (18-byte records); a length
+        // that is not a whole number of records yields nothing.
+        static std::vector<PeerEndpoint> parseIPv4(std::string_view raw);
+        static std::vector<PeerEndpoint> parseIPv6(std::string_view raw);
+
+        // Same, appended to out without an intermediate vector; returns the number added.
+        static std::size_t appendIPv4(std::string_view raw, std::vector<PeerEndpoint>& out);
+        static std::size_t appendIPv6(std::string_view raw, std::vector<PeerEndpoint>& out);
+
+        /**
+         * @brief One implementation of the record copy (portable, SSSE3).
+         *
+         * Each function turns n packed records into n fully written PeerEndpoints.
+         */
+        struct Decoder
+        {
+            const char* name;
+            void (*v4)(const std::uint8_t* in, std::size_t n, PeerEndpoint* out);
+            void (*v6)(const std::uint8_t* in, std::size_t n, PeerEndpoint* out);
+        };
+
+        // Every decoder this CPU can run, portable first; tests and benchmarks cross-check them.
+        static const std::vector<Decoder>& decoders();
+        // The one appendIPv4/appendIPv6 use: the last (fastest) entry of decoders().
+        static const Decoder& decoder();
     };
 
-} // namespace bittorrent::tracker
\ No newline at end of file
+} // namespace bittorrent::tracker
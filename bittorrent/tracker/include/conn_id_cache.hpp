@@ -0,0 +1,55 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <sys/socket.h>
+
+
+namespace bittorrent::tracker {
+
+
+    /**
+     * @brief BEP-15 connection_id cache keyed by resolved tracker (address, port).
+     *
+     * A connection_id is valid for one minute from the tracker's point of view
+     * and is not tied to a torrent, so every torrent announcing to the same
+     * tracker can reuse it. Thread-safe; expired entries are dropped on lookup.
+     *
+     * shared() is the process-wide instance used by TrackerManager.
+     */
+    class ConnectionIdCache
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Entry
+        {
+            uint64_t connId{0};
+            Clock::time_point expiry{};
+        };
+
+        std::optional<Entry> get(const sockaddr_storage& addr, Clock::time_point now = Clock::now());
+        void put(const sockaddr_storage& addr, uint64_t connId, Clock::time_point expiry);
+
+        // Drop the entry, but only if it still holds connId (a newer id from another caller survives).
+        void invalidate(const sockaddr_storage& addr, uint64_t connId);
+
+        std::size_t size() const;
+
+        // Address bytes + port in network order; empty for non-IP families.
+        static std::string keyFor(const sockaddr_storage& addr);
+        // Same, into out; its capacity is reused.
+        static void keyFor(const sockaddr_storage& addr, std::string& out);
+
+        static std::shared_ptr<ConnectionIdCache> shared();
+
+    private:
+        mutable std::mutex mu_;
+        std::unordered_map<std::string, Entry> entries_;
+    };
+
+} // namespace bittorrent::tracker
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/socket.h>
+
+#include "expected.hpp"
+
+
+namespace bittorrent::tracker {
+
+
+    struct ResolvedAddr
+    {
+        sockaddr_storage addr{};    // port is 0; callers fill in their own
+        socklen_t len{0};
+    };
+
+    using ResolvedAddrs = std::vector<ResolvedAddr>;  // IPv4 first, then IPv6
+
+
+    struct DnsResolverConfig
+    {
+        unsigned threads{2};                        // concurrent getaddrinfo calls
+        std::chrono::seconds positiveTtl{300};      // getaddrinfo hides record TTLs; this caps reuse
+        std::chrono::seconds negativeTtl{30};       // failed lookups are remembered this long
+        std::size_t maxEntries{4096};               // cache cap: expired entries go first, then the soonest to expire
+
+        // Lookup function; defaults to getaddrinfo(AF_UNSPEC). Tests substitute their own.
+        std::function<Expected<ResolvedAddrs>(const std::string& host)> lookup;
+    };
+
+
+    /**
+     * @brief Asynchronous, caching host name resolver for tracker hosts.
+     *
+     * - A small thread pool runs the blocking lookups; callers never wait
+     *   unless they use resolveSync().
+     * - Results (including failures) are cached per host until their TTL runs out.
+     * - Concurrent requests for a host that is already being looked up are
+     *   coalesced into that lookup.
+     * - Numeric addresses are answered inline without touching the pool.
+     *
+     * Callbacks run on the calling thread for cache hits and numeric hosts,
+     * otherwise on a resolver thread; they must not block.
+     */
+    class DnsResolver
+    {
+    public:
+        using Callback = std::function<void(Expected<ResolvedAddrs>)>;
+
+        struct Stats
+        {
+            uint64_t lookups{0};        // lookups actually run
+            uint64_t hits{0};           // answered from cache (positive or negative)
+            uint64_t coalesced{0};      // joined an in-flight lookup
+        };
+
+        explicit DnsResolver(DnsResolverConfig cfg = {});
+        ~DnsResolver();
+
+        DnsResolver(const DnsResolver&) = delete;
+        DnsResolver& operator=(const DnsResolver&) = delete;
+
+        void resolve(const std::string& host, Callback cb);
+        // Numeric hosts and unexpired positive cache entries, copied into out (whose capacity
+        // is reused), without a callback. False when only resolve() can answer.
+        bool tryCached(const std::string& host, ResolvedAddrs& out);
+        Expected<ResolvedAddrs> resolveSync(const std::string& host);
+
+        Stats stats() const;
+        std::size_t cacheSize() const;
+
+        // Process-wide resolver shared by the HTTP and UDP trackers.
+        static std::shared_ptr<DnsResolver> shared();
+
+        // getaddrinfo(AF_UNSPEC) with IPv4 results ordered first.
+        static Expected<ResolvedAddrs> systemLookup(const std::string& host);
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct CacheEntry
+        {
+            Expected<ResolvedAddrs> result;
+            Clock::time_point expiry;
+        };
+
+        DnsResolverConfig cfg_;
+
+        mutable std::mutex mu_;
+        std::condition_variable cv_;
+        std::unordered_map<std::string, CacheEntry> cache_;
+        std::unordered_map<std::string, std::vector<Callback>> inflight_;
+        std::deque<std::string> queue_;
+        std::vector<std::thread> workers_;
+        bool stopping_{false};
+        Stats stats_{};
+
+        void workerLoop();
+        void makeRoom(Clock::time_point now);
+    };
+
+} // namespace bittorrent::tracker
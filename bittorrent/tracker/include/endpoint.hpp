@@ -35,6 +35,8 @@ namespace bittorrent::tracker {
         TrackerEndpoint& current();
         void rotate();
         bool anyAvailable(std::chrono::steady_clock::time_point now) const;
+        // BEP 12: a tracker that answered moves to the front of its tier, the rest keep their order.
+        void promote(std::size_t index);
     };
 
 
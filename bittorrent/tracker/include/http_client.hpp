@@ -1,5 +1,7 @@
 #pragma once
+#include <functional>
 #include <string>
+#include <utility>
 #include "expected.hpp"
 
 
@@ -9,10 +11,40 @@ namespace bittorrent::tracker {
 struct HttpResponse { int status{0}; std::string body; };
 
 
+using HttpCallback = std::function<void(Expected<HttpResponse>)>;
+
+
+// Returned by IHttpClient::getAsync. cancel() abandons a request that has not completed yet:
+// its callback runs at once (on the cancelling thread) with "http: cancelled" and the transfer
+// is torn down in the background. Copies share the request; an empty handle does nothing.
+class HttpRequestHandle
+{
+public:
+    HttpRequestHandle() = default;
+    explicit HttpRequestHandle(std::function<void()> cancel) : cancel_(std::move(cancel)) {}
+
+    void cancel() const { if (cancel_) cancel_(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(cancel_); }
+
+private:
+    std::function<void()> cancel_;
+};
+
+
 struct IHttpClient 
 {
     virtual ~IHttpClient() = default;
     virtual Expected<HttpResponse> get(const std::string& url, int connectTimeoutSec, int transferTimeoutSec, bool followRedirects) = 0;
+
+    // Non-blocking get(): cb runs exactly once, on a client thread (or inline if the request
+    // fails before it is queued) and must not block. The default simply runs get() inline,
+    // for clients without an event loop of their own.
+    virtual HttpRequestHandle getAsync(const std::string& url, int connectTimeoutSec, int transferTimeoutSec,
+                                       bool followRedirects, HttpCallback cb)
+    {
+        cb(get(url, connectTimeoutSec, transferTimeoutSec, followRedirects));
+        return {};
+    }
 };
 
 
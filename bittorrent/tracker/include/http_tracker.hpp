@@ -1,47 +1,91 @@
 #pragma once
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <string_view>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "iclient.hpp"
+#include "announce_url.hpp"
 #include "http_client.hpp"
 
 
 namespace bittorrent::tracker {
 
+    class DnsResolver;
+
 
     struct HttpTrackerConfig 
     {
         int connectTimeoutSec{8};
         int transferTimeoutSec{10};
         bool followRedirects{true};
+        std::size_t maxScrapeUrlLength{2048};   // multi-hash scrapes are split to stay under this
     };
 
 
     class HttpTracker : public ITrackerClient 
     {
     public:
+        using AnnounceCallback = std::function<void(Expected<AnnounceResponse>)>;
+        using ScrapeCallback = std::function<void(Expected<std::map<InfoHash, ScrapeStats>>)>;
+
         explicit HttpTracker(std::shared_ptr<IHttpClient> http, HttpTrackerConfig cfg = {});
         ~HttpTracker() override = default;
 
 
         Expected<AnnounceResponse> announce(const AnnounceRequest& req, const std::string& announceUrl) override;
+        // One info_hash= parameter per hash, split into several requests when the URL would
+        // exceed maxScrapeUrlLength; no hashes scrapes the whole tracker. Fails only if every
+        // request fails.
         Expected<std::map<InfoHash, ScrapeStats>> scrape(const std::vector<InfoHash>& hashes,
         const std::string& scrapeUrl) override;
 
+        // Non-blocking forms over IHttpClient::getAsync; callbacks follow its threading rules
+        // and may outlive this tracker. The handle cancels the underlying request(s).
+        HttpRequestHandle announceAsync(const AnnounceRequest& req, const std::string& announceUrl, AnnounceCallback cb);
+        HttpRequestHandle scrapeAsync(const std::vector<InfoHash>& hashes, const std::string& scrapeUrl, ScrapeCallback cb);
+
     private:
         std::shared_ptr<IHttpClient> http_;
         HttpTrackerConfig cfg_{};
+
+        // Announce URL prefixes, one per endpoint (rebuilt if the torrent's fixed fields change).
+        mutable std::mutex urlMu_;
+        mutable std::unordered_map<std::string, AnnounceUrlBuilder> urlBuilders_;
+
         std::string buildAnnounceUrl(const std::string& base, const AnnounceRequest& req) const;
-        static std::string percentEncode(std::string_view raw);
-        static std::string percentEncodeBinary(const unsigned char* data, std::size_t len);
-        Expected<AnnounceResponse> parseAnnounceBody(const std::string& body) const;
-        Expected<std::map<InfoHash, ScrapeStats>> parseScrapeBody(const std::string& body) const;
+        static Expected<AnnounceResponse> parseAnnounceBody(const std::string& body);
+        std::vector<std::string> buildScrapeUrls(const std::string& base, const std::vector<InfoHash>& hashes) const;
+        static Expected<std::size_t> parseScrapeBodyInto(const std::string& body, std::map<InfoHash, ScrapeStats>& out);
 
     };
 
 
-    // Factory (implemented in http_client_curl.cpp)
+    struct CurlMultiConfig
+    {
+        std::size_t maxIdleHandles{32};         // easy handles kept for reuse
+        std::size_t maxHostConnections{8};      // per tracker host; extra transfers queue inside curl
+        std::size_t maxTotalConnections{64};
+        bool acceptEncoding{true};              // advertise gzip/deflate; bodies are inflated as they stream in
+    };
+
+
+    // Factories (implemented in http_client_curl.cpp). Both clients advertise Accept-Encoding
+    // and hand back the decoded body. Host lookups go through the resolver passed in
+    // (nullptr => curl's own resolver); the no-argument forms use DnsResolver::shared().
+
+    // One easy handle per request; nothing survives between calls.
     std::shared_ptr<IHttpClient> makeCurlClient();
+    std::shared_ptr<IHttpClient> makeCurlClient(std::shared_ptr<DnsResolver> resolver);
+
+    // curl_multi on one I/O thread with pooled easy handles and a CURLSH sharing DNS, TLS
+    // sessions and connections: concurrent get()/getAsync() calls run in parallel and reuse
+    // kept-alive connections; getAsync() is fully non-blocking and cancellable. The
+    // no-argument form returns one process-wide client (TrackerManager's default).
+    std::shared_ptr<IHttpClient> makeCurlMultiClient();
+    std::shared_ptr<IHttpClient> makeCurlMultiClient(std::shared_ptr<DnsResolver> resolver, CurlMultiConfig cfg = {});
 
 
 } // namespace bittorrent::tracker
\ No newline at end of file
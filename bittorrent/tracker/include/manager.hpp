@@ -1,41 +1,94 @@
 #pragma once
 #include <atomic>
+#include <condition_variable>
 #include <functional>
+#include <list>
 #include <memory>
 #include <mutex>
-#include <thread>
+#include <optional>
 #include <vector>
 #include "types.hpp"
 #include "endpoint.hpp"
+#include "peer_pool.hpp"
+#include "peer_queue.hpp"
 #include "http_tracker.hpp"
 #include "udp_tracker.hpp"
+#include "scrape_aggregator.hpp"
+#include "tracker_scheduler.hpp"
 
 
 namespace bittorrent::tracker {
 
 
+    struct TrackerManagerConfig
+    {
+        bool allTiers{false};           // true: announce to every tier at once; false: next tier only once the ones before failed
+        std::size_t racePerTier{1};     // endpoints of one tier in flight together; 1 tries them one after another
+        std::size_t peerQueueBatches{32};   // peer batches waiting for drainNewPeers(); more are refused
+    };
+
+
     class TrackerManager {
     public:
-        using PeersCallback = std::function<void(const std::vector<PeerAddr>&)>;
+        using PeersReadyCallback = std::function<void()>;
+        using ScrapeCallback = std::function<void(const std::string& url, const Expected<ScrapeStats>&)>;
 
 
         TrackerManager(const std::vector<std::vector<std::string>>& announceList,
             InfoHash ih, PeerID pid, std::uint16_t port,
-            std::shared_ptr<IHttpClient> httpClient = nullptr);
+            std::shared_ptr<IHttpClient> httpClient = nullptr,
+            std::shared_ptr<TrackerScheduler> scheduler = nullptr,
+            TrackerManagerConfig cfg = {});
 
         ~TrackerManager();
 
 
+        // Periodic announces run on the scheduler's pool (TrackerScheduler::shared() by default)
+        // rather than on a thread per torrent. Each pass only sends requests; replies are handled
+        // on the transport threads. The default {false, 1} is the sequential BEP 12 order; with
+        // allTiers and racePerTier raised, tiers (and up to racePerTier endpoints of a tier) are in
+        // flight together and the first answer ends the round for its tier.
+        //
+        // stop() abandons announces in flight (HTTP and UDP) and returns once no pass or reply
+        // for this torrent is being handled; nothing is sent after that. Not from the
+        // peers-ready callback, which runs inside a reply handler.
         void start();
         void stop();
 
 
         void onStats(std::uint64_t uploaded, std::uint64_t downloaded, std::uint64_t left);
+        // Queues an announce and wakes this torrent's task, which sends it at once regardless of
+        // the trackers' intervals (disabled trackers excepted), to every tier or, with allTiers
+        // off, the first tier with a live tracker. A started or completed event no tracker
+        // confirmed rides along with the next announce. Announces queued before start() go out
+        // when it runs; stop() drops the ones still queued.
         void announce(AnnounceEvent ev = AnnounceEvent::none, std::uint32_t numwant = 50);
 
 
-        std::vector<PeerAddr> drainNewPeers();
-        void setPeersCallback(PeersCallback cb);
+        // Peers not handed out before, best first. Producers (announce replies, addPeers())
+        // only push batches onto a lock-free queue; this call, on the consumer's side, moves
+        // them into one deduplicated, bounded pool, so an endpoint reported by several tiers
+        // or announces comes out once. drainNewPeers() and reportConnectResult() belong to the
+        // peer layer and must not run concurrently with each other.
+        std::vector<PeerEndpoint> drainNewPeers();
+        // cb runs on the producer's thread when peers are queued after drainNewPeers() emptied
+        // the queue, at most once per drain; it should only wake the consumer. Set it before start().
+        void setPeersReadyCallback(PeersReadyCallback cb);
+
+        // Peers found outside the trackers (PEX, DHT, LSD), from any thread. Returns false when
+        // peerQueueBatches batches are already waiting: the batch is dropped and the source
+        // should hold back until the consumer catches up. Announce replies are dropped the same
+        // way, as the next announce reports them again.
+        bool addPeers(std::vector<PeerEndpoint> peers, PeerSource source);
+        // Connect outcome from the peer layer; failures push an endpoint down the ranking.
+        void reportConnectResult(const PeerEndpoint& peer, bool connected);
+        // Batches refused because the queue was full.
+        std::uint64_t droppedPeerBatches() const noexcept { return peerQueue_.rejected(); }
+
+        // Swarm stats from every tracker, batched with other torrents' scrapes (one multi-hash
+        // request per tracker). cb runs once per tracker, on the UDP engine or HTTP client thread.
+        // HTTP trackers are skipped unless their last path segment starts with "announce" (BEP 48).
+        void scrape(ScrapeCallback cb);
 
 
     private:
@@ -48,27 +101,69 @@ namespace bittorrent::tracker {
         std::mutex statsMu_;
 
 
+        TrackerManagerConfig cfg_;
         std::vector<TrackerTier> tiers_;
 
 
         std::shared_ptr<HttpTracker> http_;
         std::shared_ptr<UdpTracker> udp_;
+        std::shared_ptr<ScrapeAggregator> scrapes_;
+        std::shared_ptr<ScrapeAggregator> httpScrapes_;
 
 
-        std::vector<PeerAddr> pendingPeers_;
-        std::mutex peersMu_;
-        PeersCallback peersCb_{};
+        PeerBatchQueue peerQueue_;
+        PeerPool peerPool_;                     // consumer side only
+        PeersReadyCallback peersReady_{};
 
 
-        std::thread worker_;
+        std::shared_ptr<TrackerScheduler> sched_;
+        std::atomic<TrackerScheduler::TaskId> task_{0};
         std::atomic<bool> running_{false};
 
-
-        void workerLoop();
-        void tryOneTier(TrackerTier& tier, AnnounceEvent ev, std::uint32_t numwant);
-        ITrackerClient& clientFor(const TrackerEndpoint& ep);
+        struct QueuedAnnounce
+        {
+            AnnounceEvent event;
+            std::uint32_t numwant;
+        };
+
+        // One tier's current announce round: endpoints are tried in tier order, up to
+        // racePerTier at a time, until one answers or none is left.
+        struct Round
+        {
+            TrackerScheduler::Clock::time_point nextAnnounce{};  // the last winner's interval
+            std::vector<bool> tried;                              // per endpoint, this round
+            std::size_t inFlight{0};
+            bool failed{false};                                   // last round got no answer
+            bool forced{false};                                   // round carries a queued announce
+            AnnounceEvent event{AnnounceEvent::none};
+            std::uint32_t numwant{50};
+            std::optional<QueuedAnnounce> pending;                // queued, waiting for the tier to go idle
+        };
+
+        struct Flight;                                  // one request in flight (manager.cpp)
+        struct Launch;
+
+        // tiers_ and everything below are guarded by stateMu_; requests are sent and peers
+        // queued outside it.
+        std::mutex stateMu_;
+        std::vector<Round> rounds_;                     // parallel to tiers_
+        std::list<std::shared_ptr<Flight>> flights_;    // stop() detaches them
+        std::vector<QueuedAnnounce> queued_;            // announce() calls not sent yet
+        AnnounceEvent unacked_{AnnounceEvent::none};    // started/completed not confirmed
+        std::size_t handlers_{0};                       // replies being handled; stop() waits for none
+        std::condition_variable handlersIdle_;
+
+
+        TrackerScheduler::Clock::time_point runPass(TrackerScheduler::Clock::time_point now);
+        bool eligible(std::size_t tier) const;
+        TrackerScheduler::Clock::time_point dueAt(std::size_t tier) const;
+        void startRound(std::size_t tier, TrackerScheduler::Clock::time_point now, std::vector<Launch>& out);
+        void fill(std::size_t tier, TrackerScheduler::Clock::time_point now, std::vector<Launch>& out);
+        void launch(std::vector<Launch>& launches);
+        static void onReply(const std::shared_ptr<Flight>& f, Expected<AnnounceResponse> res);
+        void handleReply(Flight& f, Expected<AnnounceResponse> res);
         AnnounceRequest makeReq(AnnounceEvent ev, std::uint32_t numwant) const;
-        void deliverPeers(const std::vector<PeerAddr>& peers);
+        bool queuePeers(std::vector<PeerEndpoint>&& peers, PeerSource source);
     };
 
 
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+namespace bittorrent::tracker {
+
+
+    /**
+     * @brief One outgoing tracker datagram, aligned to a cache line.
+     *
+     * kCapacity fits the largest BEP-15 request (a 74-hash scrape is 1496 bytes).
+     */
+    struct alignas(64) PacketBuffer
+    {
+        static constexpr std::size_t kCapacity = 1536;
+
+        uint8_t data[kCapacity];
+        std::size_t len{0};
+    };
+
+
+    /**
+     * @brief Free list of PacketBuffers carved from preallocated slabs.
+     *
+     * acquire()/release() are O(1) and allocation-free while buffers are
+     * available; when the pool runs dry it adds one more slab of the same size
+     * and keeps it, so a steady workload stops allocating once the pool has
+     * grown to its peak. Not thread-safe: owned by one event loop.
+     */
+    class PacketPool
+    {
+    public:
+        explicit PacketPool(std::size_t perSlab = 256);
+
+        PacketPool(const PacketPool&) = delete;
+        PacketPool& operator=(const PacketPool&) = delete;
+
+        PacketBuffer* acquire();
+        void release(PacketBuffer* buf) noexcept;
+
+        std::size_t capacity() const noexcept { return slabs_.size() * perSlab_; }
+        std::size_t available() const noexcept { return free_.size(); }
+
+    private:
+        std::size_t perSlab_;
+        std::vector<std::unique_ptr<PacketBuffer[]>> slabs_;
+        std::vector<PacketBuffer*> free_;
+
+        void grow();
+    };
+
+} // namespace bittorrent::tracker
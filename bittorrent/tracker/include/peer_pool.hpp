@@ -0,0 +1,94 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "types.hpp"
+
+
+namespace bittorrent::tracker {
+
+
+    enum class PeerSource : std::uint8_t { tracker, pex, dht, lsd };
+
+
+    /**
+     * @brief Deduplicated, bounded set of candidate peers for one torrent.
+     *
+     * Open addressing with linear probing over a power-of-two table (at most half
+     * full), keyed by PeerEndpoint; deletion shifts the probe run back, so there are
+     * no tombstones. The table starts small and doubles as peers arrive, up to the
+     * size maxPeers needs; memory never grows past that, and a torrent that never
+     * sees many peers never pays for it.
+     *
+     * Every endpoint is remembered after it has been handed out, so later sightings
+     * from any source only refresh its bookkeeping. drainNew() returns the endpoints
+     * not handed out yet, best score first. When the pool is full, a new endpoint
+     * evicts the worst of a small sample of residents (handed out, failing, low score).
+     *
+     * Not thread-safe; TrackerManager fills it on the consumer's side of its PeerBatchQueue.
+     */
+    class PeerPool
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Entry
+        {
+            PeerEndpoint endpoint;
+            PeerSource source{PeerSource::tracker};     // first source that reported it
+            std::uint8_t sources{0};                    // bit per PeerSource seen so far
+            std::uint16_t failures{0};                  // connect attempts that failed
+            std::int32_t score{0};
+            bool drained{false};                        // already returned by drainNew()
+            Clock::time_point firstSeen{};
+        };
+
+        explicit PeerPool(std::size_t maxPeers = 2000);
+
+        // Returns true if the endpoint was not in the pool. Empty endpoints are ignored.
+        bool add(const PeerEndpoint& ep, PeerSource src, Clock::time_point now = Clock::now());
+        // Adds a batch; endpoints that were new are appended to fresh when given.
+        std::size_t add(const std::vector<PeerEndpoint>& eps, PeerSource src,
+                        Clock::time_point now = Clock::now(), std::vector<PeerEndpoint>* fresh = nullptr);
+
+        // Connection outcome from the peer layer: failures lower the score, a success clears them.
+        void recordFailure(const PeerEndpoint& ep);
+        void recordSuccess(const PeerEndpoint& ep);
+
+        // Undrained endpoints, highest score first (earliest seen on ties), at most max of them.
+        std::vector<PeerEndpoint> drainNew(std::size_t max = std::numeric_limits<std::size_t>::max());
+
+        const Entry* find(const PeerEndpoint& ep) const;
+        bool erase(const PeerEndpoint& ep);
+
+        std::size_t size() const noexcept { return size_; }
+        std::size_t pendingCount() const noexcept { return undrained_; }
+        std::size_t maxPeers() const noexcept { return maxPeers_; }
+        std::size_t evictions() const noexcept { return evictions_; }
+        // Slots allocated now; doubles with size() up to what maxPeers needs.
+        std::size_t slotCount() const noexcept { return slots_.size(); }
+
+    private:
+        static constexpr std::size_t kEvictSample = 16;
+
+        static constexpr std::size_t kInitialSlots = 16;
+
+        std::vector<Entry> slots_;      // endpoint.family == 0 marks an empty slot
+        std::size_t mask_{0};
+        std::size_t maxPeers_;
+        std::size_t maxSlots_;          // table size at maxPeers
+        std::size_t size_{0};
+        std::size_t undrained_{0};
+        std::size_t evictions_{0};
+        std::size_t evictCursor_{0};
+
+        std::size_t home(const PeerEndpoint& ep) const;
+        std::size_t findSlot(const PeerEndpoint& ep) const;     // index, or slots_.size() if absent
+        void grow();
+        void eraseAt(std::size_t i);
+        void evictOne();
+        static std::int32_t scoreOf(const Entry& e);
+    };
+
+} // namespace bittorrent::tracker
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "types.hpp"
+#include "peer_pool.hpp"
+
+
+namespace bittorrent::tracker {
+
+
+    struct PeerBatch
+    {
+        PeerSource source{PeerSource::tracker};
+        std::vector<PeerEndpoint> peers;
+    };
+
+
+    /**
+     * @brief Bounded lock-free queue of peer batches: many producers, one consumer.
+     *
+     * A power-of-two ring of cells, each stamped with a sequence number (Vyukov's
+     * bounded queue). A producer claims a cell with one CAS on the shared tail and
+     * publishes it with a release store; the consumer owns the head and touches no
+     * shared counter at all. Nothing blocks. The ring itself is allocated by the first
+     * push, so a torrent that never receives peers costs only the queue object; after
+     * that nothing allocates beyond the batches the producers hand in.
+     *
+     * Back-pressure: tryPush() fails once capacity batches are waiting and leaves the
+     * batch with the producer, who decides whether to drop, merge or retry it later.
+     *
+     * Wake-ups: the consumer calls park() after draining; the next successful push
+     * reports wakeConsumer, exactly once, so producers signal only an idle consumer.
+     */
+    class PeerBatchQueue
+    {
+    public:
+        enum class PushResult : std::uint8_t { full, queued, wakeConsumer };
+
+        explicit PeerBatchQueue(std::size_t capacity = 32);
+        ~PeerBatchQueue();
+
+        PeerBatchQueue(const PeerBatchQueue&) = delete;
+        PeerBatchQueue& operator=(const PeerBatchQueue&) = delete;
+
+        // Any thread. On full the batch is left untouched.
+        PushResult tryPush(PeerBatch&& batch);
+
+        // Consumer only.
+        bool tryPop(PeerBatch& out);
+        // Marks the consumer idle. Returns false if a batch is already waiting (drain again);
+        // otherwise the next push reports wakeConsumer.
+        bool park();
+
+        std::size_t capacity() const noexcept { return mask_ + 1; }
+        // Batches waiting; a snapshot when producers or the consumer are active.
+        std::size_t size() const noexcept;
+        // Pushes refused because the queue was full.
+        std::uint64_t rejected() const noexcept { return rejected_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Cell
+        {
+            std::atomic<std::size_t> seq{0};    // == position: free for that push; position + 1: holds its batch
+            PeerBatch batch;
+        };
+
+        // Producers: the ring, allocating it on first use (the losing racer frees its copy).
+        Cell* ring();
+
+        std::atomic<Cell*> cells_{nullptr};
+        std::size_t mask_;
+
+        alignas(64) std::atomic<std::size_t> tail_{0};      // next push position (producers)
+        alignas(64) std::atomic<std::size_t> head_{0};      // next pop position (written by the consumer only)
+        alignas(64) std::atomic<bool> parked_{true};
+        std::atomic<std::uint64_t> rejected_{0};
+    };
+
+
+} // namespace bittorrent::tracker
@@ -0,0 +1,82 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "types.hpp"
+#include "expected.hpp"
+#include "udp_engine.hpp"
+#include "http_tracker.hpp"
+
+
+namespace bittorrent::tracker {
+
+
+    struct ScrapeAggregatorConfig
+    {
+        std::chrono::milliseconds flushDelay{250};  // gather window opened by a tracker's first pending hash
+        std::size_t maxHashesPerPacket{74};         // per request; BEP 15 limit (16 + 74 * 20 = 1496 bytes) for UDP,
+                                                    // HTTP splits further by URL length
+    };
+
+
+    /**
+     * @brief Batches scrapes from many torrents into few tracker requests.
+     *
+     * request() files an info-hash under its tracker: host:port for UDP (BEP 15
+     * ignores the path), the full scrape URL for HTTP (paths and passkeys differ
+     * per tracker). A tracker's batch is sent as one scrape when it reaches
+     * maxHashesPerPacket or when flushDelay has passed since it opened, whichever
+     * comes first; the same info-hash requested by several torrents occupies one
+     * slot. Each reply is fanned back to every requester of the hashes it covers.
+     *
+     * Callbacks run on the engine thread for UDP, on the HTTP client's thread for
+     * HTTP (or inline for invalid URLs), and must not block. Flush timers run on
+     * the UDP engine's timer wheel in both cases; when the engine stops, open
+     * batches are sent at once (UDP scrapes then fail with the engine down).
+     */
+    class ScrapeAggregator
+    {
+    public:
+        using Callback = std::function<void(Expected<ScrapeStats>)>;
+
+        struct Stats
+        {
+            uint64_t requests{0};   // request() calls accepted
+            uint64_t packets{0};    // scrapes handed to the engine
+            uint64_t hashes{0};     // info-hashes across those scrapes
+        };
+
+        // BEP 15 scrapes through a UDP engine.
+        explicit ScrapeAggregator(std::shared_ptr<UdpTrackerEngine> engine, ScrapeAggregatorConfig cfg = {});
+        // Multi-hash HTTP scrapes through an HttpTracker; timers borrows its wheel from a UDP engine.
+        ScrapeAggregator(std::shared_ptr<HttpTracker> http, std::shared_ptr<UdpTrackerEngine> timers,
+                         ScrapeAggregatorConfig cfg = {});
+        ~ScrapeAggregator();
+
+        ScrapeAggregator(const ScrapeAggregator&) = delete;
+        ScrapeAggregator& operator=(const ScrapeAggregator&) = delete;
+
+        void request(const std::string& scrapeUrl, const InfoHash& ih, Callback cb);
+
+        // Send every pending batch now.
+        void flush();
+
+        Stats stats() const;
+
+        // Aggregator over UdpTracker::sharedEngine(), used by TrackerManager.
+        static std::shared_ptr<ScrapeAggregator> shared();
+        // HTTP counterpart over makeCurlMultiClient(), used by TrackerManager.
+        static std::shared_ptr<ScrapeAggregator> sharedHttp();
+
+    private:
+        struct Transport;
+        struct UdpTransport;
+        struct HttpTransport;
+        struct State;
+        std::shared_ptr<State> state_;  // shared with pending timers and engine callbacks
+    };
+
+} // namespace bittorrent::tracker
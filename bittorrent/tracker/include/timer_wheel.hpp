@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+
+namespace bittorrent::tracker {
+
+
+    /**
+     * @brief Hierarchical timing wheel (4 levels x 64 slots).
+     *
+     * Scheduling and cancelling are O(1); advance() costs O(1) per tick plus
+     * the timers that fire or cascade down a level. With the default 1 ms tick
+     * the wheel spans ~4.6 hours; later deadlines are parked in the top level
+     * and re-filed as time passes.
+     *
+     * Not thread-safe: meant to be owned by a single event loop that sleeps
+     * until nextExpiry() and then calls advance(now). Callbacks run inside
+     * advance() and may schedule or cancel timers.
+     */
+    class TimerWheel
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using TimerId = uint64_t;
+        using Callback = std::function<void()>;
+
+        explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds{1},
+                            Clock::time_point origin = Clock::now());
+
+        // Deadlines in the past fire on the next advance(). Ids are never 0.
+        TimerId schedule(Clock::time_point when, Callback cb);
+        bool cancel(TimerId id);
+        void clear();
+
+        // Fires everything due at or before now; returns how many callbacks ran.
+        std::size_t advance(Clock::time_point now);
+
+        // Earliest time advance() has work to do (a timer firing or cascading), if any.
+        std::optional<Clock::time_point> nextExpiry() const;
+
+        std::size_t size() const noexcept { return timers_.size(); }
+
+    private:
+        static constexpr int kLevels = 4;
+        static constexpr int kBits = 6;
+        static constexpr uint64_t kSlots = uint64_t(1) << kBits;
+        static constexpr uint64_t kMask = kSlots - 1;
+        static constexpr std::size_t kSlotReserve = 8;     // ids per slot before a slot grows (16 KiB in all)
+
+        struct Timer
+        {
+            uint64_t due;       // absolute tick
+            Callback cb;
+        };
+
+        Clock::duration tick_;
+        Clock::time_point origin_;
+        uint64_t current_{0};   // last processed tick
+        TimerId nextId_{1};
+
+        std::unordered_map<TimerId, Timer> timers_;
+        // Nodes of cancelled and fired timers, reused by schedule() so a steady load does not allocate.
+        std::vector<std::unordered_map<TimerId, Timer>::node_type> spare_;
+        // Cancelled ids linger until their slot is visited; slotLive() prunes the ones it walks past.
+        mutable std::array<std::array<std::vector<TimerId>, kSlots>, kLevels> slots_;
+        std::vector<TimerId> visiting_;     // the slot being fired or cascaded; swapped so capacity circulates
+
+        uint64_t tickOf(Clock::time_point t) const;
+        void place(TimerId id, uint64_t due);
+        void cascade(int level, uint64_t slot);
+        bool slotLive(int level, uint64_t slot) const;
+    };
+
+} // namespace bittorrent::tracker
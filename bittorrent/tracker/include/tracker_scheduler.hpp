@@ -0,0 +1,106 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace bittorrent::tracker {
+
+
+    struct TrackerSchedulerConfig
+    {
+        std::size_t threads{4};     // pool size; an announce pass occupies a thread while it runs
+    };
+
+
+    /**
+     * @brief Session-wide timer queue that drives the announces of every torrent.
+     *
+     * Each TrackerManager registers one task keyed by its torrent; the task runs an
+     * announce pass and returns when it next wants to run (the earliest nextAllowed
+     * of its endpoints). Due times live in a single indexed binary min-heap, so a
+     * session with 100k torrents costs 100k small heap slots rather than 100k
+     * threads, and moving a deadline earlier (wake()) is O(log n) with no stale
+     * entries left behind.
+     *
+     * A small pool of threads sleeps on one condition variable until the earliest
+     * deadline, pops it and runs the task outside the lock; the same task never runs
+     * on two threads at once. Tasks must not throw; they may call add()/wake()/remove()
+     * on the scheduler.
+     */
+    class TrackerScheduler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using TaskId = std::uint64_t;
+        // Runs on a pool thread; returns the next due time, or Clock::time_point::max()
+        // to stay parked until wake().
+        using Task = std::function<Clock::time_point(Clock::time_point now)>;
+
+        struct Stats
+        {
+            std::uint64_t runs{0};      // task invocations
+            std::size_t tasks{0};       // registered
+            std::size_t queued{0};      // waiting in the heap (the rest are parked or running)
+        };
+
+        explicit TrackerScheduler(TrackerSchedulerConfig cfg = {});
+        ~TrackerScheduler();
+
+        TrackerScheduler(const TrackerScheduler&) = delete;
+        TrackerScheduler& operator=(const TrackerScheduler&) = delete;
+
+        // Ids are never 0.
+        TaskId add(Task task, Clock::time_point firstRun = Clock::now());
+        // Run no later than when; never postpones. A running task runs again right after.
+        void wake(TaskId id, Clock::time_point when = Clock::now());
+        // Unregisters; waits for a run in progress unless called from that run.
+        void remove(TaskId id);
+
+        Stats stats() const;
+        std::size_t threads() const noexcept { return pool_.size(); }
+
+        // Scheduler used by every TrackerManager that is not given one.
+        static std::shared_ptr<TrackerScheduler> shared();
+
+    private:
+        static constexpr std::uint32_t kNotQueued = UINT32_MAX;
+
+        struct Slot
+        {
+            std::unique_ptr<Task> task;     // stable while the slots vector grows
+            Clock::time_point due{};
+            Clock::time_point wakeAt{Clock::time_point::max()};    // wake() during a run
+            std::uint32_t heapPos{kNotQueued};
+            std::uint32_t generation{0};
+            bool running{false};
+            bool removed{false};
+        };
+
+        mutable std::mutex mu_;
+        std::condition_variable cv_;        // pool threads: new earliest deadline or shutdown
+        std::condition_variable idle_;      // remove(): a removed task's run finished
+        std::vector<Slot> slots_;
+        std::vector<std::uint32_t> free_;
+        std::vector<std::uint32_t> heap_;   // slot indices, earliest due at [0]
+        std::uint64_t runs_{0};
+        std::size_t live_{0};
+        bool stopping_{false};
+        std::vector<std::thread> pool_;
+
+        void workerLoop();
+        Slot* find(TaskId id);
+        void push(std::uint32_t idx, Clock::time_point due);
+        void unlink(std::uint32_t idx);
+        void siftUp(std::uint32_t pos);
+        void siftDown(std::uint32_t pos);
+        void place(std::uint32_t pos, std::uint32_t idx);
+        void release(std::uint32_t idx);
+    };
+
+} // namespace bittorrent::tracker
@@ -6,6 +6,8 @@
 #include <string_view>
 #include <vector>
 #include <compare>
+#include <cstddef>
+#include <functional>
 
 
 namespace bittorrent::tracker {
@@ -28,12 +30,41 @@ namespace bittorrent::tracker {
     };
 
 
-    struct PeerAddr 
+    /**
+     * @brief A peer's IP and port in 19 bytes, laid out as compact peer lists carry them.
+     *
+     * Family byte, 16 address bytes (IPv4 uses the first 4, the rest stay zero) and the
+     * port in network order, so decoding a compact record is two copies and no allocation.
+     * Text is produced only when asked for (ip(), toString()).
+     */
+    struct PeerEndpoint
     {
-        std::string ip; // dotted or RFC5952
-        std::uint16_t port{0};
-        std::optional<std::array<std::uint8_t,20>> peerId; // rarely present w/ non-compact
+        static constexpr std::uint8_t kV4 = 4;
+        static constexpr std::uint8_t kV6 = 6;
+
+        std::uint8_t family{0};                 // kV4, kV6, or 0 for an empty endpoint
+        std::array<std::uint8_t,16> addr{};
+        std::array<std::uint8_t,2> portBE{};    // network byte order
+
+        static PeerEndpoint v4(const std::uint8_t* addr4, std::uint16_t port);
+        static PeerEndpoint v6(const std::uint8_t* addr16, std::uint16_t port);
+        // Numeric IPv4 or IPv6 text (no brackets); nullopt for anything else, DNS names included.
+        static std::optional<PeerEndpoint> parse(std::string_view ip, std::uint16_t port);
+
+        bool isV4() const { return family == kV4; }
+        bool isV6() const { return family == kV6; }
+        std::uint16_t port() const { return static_cast<std::uint16_t>((portBE[0] << 8) | portBE[1]); }
+        void setPort(std::uint16_t p) { portBE = {static_cast<std::uint8_t>(p >> 8), static_cast<std::uint8_t>(p)}; }
+
+        // Dotted quad or RFC 5952 text into out (at least kMaxIpText bytes); returns the length.
+        static constexpr std::size_t kMaxIpText = 46;
+        std::size_t formatIp(char* out) const;
+        std::string ip() const;
+        std::string toString() const;           // "1.2.3.4:6881" / "[::1]:6881"
+
+        auto operator<=>(const PeerEndpoint&) const = default;
     };
+    static_assert(sizeof(PeerEndpoint) == 19, "PeerEndpoint must stay packed");
 
 
     struct AnnounceRequest 
@@ -60,7 +91,7 @@ namespace bittorrent::tracker {
         std::optional<std::uint32_t> minInterval;
         std::uint32_t complete{0}; // seeders
         std::uint32_t incomplete{0}; // leechers
-        std::vector<PeerAddr> peers;
+        std::vector<PeerEndpoint> peers;
         std::optional<std::string> warning;
         std::optional<std::string> trackerId;
     };
@@ -74,4 +105,11 @@ namespace bittorrent::tracker {
         std::optional<std::string> name;
     };
     
-} // namespace bittorrent::tracker
\ No newline at end of file
+} // namespace bittorrent::tracker
+
+
+template <>
+struct std::hash<bittorrent::tracker::PeerEndpoint>
+{
+    std::size_t operator()(const bittorrent::tracker::PeerEndpoint& e) const noexcept;
+};
\ No newline at end of file
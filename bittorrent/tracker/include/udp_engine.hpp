@@ -0,0 +1,183 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <sys/socket.h>
+
+#include "types.hpp"
+#include "expected.hpp"
+#include "conn_id_cache.hpp"
+#include "timer_wheel.hpp"
+#include "dns_resolver.hpp"
+#include "packet_pool.hpp"
+
+
+namespace bittorrent::tracker {
+
+
+    struct UdpEngineConfig
+    {
+        std::chrono::milliseconds timeout{15000};   // BEP 15: retransmit after timeout * 2^n
+        int maxRetransmits{8};                      // give up once n would exceed this
+        std::chrono::seconds connTtl{60};           // connection_id lifetime
+        std::size_t ioBatch{32};                    // datagrams per sendmmsg/recvmmsg (max 32); 1 = sendto/recvfrom
+        bool ipv6{true};                            // open the IPv6 socket (false: IPv4 trackers only)
+    };
+
+
+    /**
+     * @brief Persistent, multiplexed BEP-15 client shared by many torrents.
+     *
+     * - One non-blocking UDP socket per address family, opened once in start().
+     *   Tracker names resolve to the first address whose family has a route,
+     *   and announces over IPv6 decode 18-byte peer entries (BEP 15).
+     * - A single I/O thread waits on epoll (sockets + an eventfd for wakeups);
+     *   retransmissions are TimerWheel entries, so a silent tracker costs a
+     *   timer rather than a sleeping thread.
+     * - Replies are routed back to their operation by transaction_id and
+     *   checked against the tracker address they were sent to, so thousands
+     *   of announces/scrapes can be in flight on the same socket.
+     * - Requests are encoded in place into pooled, cache-aligned buffers and
+     *   replies land in fixed receive slots. Operation records, their map and
+     *   timer nodes are recycled too, so once warmed up an announce to a known
+     *   tracker allocates nothing beyond the peers it returns.
+     * - Datagrams produced while handling one wakeup are queued and flushed
+     *   with sendmmsg at the end of it (EPOLLOUT resumes a flush the socket
+     *   buffer cut short); readable sockets are drained with recvmmsg.
+     * - connection_ids come from a ConnectionIdCache (connTtl); while one
+     *   connect to a tracker is outstanding, other operations for that
+     *   tracker wait for it instead of sending their own.
+     *
+     * announce()/scrape() never block: host names go through a DnsResolver
+     * (cached, asynchronous). Callbacks run on the engine thread (or the
+     * resolver's, for resolution failures) and must not block or destroy the
+     * engine; operations still pending when stop() is called complete with
+     * "udp: engine stopped" on the thread calling stop().
+     */
+    class UdpTrackerEngine
+    {
+    public:
+        using AnnounceCallback = std::function<void(Expected<AnnounceResponse>)>;
+        using ScrapeCallback   = std::function<void(Expected<std::map<InfoHash, ScrapeStats>>)>;
+
+        struct IoStats
+        {
+            uint64_t datagramsSent{0};
+            uint64_t sendCalls{0};          // sendmmsg/sendto syscalls
+            uint64_t datagramsReceived{0};
+            uint64_t recvCalls{0};          // recvmmsg/recvfrom syscalls that returned data
+        };
+
+        explicit UdpTrackerEngine(UdpEngineConfig cfg = {},
+                                  std::shared_ptr<ConnectionIdCache> connCache = nullptr,
+                                  std::shared_ptr<DnsResolver> resolver = nullptr);   // nullptr => DnsResolver::shared()
+        ~UdpTrackerEngine();
+
+        UdpTrackerEngine(const UdpTrackerEngine&) = delete;
+        UdpTrackerEngine& operator=(const UdpTrackerEngine&) = delete;
+
+        Expected<void> start();
+        void stop();
+        bool running() const noexcept { return running_.load(); }
+
+        void announce(const AnnounceRequest& req, const std::string& announceUrl, AnnounceCallback cb);
+        void scrape(const std::vector<InfoHash>& hashes, const std::string& scrapeUrl, ScrapeCallback cb);
+
+        // Run fn on the engine thread after delay. False (fn dropped) if the engine is not running;
+        // tasks still waiting when the engine stops run early, on the thread calling stop().
+        bool post(std::chrono::milliseconds delay, std::function<void()> fn);
+
+        // Operations submitted but not yet completed.
+        std::size_t inFlight() const noexcept { return inFlight_.load(); }
+
+        IoStats ioStats() const noexcept;
+
+    private:
+        struct Op;
+        struct Lifeline;
+        struct RxBuffers;
+        using Clock = std::chrono::steady_clock;
+
+        UdpEngineConfig cfg_;
+        std::shared_ptr<ConnectionIdCache> connCache_;
+        std::shared_ptr<DnsResolver> resolver_;
+        std::shared_ptr<Lifeline> lifeline_;
+
+        int v4Fd_{-1};
+        int v6Fd_{-1};
+        int epollFd_{-1};
+        int wakeFd_{-1};
+        std::thread io_;
+        std::atomic<bool> running_{false};
+        std::atomic<bool> v4Route_{true}, v6Route_{false};     // probed in start()
+        std::atomic<bool> v6Socket_{false};                    // v6Fd_ is open
+        std::atomic<std::size_t> inFlight_{0};
+        std::atomic<uint64_t> datagramsSent_{0}, sendCalls_{0}, datagramsReceived_{0}, recvCalls_{0};
+
+        // ---- Submission queue (any thread -> engine thread) ----
+        std::mutex queueMu_;
+        std::vector<std::unique_ptr<Op>> submitted_;
+        std::vector<std::pair<Clock::time_point, std::function<void()>>> posted_;
+
+        // ---- Finished operation records, reused by announce()/scrape() (any thread) ----
+        std::mutex opsMu_;
+        std::vector<std::unique_ptr<Op>> spareOps_;
+
+        // ---- Engine-thread state ----
+        using TxMap = std::unordered_map<uint32_t, std::unique_ptr<Op>>;
+        TxMap byTx_;
+        std::vector<TxMap::node_type> spareTx_;        // byTx_ nodes kept for reuse
+        std::vector<std::unique_ptr<Op>> draining_;    // drainSubmissions()' batch, kept for its capacity
+        TimerWheel timers_;
+        std::unordered_map<uint64_t, std::function<void()>> postedTasks_;  // post() tasks on timers_, run by stop() if due later
+        uint64_t nextPostedTask_{0};
+        std::unordered_map<std::string, std::vector<std::unique_ptr<Op>>> parked_; // endpoint -> ops waiting on its connect
+
+        struct Outgoing
+        {
+            sockaddr_storage addr{};
+            socklen_t addrlen{0};
+            PacketBuffer* buf{nullptr};            // owned by txPool_
+        };
+        std::vector<Outgoing> outbox4_, outbox6_;  // queued by transmit(), sent by flushOutbox()
+        bool wantOut4_{false}, wantOut6_{false};    // EPOLLOUT armed on that socket
+        PacketPool txPool_;
+        std::unique_ptr<RxBuffers> rx_;
+
+        const ResolvedAddr* pickAddress(const ResolvedAddrs& addrs) const;
+        void resolveAndSubmit(const std::string& url, std::unique_ptr<Op> op);
+        void submit(std::unique_ptr<Op> op);
+        std::unique_ptr<Op> acquireOp();
+        void recycleOp(std::unique_ptr<Op> op);
+        Op& track(std::unique_ptr<Op> op);             // into byTx_ under op->tx
+        std::unique_ptr<Op> untrack(TxMap::iterator it);
+        void loop();
+        void drainSubmissions();
+        void begin(std::unique_ptr<Op> op);
+        void startRequest(std::unique_ptr<Op> op, Clock::time_point now);
+        void transmit(Op& op, Clock::time_point now);
+        void flushOutbox();
+        bool sendQueued(int fd, std::vector<Outgoing>& q);
+        void armWritable(int fd, bool& armed, bool want);
+        void onReadable(int fd);
+        void handleDatagram(const uint8_t* p, std::size_t n, const sockaddr_storage& from);
+        void onTimeout(uint32_t tx);
+        int pollTimeoutMs(Clock::time_point now) const;
+        uint32_t freshTx() const;
+        void closeAll();
+
+        void finish(std::unique_ptr<Op> op, std::string error);
+        void finish(std::unique_ptr<Op> op, AnnounceResponse resp);
+        void finish(std::unique_ptr<Op> op, std::map<InfoHash, ScrapeStats> stats);
+    };
+
+} // namespace bittorrent::tracker
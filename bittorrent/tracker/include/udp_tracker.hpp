@@ -2,20 +2,13 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <array>
 #include <chrono>
-#include <optional>
+#include <memory>
 #include <cstdint>
-#include <sys/types.h>
-#include <sys/socket.h>
-#include <netdb.h>
-#include <unistd.h>
-#include <arpa/inet.h>
-#include <random>
-#include <cstring>
-#include <string>
 
 #include "iclient.hpp"
+#include "conn_id_cache.hpp"
+#include "udp_engine.hpp"
 
 namespace bittorrent::tracker {
 
@@ -24,17 +17,29 @@ namespace bittorrent::tracker {
      * @brief Minimal BEP-15 UDP tracker client.
      *
      * Conforms to ITrackerClient so TrackerManager can swap HTTP/UDP by scheme.
-     * - Fresh UDP socket per call (robust; avoids stale FDs across processes/forks).
-     * - Maintains a short-lived connection_id (60s) across calls inside this object.
-     * - IPv4 peers only (compact 6-byte entries) for Phase 1; IPv6 TODO.
+     * - Blocking facade over a UdpTrackerEngine: the calling thread waits on the
+     *   result, while retransmissions are timers on the engine's event loop
+     *   (no per-call sockets, no sleeping between attempts).
+     * - connection_ids (60s) live in a ConnectionIdCache keyed by tracker address;
+     *   pass a shared cache to reuse them across instances/torrents.
+     * - IPv4 and IPv6 trackers: 6-byte peer entries over IPv4, 18-byte over IPv6
+     *   (BEP 15); IPv6 literals go in brackets, e.g. udp://[2001:db8::1]:6969.
      *
      * Error handling:
      * - All network/protocol issues return Expected<T>::failure("...").
      * - UDP protocol error (action==3) is surfaced with the tracker’s error message text.
+     *
+     * Do not call announce()/scrape() from an engine callback: they wait on that thread.
      */
     class UdpTracker : public ITrackerClient {
     public:
-        UdpTracker() = default;
+        // Private engine; private cache unless one is given.
+        UdpTracker() : UdpTracker(std::shared_ptr<ConnectionIdCache>{}) {}
+        explicit UdpTracker(std::shared_ptr<ConnectionIdCache> cache);
+
+        // Share an already started engine (see sharedEngine()).
+        explicit UdpTracker(std::shared_ptr<UdpTrackerEngine> engine);
+
         ~UdpTracker() override = default;
 
         // ITrackerClient
@@ -45,50 +50,21 @@ namespace bittorrent::tracker {
         scrape(const std::vector<InfoHash>& hashes,
             const std::string& scrapeUrl) override;
 
-    private:
-        // ---- Connection cache (per instance) ----
-        uint64_t connId_{0};
-        std::chrono::steady_clock::time_point connExpiry_{};
-
-        // ---- Core helpers (implemented in .cpp) ----
-        static Expected<std::pair<sockaddr_storage, socklen_t>>
-        parseUdpUrl(const std::string& url);
+        UdpTrackerEngine& engine() noexcept { return *engine_; }
 
-        static Expected<int> makeUdpSocket(int family,
-                                        std::chrono::milliseconds recvTimeout);
+        // Process-wide engine using ConnectionIdCache::shared(); started on first use.
+        static std::shared_ptr<UdpTrackerEngine> sharedEngine();
 
-        static Expected<std::pair<uint64_t, std::chrono::steady_clock::time_point>>
-        connectAndGetConnId(const sockaddr_storage& addr, socklen_t addrlen, int sock,
-                            std::chrono::milliseconds timeoutPerAttempt,
-                            int maxAttempts, std::chrono::milliseconds backoffStart);
+        // Engine settings matching the knobs below.
+        static UdpEngineConfig engineConfig();
 
-        Expected<AnnounceResponse>
-        doAnnounce(const sockaddr_storage& addr, socklen_t addrlen, int sock,
-                const AnnounceRequest& req,
-                std::chrono::milliseconds timeoutPerAttempt,
-                int maxAttempts, std::chrono::milliseconds backoffStart);
-
-        Expected<std::map<InfoHash, ScrapeStats>>
-        doScrape(const sockaddr_storage& addr, socklen_t addrlen, int sock,
-                const std::vector<InfoHash>& hashes,
-                std::chrono::milliseconds timeoutPerAttempt,
-                int maxAttempts, std::chrono::milliseconds backoffStart);
-
-        // ---- Binary packing helpers (network byte order, big-endian) ----
-        static inline void put_u16(std::vector<uint8_t>& b, uint16_t v);
-        static inline void put_u32(std::vector<uint8_t>& b, uint32_t v);
-        static inline void put_u64(std::vector<uint8_t>& b, uint64_t v);
-        static inline uint16_t get_u16(const uint8_t* p);
-        static inline uint32_t get_u32(const uint8_t* p);
-        static inline uint64_t get_u64(const uint8_t* p);
-
-        static uint32_t rand_u32();
+    private:
+        std::shared_ptr<UdpTrackerEngine> engine_;
 
         // ---- Small tuning knobs (constants) ----
         static constexpr std::chrono::seconds kConnTtl{60};
-        static constexpr std::chrono::milliseconds kTimeout{1500};
+        static constexpr std::chrono::milliseconds kTimeout{1500};   // first retransmit; doubles per attempt
         static constexpr int kMaxAttempts = 8;
-        static constexpr std::chrono::milliseconds kBackoff{1500};
     };
 
 } // namespace bittorrent::tracker
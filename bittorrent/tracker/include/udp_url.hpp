@@ -11,6 +11,7 @@ namespace bittorrent::tracker::detail {
      * Examples:
      *  - udp://tracker.example.org:6969/announce  -> host="tracker.example.org", port=6969
      *  - udp://tracker.example.org                -> host="tracker.example.org", port=6969 (default)
+     *  - udp://[2001:db8::1]:6969/announce         -> host="2001:db8::1", port=6969 (brackets stripped)
      */
     struct UdpUrlParts {
         std::string host;
@@ -19,8 +20,15 @@ namespace bittorrent::tracker::detail {
 
     /**
      * @brief Parse a udp:// URL. Accepts missing port; defaults to 6969. Ignores path/query.
-     * Returns std::nullopt on failure (wrong scheme or empty host).
+     * IPv6 literals must be bracketed (RFC 3986).
+     * Returns std::nullopt on failure (wrong scheme, empty host, unclosed bracket or bad port).
      */
     std::optional<UdpUrlParts> parse_udp_url_minimal(const std::string& url);
 
+    /**
+     * @brief Same rules, into out; out.host keeps its capacity, so a reused UdpUrlParts
+     * parses without allocating. out is unspecified when this returns false.
+     */
+    bool parse_udp_url_into(const std::string& url, UdpUrlParts& out);
+
 } // namespace bittorrent::tracker::detail
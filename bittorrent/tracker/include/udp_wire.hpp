@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "types.hpp"
+
+
+namespace bittorrent::tracker::wire {
+
+    /**
+     * @brief Fixed-layout BEP-15 request encoders.
+     *
+     * Each encoder writes a whole request in place at the offsets below and
+     * returns its length; the caller provides at least that many bytes
+     * (PacketBuffer::kCapacity covers all of them). All integers are big-endian.
+     */
+
+    constexpr uint64_t kProtocolId = 0x41727101980ULL;
+
+    enum Action : uint32_t { kConnect = 0, kAnnounce = 1, kScrape = 2, kError = 3 };
+
+    // Common header: connection_id (or protocol id) | action | transaction_id
+    constexpr std::size_t kHeaderSize = 16;
+
+    // Announce body offsets
+    constexpr std::size_t kAnnInfoHash   = 16;
+    constexpr std::size_t kAnnPeerId     = 36;
+    constexpr std::size_t kAnnDownloaded = 56;
+    constexpr std::size_t kAnnLeft       = 64;
+    constexpr std::size_t kAnnUploaded   = 72;
+    constexpr std::size_t kAnnEvent      = 80;
+    constexpr std::size_t kAnnIp         = 84;
+    constexpr std::size_t kAnnKey        = 88;
+    constexpr std::size_t kAnnNumWant    = 92;
+    constexpr std::size_t kAnnPort       = 96;
+    constexpr std::size_t kAnnounceSize  = 98;
+
+    constexpr std::size_t kMaxScrapeHashes = 74;
+    constexpr std::size_t scrapeSize(std::size_t hashes) { return kHeaderSize + 20 * hashes; }
+
+    inline void store_be16(uint8_t* p, uint16_t v) {
+        p[0] = static_cast<uint8_t>(v >> 8);
+        p[1] = static_cast<uint8_t>(v);
+    }
+    inline void store_be32(uint8_t* p, uint32_t v) {
+        p[0] = static_cast<uint8_t>(v >> 24);
+        p[1] = static_cast<uint8_t>(v >> 16);
+        p[2] = static_cast<uint8_t>(v >> 8);
+        p[3] = static_cast<uint8_t>(v);
+    }
+    inline void store_be64(uint8_t* p, uint64_t v) {
+        store_be32(p, static_cast<uint32_t>(v >> 32));
+        store_be32(p + 4, static_cast<uint32_t>(v));
+    }
+    inline uint32_t load_be32(const uint8_t* p) {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    }
+    inline uint64_t load_be64(const uint8_t* p) {
+        return (uint64_t(load_be32(p)) << 32) | load_be32(p + 4);
+    }
+
+    inline void encodeHeader(uint8_t* out, uint64_t connId, Action action, uint32_t tx) {
+        store_be64(out, connId);
+        store_be32(out + 8, action);
+        store_be32(out + 12, tx);
+    }
+
+    inline std::size_t encodeConnect(uint8_t* out, uint32_t tx) {
+        encodeHeader(out, kProtocolId, kConnect, tx);
+        return kHeaderSize;
+    }
+
+    inline std::size_t encodeAnnounce(uint8_t* out, uint64_t connId, uint32_t tx, const AnnounceRequest& req) {
+        uint32_t ev = 0u;
+        switch (req.event) {
+            case AnnounceEvent::started:   ev = 1u; break;
+            case AnnounceEvent::completed: ev = 2u; break;
+            case AnnounceEvent::stopped:   ev = 3u; break;
+            default:                       ev = 0u; break;
+        }
+
+        encodeHeader(out, connId, kAnnounce, tx);
+        std::memcpy(out + kAnnInfoHash, req.infoHash.bytes.data(), 20);
+        std::memcpy(out + kAnnPeerId, req.peerId.bytes.data(), 20);
+        store_be64(out + kAnnDownloaded, req.downloaded);
+        store_be64(out + kAnnLeft, req.left);
+        store_be64(out + kAnnUploaded, req.uploaded);
+        store_be32(out + kAnnEvent, ev);
+        store_be32(out + kAnnIp, 0u);      // ip=0 (tracker detects)
+        store_be32(out + kAnnKey, req.key);
+        store_be32(out + kAnnNumWant, (req.numwant == 0) ? 0xFFFFFFFFu : req.numwant);
+        store_be16(out + kAnnPort, req.port);
+        return kAnnounceSize;
+    }
+
+    // Encodes at most kMaxScrapeHashes hashes.
+    inline std::size_t encodeScrape(uint8_t* out, uint64_t connId, uint32_t tx, const std::vector<InfoHash>& hashes) {
+        const std::size_t n = hashes.size() < kMaxScrapeHashes ? hashes.size() : kMaxScrapeHashes;
+        encodeHeader(out, connId, kScrape, tx);
+        uint8_t* p = out + kHeaderSize;
+        for (std::size_t i = 0; i < n; ++i, p += 20) std::memcpy(p, hashes[i].bytes.data(), 20);
+        return scrapeSize(n);
+    }
+
+} // namespace bittorrent::tracker::wire
@@ -0,0 +1,130 @@
+#include <array>
+#include <charconv>
+
+#include "announce_url.hpp"
+
+
+namespace bittorrent::tracker {
+
+    namespace {
+
+        constexpr std::array<bool, 256> kUnreserved = [] {
+            std::array<bool, 256> t{};
+            for (int c = 'A'; c <= 'Z'; ++c) t[c] = true;
+            for (int c = 'a'; c <= 'z'; ++c) t[c] = true;
+            for (int c = '0'; c <= '9'; ++c) t[c] = true;
+            t['-'] = t['_'] = t['.'] = t['~'] = true;
+            return t;
+        }();
+
+        constexpr char kHex[] = "0123456789ABCDEF";
+
+        // Longest decimal uint64_t is 20 digits.
+        void appendUint(std::string& out, std::uint64_t v) {
+            char buf[20];
+            auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+            out.append(buf, end);
+        }
+
+        void appendField(std::string& out, std::string_view name, std::uint64_t v) {
+            out += '&';
+            out.append(name);
+            out += '=';
+            appendUint(out, v);
+        }
+
+        const char* eventName(AnnounceEvent ev) {
+            switch (ev) {
+                case AnnounceEvent::started:   return "started";
+                case AnnounceEvent::completed: return "completed";
+                case AnnounceEvent::stopped:   return "stopped";
+                case AnnounceEvent::none:      break;
+            }
+            return nullptr;
+        }
+
+    } // namespace
+
+
+    void appendPercentEncoded(std::string& out, std::string_view raw)
+    {
+        // Size the output in one step, then write through a raw pointer.
+        std::size_t n = 0;
+        for (unsigned char c : raw) n += kUnreserved[c] ? 1 : 3;
+
+        const std::size_t at = out.size();
+        out.resize(at + n);
+        char* p = out.data() + at;
+        for (unsigned char c : raw) {
+            if (kUnreserved[c]) {
+                *p++ = static_cast<char>(c);
+            } else {
+                p[0] = '%';
+                p[1] = kHex[c >> 4];
+                p[2] = kHex[c & 0x0F];
+                p += 3;
+            }
+        }
+    }
+
+    std::string percentEncoded(std::string_view raw)
+    {
+        std::string out;
+        appendPercentEncoded(out, raw);
+        return out;
+    }
+
+
+    AnnounceUrlBuilder::AnnounceUrlBuilder(const std::string& baseUrl, const AnnounceRequest& req)
+        : infoHash_(req.infoHash), peerId_(req.peerId), port_(req.port), key_(req.key),
+          compact_(req.compact), noPeerId_(req.no_peer_id)
+    {
+        auto bytes = [](const auto& a) {
+            return std::string_view(reinterpret_cast<const char*>(a.data()), a.size());
+        };
+
+        prefix_.reserve(baseUrl.size() + 160);
+        prefix_ += baseUrl;
+        prefix_ += baseUrl.find('?') == std::string::npos ? '?' : '&';
+        prefix_ += "info_hash=";
+        appendPercentEncoded(prefix_, bytes(infoHash_.bytes));
+        prefix_ += "&peer_id=";
+        appendPercentEncoded(prefix_, bytes(peerId_.bytes));
+        appendField(prefix_, "port", port_);
+        appendField(prefix_, "compact", compact_ ? 1 : 0);
+        appendField(prefix_, "key", key_);
+        if (noPeerId_) prefix_ += "&no_peer_id=1";
+
+        // Room for the variable tail: five counters, the longest event and some slack.
+        buf_.reserve(prefix_.size() + 160);
+    }
+
+    bool AnnounceUrlBuilder::matches(const AnnounceRequest& req) const
+    {
+        return req.infoHash == infoHash_ && req.peerId.bytes == peerId_.bytes && req.port == port_ &&
+               req.key == key_ && req.compact == compact_ && req.no_peer_id == noPeerId_;
+    }
+
+    std::string_view AnnounceUrlBuilder::build(const AnnounceRequest& req)
+    {
+        buf_.assign(prefix_);
+        appendField(buf_, "uploaded", req.uploaded);
+        appendField(buf_, "downloaded", req.downloaded);
+        appendField(buf_, "left", req.left);
+        if (const char* e = eventName(req.event)) {
+            buf_ += "&event=";
+            buf_ += e;
+        }
+        appendField(buf_, "numwant", req.numwant);
+        if (req.ipv6) {
+            buf_ += "&ipv6=";
+            appendPercentEncoded(buf_, *req.ipv6);
+        }
+        if (req.trackerId) {
+            buf_ += "&trackerid=";
+            appendPercentEncoded(buf_, *req.trackerId);
+        }
+        return buf_;
+    }
+
+} // namespace bittorrent::tracker
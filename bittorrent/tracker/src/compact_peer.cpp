@@ -1,65 +1,134 @@
-#include <arpa/inet.h>
 #include <cstring>
 #include "../include/compact_peer_codec.hpp"
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BT_COMPACT_SSSE3 1
+#include <immintrin.h>
+#endif
+
 namespace bittorrent::tracker {
 
-    static std::vector<PeerAddr> parseCompact(std::string_view raw, int elemBytes) {
-        std::vector<PeerAddr> out;
+    // Records are copied as-is: the address bytes and the big-endian port already match
+    // PeerEndpoint's layout, so no byte swapping or formatting happens per peer.
 
-        if (elemBytes != 6 && elemBytes != 18) {
-            return out;
+    static void decodeV4Portable(const std::uint8_t* in, std::size_t n, PeerEndpoint* out) {
+        for (std::size_t i = 0; i < n; ++i, in += 6) {
+            PeerEndpoint& e = out[i];
+            e.family = PeerEndpoint::kV4;
+            std::memcpy(e.addr.data(), in, 4);
+            std::memset(e.addr.data() + 4, 0, 12);
+            std::memcpy(e.portBE.data(), in + 4, 2);
         }
+    }
 
-        const std::size_t n = raw.size() / elemBytes;
-        out.reserve(n);
-
-        const unsigned char* p = reinterpret_cast<const unsigned char*>(raw.data());
-
-        for (std::size_t i = 0; i < n; ++i) {
-            PeerAddr pa;
-            char buf[INET6_ADDRSTRLEN] = {0};
-
-            if (elemBytes == 6) {
-                // IPv4: 4 bytes address + 2 bytes port
-                if (!inet_ntop(AF_INET, p + i * 6, buf, sizeof(buf))) {
-                    continue;
-                }
-                pa.ip = buf;
-
-                std::uint16_t port;
-                std::memcpy(&port, p + i * 6 + 4, 2);
-                pa.port = ntohs(port);
-            } else {
-                // IPv6: 16 bytes address + 2 bytes port
-                if (!inet_ntop(AF_INET6, p + i * 18, buf, sizeof(buf))) {
-                    continue;
-                }
-                pa.ip = buf;
-
-                std::uint16_t port;
-                std::memcpy(&port, p + i * 18 + 16, 2);
-                pa.port = ntohs(port);
-            }
-
-            out.push_back(std::move(pa));
+    static void decodeV6Portable(const std::uint8_t* in, std::size_t n, PeerEndpoint* out) {
+        for (std::size_t i = 0; i < n; ++i, in += 18) {
+            PeerEndpoint& e = out[i];
+            e.family = PeerEndpoint::kV6;
+            std::memcpy(e.addr.data(), in, 16);
+            std::memcpy(e.portBE.data(), in + 16, 2);
         }
+    }
 
-        return out;
+#ifdef BT_COMPACT_SSSE3
+    // One 16-byte load covers two 6-byte records. Each 19-byte endpoint is written by two
+    // overlapping 16-byte stores built with pshufb: bytes 0..15 (family, address, zeros) and
+    // bytes 3..18 (address tail, zeros, port).
+    __attribute__((target("ssse3")))
+    static inline void decodeV4PairSsse3(const std::uint8_t* src, std::uint8_t* dst) {
+        constexpr char Z = static_cast<char>(0x80);    // pshufb: write zero
+        const __m128i headA = _mm_setr_epi8(Z, 0, 1, 2, 3, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z);
+        const __m128i tailA = _mm_setr_epi8(2, 3, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, 4, 5);
+        const __m128i headB = _mm_setr_epi8(Z, 6, 7, 8, 9, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z);
+        const __m128i tailB = _mm_setr_epi8(8, 9, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, Z, 10, 11);
+        const __m128i family = _mm_setr_epi8(PeerEndpoint::kV4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),      _mm_or_si128(_mm_shuffle_epi8(x, headA), family));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3),  _mm_shuffle_epi8(x, tailA));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 19), _mm_or_si128(_mm_shuffle_epi8(x, headB), family));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 22), _mm_shuffle_epi8(x, tailB));
     }
 
-    std::vector<PeerAddr> CompactPeerCodec::parseIPv4(std::string_view raw) {
-        if (raw.size() % 6 != 0) {
-            return {};
+    // Four records per iteration; loads never run past the blob, the tail goes through the
+    // portable loop.
+    __attribute__((target("ssse3")))
+    static void decodeV4Ssse3(const std::uint8_t* in, std::size_t n, PeerEndpoint* out) {
+        std::size_t i = 0;
+        auto* o = reinterpret_cast<std::uint8_t*>(out);
+        for (; i + 5 <= n; i += 4) {            // second load reads bytes 6(i+2) .. 6(i+2)+15
+            decodeV4PairSsse3(in + 6 * i, o + 19 * i);
+            decodeV4PairSsse3(in + 6 * (i + 2), o + 19 * (i + 2));
         }
-        return parseCompact(raw, 6);
+        decodeV4Portable(in + 6 * i, n - i, out + i);
+    }
+
+    // Bytes 0..15 are the family and the first 15 address bytes (a one-byte lane shift);
+    // bytes 3..18 are a straight copy of record bytes 2..17.
+    __attribute__((target("ssse3")))
+    static void decodeV6Ssse3(const std::uint8_t* in, std::size_t n, PeerEndpoint* out) {
+        const __m128i family = _mm_setr_epi8(PeerEndpoint::kV6, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        auto* o = reinterpret_cast<std::uint8_t*>(out);
+        for (std::size_t i = 0; i < n; ++i, in += 18, o += 19) {
+            const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+            const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o), _mm_or_si128(_mm_slli_si128(head, 1), family));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o + 3), tail);
+        }
+    }
+#endif
+
+    const std::vector<CompactPeerCodec::Decoder>& CompactPeerCodec::decoders() {
+        static const std::vector<Decoder> all = [] {
+            std::vector<Decoder> v{{"portable", decodeV4Portable, decodeV6Portable}};
+#ifdef BT_COMPACT_SSSE3
+            if (__builtin_cpu_supports("ssse3")) v.push_back({"ssse3", decodeV4Ssse3, decodeV6Ssse3});
+#endif
+            return v;
+        }();
+        return all;
+    }
+
+    const CompactPeerCodec::Decoder& CompactPeerCodec::decoder() {
+        static const Decoder& best = decoders().back();
+        return best;
     }
 
-    std::vector<PeerAddr> CompactPeerCodec::parseIPv6(std::string_view raw) {
-        if (raw.size() % 18 != 0) {
-            return {};
+    static std::size_t appendCompact(std::string_view raw, std::size_t elemBytes, bool v6,
+                                     std::vector<PeerEndpoint>& out) {
+        if (raw.size() % elemBytes != 0) {
+            return 0;
         }
-        return parseCompact(raw, 18);
+
+        const std::size_t n = raw.size() / elemBytes;
+        if (n == 0) return 0;
+        const std::size_t base = out.size();
+        out.resize(base + n);
+
+        const auto* p = reinterpret_cast<const std::uint8_t*>(raw.data());
+        const auto& d = CompactPeerCodec::decoder();
+        (v6 ? d.v6 : d.v4)(p, n, out.data() + base);
+        return n;
+    }
+
+    std::size_t CompactPeerCodec::appendIPv4(std::string_view raw, std::vector<PeerEndpoint>& out) {
+        return appendCompact(raw, 6, false, out);
+    }
+
+    std::size_t CompactPeerCodec::appendIPv6(std::string_view raw, std::vector<PeerEndpoint>& out) {
+        return appendCompact(raw, 18, true, out);
+    }
+
+    std::vector<PeerEndpoint> CompactPeerCodec::parseIPv4(std::string_view raw) {
+        std::vector<PeerEndpoint> out;
+        appendIPv4(raw, out);
+        return out;
+    }
+
+    std::vector<PeerEndpoint> CompactPeerCodec::parseIPv6(std::string_view raw) {
+        std::vector<PeerEndpoint> out;
+        appendIPv6(raw, out);
+        return out;
     }
 
 } // namespace bittorrent::tracker
@@ -0,0 +1,72 @@
+#include <netinet/in.h>
+#include "conn_id_cache.hpp"
+
+
+namespace bittorrent::tracker {
+
+    std::string ConnectionIdCache::keyFor(const sockaddr_storage& ss)
+    {
+        std::string k;
+        keyFor(ss, k);
+        return k;
+    }
+
+    void ConnectionIdCache::keyFor(const sockaddr_storage& ss, std::string& out)
+    {
+        out.clear();
+        if (ss.ss_family == AF_INET) {
+            const auto& a = reinterpret_cast<const sockaddr_in&>(ss);
+            out.append(reinterpret_cast<const char*>(&a.sin_addr), 4);
+            out.append(reinterpret_cast<const char*>(&a.sin_port), 2);
+        } else if (ss.ss_family == AF_INET6) {
+            const auto& a = reinterpret_cast<const sockaddr_in6&>(ss);
+            out.append(reinterpret_cast<const char*>(&a.sin6_addr), 16);
+            out.append(reinterpret_cast<const char*>(&a.sin6_port), 2);
+        }
+    }
+
+    std::optional<ConnectionIdCache::Entry>
+    ConnectionIdCache::get(const sockaddr_storage& addr, Clock::time_point now)
+    {
+        // Looked up on every announce; an IPv6 key does not fit the small-string buffer.
+        thread_local std::string key;
+        keyFor(addr, key);
+        std::lock_guard<std::mutex> lk(mu_);
+        auto it = entries_.find(key);
+        if (it == entries_.end()) return std::nullopt;
+        if (now >= it->second.expiry) {
+            entries_.erase(it);
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    void ConnectionIdCache::put(const sockaddr_storage& addr, uint64_t connId, Clock::time_point expiry)
+    {
+        auto key = keyFor(addr);
+        if (key.empty()) return;
+        std::lock_guard<std::mutex> lk(mu_);
+        entries_[std::move(key)] = Entry{connId, expiry};
+    }
+
+    void ConnectionIdCache::invalidate(const sockaddr_storage& addr, uint64_t connId)
+    {
+        const auto key = keyFor(addr);
+        std::lock_guard<std::mutex> lk(mu_);
+        auto it = entries_.find(key);
+        if (it != entries_.end() && it->second.connId == connId) entries_.erase(it);
+    }
+
+    std::size_t ConnectionIdCache::size() const
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        return entries_.size();
+    }
+
+    std::shared_ptr<ConnectionIdCache> ConnectionIdCache::shared()
+    {
+        static const auto instance = std::make_shared<ConnectionIdCache>();
+        return instance;
+    }
+
+} // namespace bittorrent::tracker
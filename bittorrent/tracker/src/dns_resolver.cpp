@@ -0,0 +1,234 @@
+#include <cstring>
+#include <future>
+#include <string_view>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "dns_resolver.hpp"
+
+
+namespace bittorrent::tracker {
+
+    namespace {
+
+        // Literal IPv4/IPv6 (optionally bracketed) without a lookup.
+        bool parseNumeric(const std::string& host, ResolvedAddr& out) {
+            // inet_pton wants a C string; copy onto the stack, as no literal is longer than this.
+            std::string_view v = host;
+            if (v.size() >= 2 && v.front() == '[' && v.back() == ']') v = v.substr(1, v.size() - 2);
+            char h[INET6_ADDRSTRLEN + 1];
+            if (v.size() >= sizeof(h)) return false;
+            std::memcpy(h, v.data(), v.size());
+            h[v.size()] = '\0';
+
+            out = ResolvedAddr{};
+            auto* v4 = reinterpret_cast<sockaddr_in*>(&out.addr);
+            if (::inet_pton(AF_INET, h, &v4->sin_addr) == 1) {
+                v4->sin_family = AF_INET;
+                out.len = sizeof(sockaddr_in);
+                return true;
+            }
+            out = ResolvedAddr{};
+            auto* v6 = reinterpret_cast<sockaddr_in6*>(&out.addr);
+            if (::inet_pton(AF_INET6, h, &v6->sin6_addr) == 1) {
+                v6->sin6_family = AF_INET6;
+                out.len = sizeof(sockaddr_in6);
+                return true;
+            }
+            return false;
+        }
+
+    } // namespace
+
+
+    DnsResolver::DnsResolver(DnsResolverConfig cfg) : cfg_(std::move(cfg))
+    {
+        if (!cfg_.lookup) cfg_.lookup = &DnsResolver::systemLookup;
+        const unsigned n = cfg_.threads == 0 ? 1 : cfg_.threads;
+        workers_.reserve(n);
+        for (unsigned i = 0; i < n; ++i) {
+            workers_.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    DnsResolver::~DnsResolver()
+    {
+        std::unordered_map<std::string, std::vector<Callback>> abandoned;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) {
+            if (t.joinable()) t.join();
+        }
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            abandoned.swap(inflight_);
+        }
+        for (auto& [host, cbs] : abandoned) {
+            for (auto& cb : cbs) cb(Expected<ResolvedAddrs>::failure("dns: resolver shut down"));
+        }
+    }
+
+    std::shared_ptr<DnsResolver> DnsResolver::shared()
+    {
+        static const auto instance = std::make_shared<DnsResolver>();
+        return instance;
+    }
+
+    Expected<ResolvedAddrs> DnsResolver::systemLookup(const std::string& host)
+    {
+        struct addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;     // one entry per address instead of one per socktype
+
+        struct addrinfo* res = nullptr;
+        const int rc = ::getaddrinfo(host.c_str(), nullptr, &hints, &res);
+        if (rc != 0) {
+            return Expected<ResolvedAddrs>::failure(std::string("dns: getaddrinfo failed: ") + gai_strerror(rc));
+        }
+
+        ResolvedAddrs v4, v6;
+        for (auto* ai = res; ai; ai = ai->ai_next) {
+            if (ai->ai_addrlen > sizeof(sockaddr_storage)) continue;
+            ResolvedAddr r;
+            std::memcpy(&r.addr, ai->ai_addr, ai->ai_addrlen);
+            r.len = static_cast<socklen_t>(ai->ai_addrlen);
+            if (ai->ai_family == AF_INET) v4.push_back(r);
+            else if (ai->ai_family == AF_INET6) v6.push_back(r);
+        }
+        ::freeaddrinfo(res);
+
+        // Prefer IPv4 first for compact peers (Phase 1).
+        v4.insert(v4.end(), v6.begin(), v6.end());
+        if (v4.empty()) return Expected<ResolvedAddrs>::failure("dns: no addresses for " + host);
+        return Expected<ResolvedAddrs>::success(std::move(v4));
+    }
+
+    void DnsResolver::resolve(const std::string& host, Callback cb)
+    {
+        ResolvedAddr numeric;
+        if (parseNumeric(host, numeric)) {
+            cb(Expected<ResolvedAddrs>::success(ResolvedAddrs{numeric}));
+            return;
+        }
+
+        std::unique_lock<std::mutex> lk(mu_);
+        if (stopping_) {
+            lk.unlock();
+            cb(Expected<ResolvedAddrs>::failure("dns: resolver shut down"));
+            return;
+        }
+
+        const auto now = Clock::now();
+        auto hit = cache_.find(host);
+        if (hit != cache_.end()) {
+            if (now < hit->second.expiry) {
+                ++stats_.hits;
+                auto result = hit->second.result;
+                lk.unlock();
+                cb(std::move(result));
+                return;
+            }
+            cache_.erase(hit);
+        }
+
+        auto [it, first] = inflight_.try_emplace(host);
+        it->second.push_back(std::move(cb));
+        if (!first) {
+            ++stats_.coalesced;
+            return;
+        }
+        queue_.push_back(host);
+        lk.unlock();
+        cv_.notify_one();
+    }
+
+    bool DnsResolver::tryCached(const std::string& host, ResolvedAddrs& out)
+    {
+        ResolvedAddr numeric;
+        if (parseNumeric(host, numeric)) {
+            out.assign(1, numeric);
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lk(mu_);
+        if (stopping_) return false;
+        auto hit = cache_.find(host);
+        if (hit == cache_.end() || !hit->second.result.has_value() || Clock::now() >= hit->second.expiry) return false;
+        ++stats_.hits;
+        out = hit->second.result.get();
+        return true;
+    }
+
+    Expected<ResolvedAddrs> DnsResolver::resolveSync(const std::string& host)
+    {
+        std::promise<Expected<ResolvedAddrs>> done;
+        auto result = done.get_future();
+        resolve(host, [&done](Expected<ResolvedAddrs> r) { done.set_value(std::move(r)); });
+        return result.get();
+    }
+
+    DnsResolver::Stats DnsResolver::stats() const
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        return stats_;
+    }
+
+    std::size_t DnsResolver::cacheSize() const
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        return cache_.size();
+    }
+
+    // At the cap: drops every expired entry, or, when none has expired, the one that expires
+    // soonest, so a cache full of live hosts still takes the new one.
+    void DnsResolver::makeRoom(Clock::time_point now)
+    {
+        auto soonest = cache_.end();
+        for (auto it = cache_.begin(); it != cache_.end();) {
+            if (now >= it->second.expiry) {
+                it = cache_.erase(it);
+                continue;
+            }
+            if (soonest == cache_.end() || it->second.expiry < soonest->second.expiry) soonest = it;
+            ++it;
+        }
+        if (cache_.size() >= cfg_.maxEntries && soonest != cache_.end()) cache_.erase(soonest);
+    }
+
+    void DnsResolver::workerLoop()
+    {
+        for (;;) {
+            std::string host;
+            {
+                std::unique_lock<std::mutex> lk(mu_);
+                cv_.wait(lk, [this] { return stopping_ || !queue_.empty(); });
+                if (stopping_) return;
+                host = std::move(queue_.front());
+                queue_.pop_front();
+                ++stats_.lookups;
+            }
+
+            auto result = cfg_.lookup(host);
+
+            std::vector<Callback> waiters;
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                const auto now = Clock::now();
+                if (cache_.size() >= cfg_.maxEntries && !cache_.count(host)) makeRoom(now);
+                cache_[host] = CacheEntry{result, now + (result.has_value() ? cfg_.positiveTtl : cfg_.negativeTtl)};
+
+                auto it = inflight_.find(host);
+                if (it != inflight_.end()) {
+                    waiters = std::move(it->second);
+                    inflight_.erase(it);
+                }
+            }
+            for (auto& cb : waiters) cb(result);
+        }
+    }
+
+} // namespace bittorrent::tracker
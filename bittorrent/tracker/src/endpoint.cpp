@@ -73,4 +73,11 @@ namespace bittorrent::tracker {
     }
 
 
+    void TrackerTier::promote(std::size_t index) {
+        if (index >= endpoints.size()) return;
+        std::rotate(endpoints.begin(), endpoints.begin() + index, endpoints.begin() + index + 1);
+        currentIndex = 0;
+    }
+
+
 } // namespace bittorrent::tracker
\ No newline at end of file
@@ -1,7 +1,22 @@
 #include <curl/curl.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
 #include "../include/http_client.hpp"
+#include "../include/dns_resolver.hpp"
+#include "../include/http_tracker.hpp"
 
 namespace bittorrent::tracker {
 
@@ -15,13 +30,68 @@ namespace bittorrent::tracker {
             return realSize;
         }
 
+        // "" = every encoding this libcurl can decode (gzip and deflate at least). curl inflates
+        // each chunk before writeCallback sees it, so only the decoded body is ever held.
+        constexpr const char* kAcceptEncoding = "";
+
+        // Host and port (default filled in) of an http(s) URL; nullopt for unparseable URLs
+        // (curl reports those itself) and for IPv6 literals, which need no lookup.
+        std::optional<std::pair<std::string, std::string>> hostAndPort(const std::string& url) {
+            CURLU* u = curl_url();
+            if (!u) return std::nullopt;
+
+            char* host = nullptr;
+            char* port = nullptr;
+            std::optional<std::pair<std::string, std::string>> out;
+            if (curl_url_set(u, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK &&
+                curl_url_get(u, CURLUPART_HOST, &host, 0) == CURLUE_OK &&
+                curl_url_get(u, CURLUPART_PORT, &port, CURLU_DEFAULT_PORT) == CURLUE_OK &&
+                host[0] != '[')
+            {
+                out.emplace(host, port);
+            }
+            curl_free(host);
+            curl_free(port);
+            curl_url_cleanup(u);
+            return out;
+        }
+
+        // "host:port:addr[,addr...]" for CURLOPT_RESOLVE.
+        std::string formatResolveEntry(const std::string& host, const std::string& port, const ResolvedAddrs& addrs) {
+            std::string entry = host + ":" + port + ":";
+            bool first = true;
+            for (const auto& a : addrs) {
+                char buf[INET6_ADDRSTRLEN] = {0};
+                const void* src = a.addr.ss_family == AF_INET
+                    ? static_cast<const void*>(&reinterpret_cast<const sockaddr_in&>(a.addr).sin_addr)
+                    : static_cast<const void*>(&reinterpret_cast<const sockaddr_in6&>(a.addr).sin6_addr);
+                if (!::inet_ntop(a.addr.ss_family, src, buf, sizeof(buf))) continue;
+                if (!first) entry += ",";
+                entry += a.addr.ss_family == AF_INET6 ? "[" + std::string(buf) + "]" : std::string(buf);
+                first = false;
+            }
+            return entry;
+        }
+
+        // Blocking variant for the one-shot client; empty when curl should resolve itself.
+        Expected<std::string> resolveEntry(DnsResolver& resolver, const std::string& url) {
+            auto hp = hostAndPort(url);
+            if (!hp) return Expected<std::string>::success({});
+            auto addrs = resolver.resolveSync(hp->first);
+            if (!addrs.has_value()) {
+                return Expected<std::string>::failure(addrs.error.has_value() ? addrs.error->message : "dns: resolve failed");
+            }
+            return Expected<std::string>::success(formatResolveEntry(hp->first, hp->second, addrs.get()));
+        }
+
     }
 
 
     class HttpClientCurl : public IHttpClient 
     {
     public:
-        HttpClientCurl() {
+        explicit HttpClientCurl(std::shared_ptr<DnsResolver> resolver)
+            : resolver_(std::move(resolver)) {
             curl_global_init(CURL_GLOBAL_DEFAULT);
         }
 
@@ -34,9 +104,20 @@ namespace bittorrent::tracker {
                                 int totalTimeout,
                                 bool followRedirects) override 
         {
+            // Host lookups go through the shared resolver (cache, negative cache, coalescing).
+            curl_slist* pinned = nullptr;
+            if (resolver_) {
+                auto entry = resolveEntry(*resolver_, url);
+                if (!entry.has_value()) {
+                    return Expected<HttpResponse>::failure(entry.error->message);
+                }
+                if (!entry.get().empty()) pinned = curl_slist_append(nullptr, entry.get().c_str());
+            }
+
             CURL* curl = curl_easy_init();
             
             if (!curl) {
+                curl_slist_free_all(pinned);
                 return Expected<HttpResponse>::failure("curl init failed");
             }
 
@@ -51,11 +132,14 @@ namespace bittorrent::tracker {
             curl_easy_setopt(curl, CURLOPT_TIMEOUT, totalTimeout);
             curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, followRedirects ? 1L : 0L);
             curl_easy_setopt(curl, CURLOPT_USERAGENT, "mytorrent/0.1");
+            curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, kAcceptEncoding);
+            if (pinned) curl_easy_setopt(curl, CURLOPT_RESOLVE, pinned);
 
             CURLcode res = curl_easy_perform(curl);
             long statusCode = 0;
             curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &statusCode);
             curl_easy_cleanup(curl);
+            curl_slist_free_all(pinned);
 
             if (res != CURLE_OK) {
                 return Expected<HttpResponse>::failure(
@@ -74,12 +158,323 @@ namespace bittorrent::tracker {
                 HttpResponse{static_cast<int>(statusCode), std::move(body)}
             );
         }
+
+    private:
+        std::shared_ptr<DnsResolver> resolver_;
+    };
+
+
+    /**
+     * curl_multi client: one I/O thread drives every transfer, easy handles are
+     * recycled through a pool, and a CURLSH shares the DNS cache, TLS sessions
+     * and connection pool across them, so repeat announces to a tracker reuse
+     * a kept-alive (and already TLS-handshaken) connection.
+     */
+    class HttpClientCurlMulti : public IHttpClient
+    {
+    public:
+        HttpClientCurlMulti(std::shared_ptr<DnsResolver> resolver, CurlMultiConfig cfg)
+            : resolver_(std::move(resolver)), cfg_(cfg), life_(std::make_shared<Lifeline>())
+        {
+            curl_global_init(CURL_GLOBAL_DEFAULT);
+            life_->client = this;
+
+            share_ = curl_share_init();
+            curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &HttpClientCurlMulti::lockShare);
+            curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &HttpClientCurlMulti::unlockShare);
+            curl_share_setopt(share_, CURLSHOPT_USERDATA, &shareLocks_);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+
+            multi_ = curl_multi_init();
+            curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(cfg_.maxHostConnections));
+            curl_multi_setopt(multi_, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(cfg_.maxTotalConnections));
+            curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+            io_ = std::thread([this] { loop(); });
+        }
+
+        ~HttpClientCurlMulti() override
+        {
+            {
+                std::lock_guard<std::mutex> lk(life_->mu);
+                life_->client = nullptr;
+            }
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                stopping_ = true;
+            }
+            curl_multi_wakeup(multi_);
+            if (io_.joinable()) io_.join();
+
+            // Still queued or running: fail them here, on the destroying thread.
+            for (auto& t : queue_) t->complete(Expected<HttpResponse>::failure("http: client shut down"));
+            for (auto& [h, t] : active_) {
+                curl_multi_remove_handle(multi_, h);
+                curl_easy_cleanup(h);
+                t->complete(Expected<HttpResponse>::failure("http: client shut down"));
+            }
+            for (CURL* h : idle_) curl_easy_cleanup(h);
+
+            curl_multi_cleanup(multi_);
+            curl_share_cleanup(share_);
+            curl_global_cleanup();
+        }
+
+        Expected<HttpResponse> get(const std::string& url, int connectTimeout, int totalTimeout,
+                                   bool followRedirects) override
+        {
+            std::promise<Expected<HttpResponse>> done;
+            auto result = done.get_future();
+            getAsync(url, connectTimeout, totalTimeout, followRedirects,
+                     [&done](Expected<HttpResponse> r) { done.set_value(std::move(r)); });
+            return result.get();
+        }
+
+        HttpRequestHandle getAsync(const std::string& url, int connectTimeout, int totalTimeout,
+                                   bool followRedirects, HttpCallback cb) override
+        {
+            auto t = std::make_shared<Transfer>();
+            t->url = url;
+            t->connectTimeout = connectTimeout;
+            t->totalTimeout = totalTimeout;
+            t->followRedirects = followRedirects;
+            t->cb = std::move(cb);
+
+            HttpRequestHandle handle([life = life_, weak = std::weak_ptr<Transfer>(t)] {
+                auto t = weak.lock();
+                if (!t || !t->complete(Expected<HttpResponse>::failure("http: cancelled"))) return;
+                std::lock_guard<std::mutex> lk(life->mu);
+                if (life->client) life->client->reap(t);
+            });
+
+            auto hp = resolver_ ? hostAndPort(url) : std::nullopt;
+            if (!hp) {
+                enqueue(std::move(t));
+                return handle;
+            }
+            // Host lookups go through the shared resolver (cache, negative cache, coalescing).
+            resolver_->resolve(hp->first, [life = life_, t, hp](Expected<ResolvedAddrs> r) {
+                if (!r.has_value()) {
+                    t->complete(Expected<HttpResponse>::failure(r.error.has_value() ? r.error->message : "dns: resolve failed"));
+                    return;
+                }
+                if (t->isDone()) return;    // cancelled during the lookup
+                t->pinned = curl_slist_append(nullptr, formatResolveEntry(hp->first, hp->second, r.get()).c_str());
+                std::lock_guard<std::mutex> lk(life->mu);
+                if (life->client) life->client->enqueue(t);
+                else t->complete(Expected<HttpResponse>::failure("http: client shut down"));
+            });
+            return handle;
+        }
+
+    private:
+        struct Transfer
+        {
+            std::string url;
+            int connectTimeout{0};
+            int totalTimeout{0};
+            bool followRedirects{true};
+            HttpCallback cb;
+
+            std::string body;
+            char error[CURL_ERROR_SIZE] = {0};
+            curl_slist* pinned{nullptr};
+            std::atomic<bool> done{false};
+
+            ~Transfer() { curl_slist_free_all(pinned); }
+
+            // First caller wins: completion, cancellation and shutdown race for the callback.
+            bool complete(Expected<HttpResponse> r) {
+                if (done.exchange(true)) return false;
+                auto fn = std::move(cb);
+                fn(std::move(r));
+                return true;
+            }
+            bool isDone() const { return done.load(); }
+        };
+
+        // Lets resolver callbacks that outlive the client see that it is gone.
+        struct Lifeline
+        {
+            std::mutex mu;
+            HttpClientCurlMulti* client{nullptr};
+        };
+
+        static void lockShare(CURL*, curl_lock_data data, curl_lock_access, void* userp) {
+            auto* locks = static_cast<std::array<std::mutex, CURL_LOCK_DATA_LAST>*>(userp);
+            (*locks)[data].lock();
+        }
+        static void unlockShare(CURL*, curl_lock_data data, void* userp) {
+            auto* locks = static_cast<std::array<std::mutex, CURL_LOCK_DATA_LAST>*>(userp);
+            (*locks)[data].unlock();
+        }
+
+        // Cancelled while running: hand the easy handle back (I/O thread does the removal).
+        void reap(std::shared_ptr<Transfer> t)
+        {
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                if (stopping_) return;
+                cancelled_.push_back(std::move(t));
+            }
+            curl_multi_wakeup(multi_);
+        }
+
+        void enqueue(std::shared_ptr<Transfer> t)
+        {
+            {
+                std::lock_guard<std::mutex> lk(mu_);
+                if (!stopping_) {
+                    queue_.push_back(std::move(t));
+                    t = nullptr;
+                }
+            }
+            if (t) t->complete(Expected<HttpResponse>::failure("http: client shut down"));
+            else curl_multi_wakeup(multi_);
+        }
+
+        CURL* acquireHandle()
+        {
+            if (idle_.empty()) return curl_easy_init();
+            CURL* h = idle_.back();
+            idle_.pop_back();
+            curl_easy_reset(h);     // clears options; the shared caches and connections survive
+            return h;
+        }
+
+        void releaseHandle(CURL* h)
+        {
+            if (idle_.size() < cfg_.maxIdleHandles) idle_.push_back(h);
+            else curl_easy_cleanup(h);
+        }
+
+        void start(std::shared_ptr<Transfer> t)
+        {
+            if (t->isDone()) return;    // cancelled while queued
+            CURL* h = acquireHandle();
+            if (!h) {
+                t->complete(Expected<HttpResponse>::failure("curl init failed"));
+                return;
+            }
+            curl_easy_setopt(h, CURLOPT_URL, t->url.c_str());
+            curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, writeCallback);
+            curl_easy_setopt(h, CURLOPT_WRITEDATA, &t->body);
+            curl_easy_setopt(h, CURLOPT_ERRORBUFFER, t->error);
+            curl_easy_setopt(h, CURLOPT_CONNECTTIMEOUT, static_cast<long>(t->connectTimeout));
+            curl_easy_setopt(h, CURLOPT_TIMEOUT, static_cast<long>(t->totalTimeout));
+            curl_easy_setopt(h, CURLOPT_FOLLOWLOCATION, t->followRedirects ? 1L : 0L);
+            curl_easy_setopt(h, CURLOPT_USERAGENT, "mytorrent/0.1");
+            curl_easy_setopt(h, CURLOPT_ACCEPT_ENCODING, cfg_.acceptEncoding ? kAcceptEncoding : nullptr);
+            curl_easy_setopt(h, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(h, CURLOPT_SHARE, share_);
+            if (t->pinned) curl_easy_setopt(h, CURLOPT_RESOLVE, t->pinned);
+
+            if (curl_multi_add_handle(multi_, h) != CURLM_OK) {
+                releaseHandle(h);
+                t->complete(Expected<HttpResponse>::failure("curl: multi add failed"));
+                return;
+            }
+            active_.emplace_back(h, std::move(t));
+        }
+
+        void drop(const std::shared_ptr<Transfer>& t)
+        {
+            for (auto it = active_.begin(); it != active_.end(); ++it) {
+                if (it->second != t) continue;
+                curl_multi_remove_handle(multi_, it->first);
+                releaseHandle(it->first);
+                active_.erase(it);
+                return;
+            }
+        }
+
+        void finish(CURL* h, CURLcode res)
+        {
+            auto it = active_.begin();
+            while (it != active_.end() && it->first != h) ++it;
+            if (it == active_.end()) return;
+            auto t = std::move(it->second);
+            active_.erase(it);
+
+            long statusCode = 0;
+            curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE, &statusCode);
+            curl_multi_remove_handle(multi_, h);
+            releaseHandle(h);
+
+            if (res != CURLE_OK) {
+                t->complete(Expected<HttpResponse>::failure(
+                    std::string("curl error: ") + (t->error[0] ? t->error : curl_easy_strerror(res))));
+            } else if (statusCode >= 400) {
+                t->complete(Expected<HttpResponse>::failure("HTTP status " + std::to_string(statusCode)));
+            } else {
+                t->complete(Expected<HttpResponse>::success(HttpResponse{static_cast<int>(statusCode), std::move(t->body)}));
+            }
+        }
+
+        void loop()
+        {
+            for (;;) {
+                std::deque<std::shared_ptr<Transfer>> incoming;
+                std::vector<std::shared_ptr<Transfer>> cancelled;
+                {
+                    std::lock_guard<std::mutex> lk(mu_);
+                    if (stopping_) return;
+                    incoming.swap(queue_);
+                    cancelled.swap(cancelled_);
+                }
+                for (auto& t : cancelled) drop(t);
+                for (auto& t : incoming) start(std::move(t));
+
+                int running = 0;
+                curl_multi_perform(multi_, &running);
+
+                int left = 0;
+                while (CURLMsg* m = curl_multi_info_read(multi_, &left)) {
+                    if (m->msg == CURLMSG_DONE) finish(m->easy_handle, m->data.result);
+                }
+
+                curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+            }
+        }
+
+        std::shared_ptr<DnsResolver> resolver_;
+        CurlMultiConfig cfg_;
+        std::shared_ptr<Lifeline> life_;
+
+        CURLSH* share_{nullptr};
+        CURLM* multi_{nullptr};
+        std::array<std::mutex, CURL_LOCK_DATA_LAST> shareLocks_;
+        std::thread io_;
+
+        std::mutex mu_;
+        bool stopping_{false};
+        std::deque<std::shared_ptr<Transfer>> queue_;           // guarded by mu_
+        std::vector<std::shared_ptr<Transfer>> cancelled_;      // guarded by mu_
+
+        // I/O thread only
+        std::vector<std::pair<CURL*, std::shared_ptr<Transfer>>> active_;
+        std::vector<CURL*> idle_;
     };
 
 
     // Factory helper — link this TU and call for production
+    std::shared_ptr<IHttpClient> makeCurlClient(std::shared_ptr<DnsResolver> resolver) {
+        return std::make_shared<HttpClientCurl>(std::move(resolver));
+    }
+
     std::shared_ptr<IHttpClient> makeCurlClient() {
-        return std::make_shared<HttpClientCurl>();
+        return makeCurlClient(DnsResolver::shared());
+    }
+
+    std::shared_ptr<IHttpClient> makeCurlMultiClient(std::shared_ptr<DnsResolver> resolver, CurlMultiConfig cfg) {
+        return std::make_shared<HttpClientCurlMulti>(std::move(resolver), cfg);
+    }
+
+    std::shared_ptr<IHttpClient> makeCurlMultiClient() {
+        static const auto instance = makeCurlMultiClient(DnsResolver::shared(), {});
+        return instance;
     }
 
 } // namespace bittorrent::tracker
@@ -1,7 +1,7 @@
+#include <algorithm>
 #include <cstring>
-#include <sstream>
+#include <future>
 #include <vector>
-#include <iomanip>
 #include "../include/http_tracker.hpp"
 #include "../include/compact_peer_codec.hpp"
 #include "../../bencode/bencode.hpp"
@@ -12,56 +12,26 @@ namespace bittorrent::tracker {
         : http_(std::move(http)), cfg_(cfg) {}
 
 
-    std::string HttpTracker::percentEncode(std::string_view raw) 
-    {
-        std::ostringstream oss;
-        for (unsigned char c : raw) {
-            if ((c>='A'&&c<='Z')||(c>='a'&&c<='z')||(c>='0'&&c<='9')||c=='-'||c=='_'||c=='.'||c=='~') oss<<c; 
-            else {
-                oss<<'%'<<std::uppercase<<std::hex<<std::setw(2)<<std::setfill('0')<<(int)c<<std::nouppercase<<std::dec;}
-            }
-        return oss.str();
-    }
-
-
-    std::string HttpTracker::percentEncodeBinary(const unsigned char* data, std::size_t len) {
-        return percentEncode(std::string_view(reinterpret_cast<const char*>(data), len));
-    }
-
-
     std::string HttpTracker::buildAnnounceUrl(const std::string& base, const AnnounceRequest& req) const 
     {
-        std::ostringstream url; url << base; if (base.find('?')==std::string::npos) url<<'?'; else url<<'&';
-
-        url << "info_hash=" << percentEncodeBinary(req.infoHash.bytes.data(), req.infoHash.bytes.size());
-        url << "&peer_id=" << percentEncodeBinary(req.peerId.bytes.data(), req.peerId.bytes.size());
-        url << "&port=" << req.port;
-        url << "&uploaded=" << req.uploaded;
-        url << "&downloaded=" << req.downloaded;
-        url << "&left=" << req.left;
-
-        if (req.event != AnnounceEvent::none) {
-            const char* e = (req.event == AnnounceEvent::started) ? "started" : (req.event == AnnounceEvent::completed ? "completed" : "stopped");
-            url << "&event=" << e;
+        std::lock_guard<std::mutex> lk(urlMu_);
+        auto it = urlBuilders_.find(base);
+        if (it == urlBuilders_.end()) {
+            it = urlBuilders_.try_emplace(base, base, req).first;
+        } else if (!it->second.matches(req)) {
+            it->second = AnnounceUrlBuilder(base, req);
         }
-
-        url << "&compact=" << (req.compact ? 1 : 0);
-        url << "&numwant=" << req.numwant;
-        url << "&key=" << req.key;
-
-        if (req.no_peer_id) url << "&no_peer_id=1";
-        if (req.ipv6) url << "&ipv6=" << percentEncode(*req.ipv6);
-        if (req.trackerId) url << "&trackerid=" << percentEncode(*req.trackerId);
-
-        return url.str();
+        return std::string(it->second.build(req));
     }
 
 
-    Expected<AnnounceResponse> HttpTracker::parseAnnounceBody(const std::string& body) const 
+    Expected<AnnounceResponse> HttpTracker::parseAnnounceBody(const std::string& body) 
     {
         using namespace bencode;
 
-        BencodeValue root = BencodeParser::parse(std::string_view(body));
+        BencodeValue root;
+        try { root = BencodeParser::parse(std::string_view(body)); }
+        catch (const std::exception& e) { return Expected<AnnounceResponse>::failure(std::string("announce body: ") + e.what()); }
 
         if (!root.isDict()) return Expected<AnnounceResponse>::failure("announce body not a dict");
 
@@ -85,55 +55,94 @@ namespace bittorrent::tracker {
         if (auto it = dict.find("peers"); it!=dict.end()) {
 
             if (it->second.isString()) {
-                const auto& s = it->second.asString();
-                auto v4 = CompactPeerCodec::parseIPv4(std::string_view(s));
-                resp.peers.insert(resp.peers.end(), v4.begin(), v4.end());
+                CompactPeerCodec::appendIPv4(std::string_view(it->second.asString()), resp.peers);
 
             } else if (it->second.isList()) {
+                // Numeric "ip" values only; the rare DNS-name entry has no binary form and is skipped.
+                resp.peers.reserve(it->second.asList().size());
                 for (auto const& item : it->second.asList()) {
-                    if (!item.isDict()) continue; const auto& d = item.asDict(); PeerAddr pa;
-                    if (auto ipIt = d.find("ip"); ipIt!=d.end() && ipIt->second.isString()) pa.ip = ipIt->second.asString();
-                    if (auto pIt = d.find("port"); pIt!=d.end() && pIt->second.isInt()) pa.port = (std::uint16_t)pIt->second.asInt();
-                    resp.peers.push_back(std::move(pa));
+                    if (!item.isDict()) continue;
+                    const auto& d = item.asDict();
+                    std::uint16_t port = 0;
+                    if (auto pIt = d.find("port"); pIt!=d.end() && pIt->second.isInt()) port = (std::uint16_t)pIt->second.asInt();
+                    auto ipIt = d.find("ip");
+                    if (ipIt == d.end() || !ipIt->second.isString()) continue;
+                    if (auto ep = PeerEndpoint::parse(ipIt->second.asString(), port)) resp.peers.push_back(*ep);
                 }
             }
         }
 
         if (auto it = dict.find("peers6"); it!=dict.end() && it->second.isString()) {
-            const auto& s = it->second.asString(); auto v6 = CompactPeerCodec::parseIPv6(std::string_view(s));
-            resp.peers.insert(resp.peers.end(), v6.begin(), v6.end());
+            CompactPeerCodec::appendIPv6(std::string_view(it->second.asString()), resp.peers);
         }
 
         return Expected<AnnounceResponse>::success(std::move(resp));
     }
 
 
-    Expected<std::map<InfoHash, ScrapeStats>> HttpTracker::parseScrapeBody(const std::string& body) const 
+    Expected<std::size_t> HttpTracker::parseScrapeBodyInto(const std::string& body, std::map<InfoHash, ScrapeStats>& out) 
     {
         using namespace bencode;
 
-        BencodeValue root = BencodeParser::parse(std::string_view(body));
-        if (!root.isDict()) return Expected<std::map<InfoHash, ScrapeStats>>::failure("scrape body not a dict");
+        BencodeValue root;
+        try { root = BencodeParser::parse(std::string_view(body)); }
+        catch (const std::exception& e) { return Expected<std::size_t>::failure(std::string("scrape body: ") + e.what()); }
+        if (!root.isDict()) return Expected<std::size_t>::failure("scrape body not a dict");
 
         const auto& d = root.asDict();
-        auto filesIt = d.find("files");
+        if (auto it = d.find("failure reason"); it!=d.end() && it->second.isString()) {
+            return Expected<std::size_t>::failure(it->second.asString());
+        }
 
+        auto filesIt = d.find("files");
         if (filesIt == d.end() || !filesIt->second.isDict())
-            return Expected<std::map<InfoHash, ScrapeStats>>::failure("scrape has no files dict");
+            return Expected<std::size_t>::failure("scrape has no files dict");
 
-        std::map<InfoHash, ScrapeStats> out;
+        std::size_t added = 0;
         for (auto const& [k, v] : filesIt->second.asDict()) {
-            if (!v.isDict()) continue;
+            if (!v.isDict() || k.size() != 20) continue;
 
             ScrapeStats s{}; const auto& sd = v.asDict();
             if (auto it=sd.find("complete");   it!=sd.end() && it->second.isInt()) s.complete   = (std::uint32_t)it->second.asInt();
             if (auto it=sd.find("downloaded"); it!=sd.end() && it->second.isInt()) s.downloaded = (std::uint32_t)it->second.asInt();
             if (auto it=sd.find("incomplete"); it!=sd.end() && it->second.isInt()) s.incomplete = (std::uint32_t)it->second.asInt();
             if (auto it=sd.find("name");       it!=sd.end() && it->second.isString()) s.name = it->second.asString();
-            InfoHash ih{}; if (k.size()==20) std::memcpy(ih.bytes.data(), k.data(), 20); out.emplace(ih, s);
+            InfoHash ih{}; std::memcpy(ih.bytes.data(), k.data(), 20);
+            out.insert_or_assign(ih, std::move(s));
+            ++added;
         }
 
-        return Expected<std::map<InfoHash, ScrapeStats>>::success(std::move(out));
+        return Expected<std::size_t>::success(added);
+    }
+
+    std::vector<std::string> HttpTracker::buildScrapeUrls(const std::string& base, const std::vector<InfoHash>& hashes) const 
+    {
+        std::vector<std::string> urls;
+        if (hashes.empty()) {
+            urls.push_back(base);   // whole-tracker scrape
+            return urls;
+        }
+
+        const char first = base.find('?') == std::string::npos ? '?' : '&';
+        std::string encoded;
+        for (const auto& ih : hashes) {
+            encoded.clear();
+            appendPercentEncoded(encoded, std::string_view(reinterpret_cast<const char*>(ih.bytes.data()), ih.bytes.size()));
+
+            // "&info_hash=" + up to 60 encoded bytes; a lone hash always gets a URL of its own.
+            const std::size_t add = 11 + encoded.size();
+            if (urls.empty() || urls.back().size() + add > cfg_.maxScrapeUrlLength) {
+                urls.emplace_back();
+                urls.back().reserve(std::max(cfg_.maxScrapeUrlLength, base.size() + add));
+                urls.back() += base;
+                urls.back() += first;
+            } else {
+                urls.back() += '&';
+            }
+            urls.back() += "info_hash=";
+            urls.back() += encoded;
+        }
+        return urls;
     }
 
     Expected<AnnounceResponse> HttpTracker::announce(const AnnounceRequest& req, const std::string& announceUrl) 
@@ -145,12 +154,70 @@ namespace bittorrent::tracker {
         return parseAnnounceBody(resp.get().body);
     }
 
-    Expected<std::map<InfoHash, ScrapeStats>> HttpTracker::scrape(const std::vector<InfoHash>&, const std::string& scrapeUrl) 
+    Expected<std::map<InfoHash, ScrapeStats>> HttpTracker::scrape(const std::vector<InfoHash>& hashes, const std::string& scrapeUrl) 
+    {
+        std::promise<Expected<std::map<InfoHash, ScrapeStats>>> done;
+        auto result = done.get_future();
+        scrapeAsync(hashes, scrapeUrl, [&done](Expected<std::map<InfoHash, ScrapeStats>> r) { done.set_value(std::move(r)); });
+        return result.get();
+    }
+
+    HttpRequestHandle HttpTracker::announceAsync(const AnnounceRequest& req, const std::string& announceUrl, AnnounceCallback cb)
     {
-        auto resp = http_->get(scrapeUrl, cfg_.connectTimeoutSec, cfg_.transferTimeoutSec, cfg_.followRedirects);
+        auto url = buildAnnounceUrl(announceUrl, req);
+        return http_->getAsync(url, cfg_.connectTimeoutSec, cfg_.transferTimeoutSec, cfg_.followRedirects,
+            [cb = std::move(cb)](Expected<HttpResponse> resp) {
+                if (!resp.has_value()) cb(Expected<AnnounceResponse>::failure(resp.error->message));
+                else cb(parseAnnounceBody(resp.get().body));
+            });
+    }
+
+    HttpRequestHandle HttpTracker::scrapeAsync(const std::vector<InfoHash>& hashes, const std::string& scrapeUrl, ScrapeCallback cb)
+    {
+        // One request per URL-length chunk, all in flight at once; each reply is parsed straight
+        // into the shared map and cb runs after the last one.
+        struct Merge
+        {
+            std::mutex mu;
+            std::map<InfoHash, ScrapeStats> stats;
+            std::size_t remaining{0};
+            std::size_t succeeded{0};
+            std::string lastError;
+            ScrapeCallback cb;
+        };
+
+        auto urls = buildScrapeUrls(scrapeUrl, hashes);
+        auto merge = std::make_shared<Merge>();
+        merge->remaining = urls.size();
+        merge->cb = std::move(cb);
+
+        std::vector<HttpRequestHandle> handles;
+        handles.reserve(urls.size());
+        for (const auto& url : urls) {
+            handles.push_back(http_->getAsync(url, cfg_.connectTimeoutSec, cfg_.transferTimeoutSec, cfg_.followRedirects,
+                [merge](Expected<HttpResponse> resp) {
+                    std::unique_lock<std::mutex> lk(merge->mu);
+                    if (!resp.has_value()) {
+                        merge->lastError = resp.error->message;
+                    } else if (auto n = parseScrapeBodyInto(resp.get().body, merge->stats); !n.has_value()) {
+                        merge->lastError = n.error->message;
+                    } else {
+                        ++merge->succeeded;
+                    }
+                    if (--merge->remaining != 0) return;
+
+                    // Partial results are still results; only an all-round failure is an error.
+                    auto out = merge->succeeded > 0
+                        ? Expected<std::map<InfoHash, ScrapeStats>>::success(std::move(merge->stats))
+                        : Expected<std::map<InfoHash, ScrapeStats>>::failure(merge->lastError);
+                    auto fn = std::move(merge->cb);
+                    lk.unlock();
+                    fn(std::move(out));
+                }));
+        }
 
-        if (!resp.has_value()) return Expected<std::map<InfoHash, ScrapeStats>>::failure(resp.error->message);
-        return parseScrapeBody(resp.get().body);
+        if (handles.size() == 1) return handles.front();
+        return HttpRequestHandle([handles = std::move(handles)] { for (const auto& h : handles) h.cancel(); });
     }
 
 } // namespace bittorrent::tracker
\ No newline at end of file
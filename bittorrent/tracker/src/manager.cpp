@@ -1,10 +1,43 @@
+#include <algorithm>
 #include <chrono>
+#include <optional>
 #include <regex>
 #include "../include/manager.hpp"
 
 
 namespace bittorrent::tracker {
 
+  // One request in flight. Replies are handled under mu, so stop() can wait them out and then
+  // detach the flight; a late reply (UDP cannot be withdrawn) then finds no owner.
+  struct TrackerManager::Flight {
+    std::mutex mu;
+    TrackerManager* owner{nullptr};
+    std::function<void()> cancel;       // set once the request went out; HTTP only
+    bool cancelled{false}, replied{false};
+
+    std::size_t tier{0}, index{0};      // under the owner's stateMu_ from here on
+    bool abandoned{false};              // the tier's round ended without it
+
+    // Abandons the request; an HTTP reply then arrives at once as "http: cancelled".
+    void abandon(bool detach = false) {
+      std::function<void()> c;
+      {
+        std::scoped_lock lk(mu);
+        if (detach) owner = nullptr;
+        cancelled = true;
+        c = std::move(cancel);
+      }
+      if (c) c();
+    }
+  };
+
+  struct TrackerManager::Launch {
+    std::shared_ptr<Flight> flight;
+    std::string url;
+    Scheme scheme;
+    AnnounceRequest req;
+  };
+
   static Scheme detectScheme(const std::string& url) {
     if (url.rfind("udp://", 0) == 0) return Scheme::udp;
     if (url.rfind("https://", 0) == 0) return Scheme::https;
@@ -15,14 +48,34 @@ namespace bittorrent::tracker {
     return std::regex_replace(announceUrl, std::regex("/announce(?![^/])"), "/scrape");
   }
 
+  // BEP 48: the last path segment must start with "announce", which becomes "scrape"; query kept.
+  static std::optional<std::string> makeHttpScrapeUrl(const std::string& announceUrl) {
+    // The path starts at the first '/' after the authority; "http://host" has none.
+    const auto scheme = announceUrl.find("://");
+    const auto path = announceUrl.find('/', scheme == std::string::npos ? 0 : scheme + 3);
+    const auto query = announceUrl.find('?');
+    if (path == std::string::npos || path > query) return std::nullopt;
+    const auto slash = announceUrl.rfind('/', query);
+    if (announceUrl.compare(slash + 1, 8, "announce") != 0) return std::nullopt;
+    return announceUrl.substr(0, slash + 1) + "scrape" + announceUrl.substr(slash + 9);
+  }
+
   TrackerManager::TrackerManager(const std::vector<std::vector<std::string>>& announceList,
                                 InfoHash ih, PeerID pid, std::uint16_t port,
-                                std::shared_ptr<IHttpClient> httpClient)
-    : infoHash_(ih), peerId_(pid), port_(port) 
+                                std::shared_ptr<IHttpClient> httpClient,
+                                std::shared_ptr<TrackerScheduler> scheduler,
+                                TrackerManagerConfig cfg)
+    : infoHash_(ih), peerId_(pid), port_(port), cfg_(cfg), peerQueue_(cfg.peerQueueBatches),
+      sched_(scheduler ? std::move(scheduler) : TrackerScheduler::shared())
   {
-    if (!httpClient) httpClient = makeCurlClient();
+    const bool injected = httpClient != nullptr;
+    if (!httpClient) httpClient = makeCurlMultiClient();
     http_ = std::make_shared<HttpTracker>(std::move(httpClient));
-    udp_  = std::make_shared<UdpTracker>();
+    udp_  = std::make_shared<UdpTracker>(UdpTracker::sharedEngine());
+    scrapes_ = ScrapeAggregator::shared();
+    // An injected client gets its own aggregator; the default one batches with every other torrent.
+    httpScrapes_ = injected ? std::make_shared<ScrapeAggregator>(http_, UdpTracker::sharedEngine())
+                             : ScrapeAggregator::sharedHttp();
 
     tiers_.reserve(announceList.size());
     for (auto const& tierUrls : announceList) {
@@ -33,18 +86,36 @@ namespace bittorrent::tracker {
       }
       tiers_.push_back(std::move(tier));
     }
+    rounds_.resize(tiers_.size());
   }
 
   TrackerManager::~TrackerManager() { stop(); }
 
   void TrackerManager::start() {
+    // Held until task_ is set: the first pass may run at once, and its replies wake task_.
+    std::scoped_lock lk(stateMu_);
     if (running_.exchange(true)) return;
-    worker_ = std::thread([this]{ workerLoop(); });
+    task_ = sched_->add([this](TrackerScheduler::Clock::time_point now) { return runPass(now); });
   }
 
   void TrackerManager::stop() {
-    if (!running_.exchange(false)) return;
-    if (worker_.joinable()) worker_.join();
+    std::list<std::shared_ptr<Flight>> flights;
+    {
+      std::scoped_lock lk(stateMu_);
+      if (!running_.exchange(false)) return;
+      flights.swap(flights_);
+      for (auto& r : rounds_) { r.inFlight = 0; r.pending.reset(); }
+      queued_.clear();
+    }
+    {
+      // A reply handler may still be failing over, queueing peers or waking the task.
+      std::unique_lock lk(stateMu_);
+      handlersIdle_.wait(lk, [&] { return handlers_ == 0; });
+    }
+    sched_->remove(task_);
+    task_ = 0;
+    // A slow tracker would otherwise hold its flight until timeout; late replies find no owner.
+    for (auto& f : flights) f->abandon(/*detach*/true);
   }
 
   void TrackerManager::onStats(std::uint64_t up, std::uint64_t down, std::uint64_t left) {
@@ -55,99 +126,256 @@ namespace bittorrent::tracker {
     AnnounceRequest r; r.infoHash = infoHash_; r.peerId = peerId_; r.port = port_; r.event = ev; r.numwant = numwant; r.compact = true; r.no_peer_id = true; return r;
   }
 
-  ITrackerClient& TrackerManager::clientFor(const TrackerEndpoint& ep) {
-    switch (ep.scheme) { case Scheme::udp: return *udp_; case Scheme::https: [[fallthrough]]; case Scheme::http: return *http_; }
-    return *http_;
+  // Any thread; never blocks. Only the push that finds the consumer idle signals it.
+  bool TrackerManager::queuePeers(std::vector<PeerEndpoint>&& peers, PeerSource source) {
+    const auto r = peerQueue_.tryPush(PeerBatch{source, std::move(peers)});
+    if (r == PeerBatchQueue::PushResult::wakeConsumer && peersReady_) peersReady_();
+    return r != PeerBatchQueue::PushResult::full;
   }
 
-  void TrackerManager::deliverPeers(const std::vector<PeerAddr>& peers) {
-    if (peersCb_) { peersCb_(peers); }
+  // Fallback mode announces to a tier only while every tier before it is failing or dead.
+  bool TrackerManager::eligible(std::size_t tier) const {
+    if (cfg_.allTiers) return true;
+    for (std::size_t t = 0; t < tier; ++t) {
+      if (rounds_[t].inFlight > 0) return false;
+      const auto& eps = tiers_[t].endpoints;
+      const bool live = std::any_of(eps.begin(), eps.end(), [](auto const& ep) { return !ep.disabled; });
+      if (live && !rounds_[t].failed) return false;
+    }
+    return true;
   }
 
-  void TrackerManager::tryOneTier(TrackerTier& tier, AnnounceEvent ev, std::uint32_t numwant) {
-    auto now = std::chrono::steady_clock::now();
-    const auto startIdx = tier.currentIndex;
+  // When the tier's next periodic round may start: after the last winner's interval, once one
+  // of its trackers is out of backoff. Never-announced trackers are due at once.
+  TrackerScheduler::Clock::time_point TrackerManager::dueAt(std::size_t tier) const {
+    auto earliest = TrackerScheduler::Clock::time_point::max();
+    for (auto const& ep : tiers_[tier].endpoints) {
+      if (!ep.disabled) earliest = std::min(earliest, ep.nextAllowed);
+    }
+    if (earliest == TrackerScheduler::Clock::time_point::max()) return earliest;
+    return std::max(earliest, rounds_[tier].nextAnnounce);
+  }
 
-    for (std::size_t tries = 0; tries < tier.endpoints.size(); ++tries) {
-      auto& ep = tier.current();
-      if (!ep.canAnnounceNow(now)) { tier.rotate(); continue; }
+  void TrackerManager::startRound(std::size_t tier, TrackerScheduler::Clock::time_point now, std::vector<Launch>& out) {
+    Round& r = rounds_[tier];
+    r.tried.assign(tiers_[tier].endpoints.size(), false);
+    r.forced = r.pending.has_value();
+    r.event = r.forced ? r.pending->event : AnnounceEvent::none;
+    r.numwant = r.forced ? r.pending->numwant : 50;
+    r.pending.reset();
+    if (r.event == AnnounceEvent::none) r.event = unacked_;
+
+    fill(tier, now, out);
+    if (r.inFlight == 0) r.failed = true;
+  }
+
+  // Sends to the tier's next untried endpoints, in tier order, up to the race cap.
+  void TrackerManager::fill(std::size_t tier, TrackerScheduler::Clock::time_point now, std::vector<Launch>& out) {
+    Round& r = rounds_[tier];
+    auto& eps = tiers_[tier].endpoints;
+    const std::size_t cap = std::max<std::size_t>(cfg_.racePerTier, 1);
+
+    for (std::size_t i = 0; i < eps.size() && r.inFlight < cap; ++i) {
+      auto& ep = eps[i];
+      if (r.tried[i] || (r.forced ? ep.disabled : !ep.canAnnounceNow(now))) continue;
+      r.tried[i] = true;
+      ++r.inFlight;
+
+      auto f = std::make_shared<Flight>();
+      f->owner = this; f->tier = tier; f->index = i;
+      flights_.push_back(f);
 
       AnnounceRequest req;
       {
         std::scoped_lock lk(statsMu_);
-        req = makeReq(ev, numwant);
+        req = makeReq(r.event, r.numwant);
         req.uploaded = uploaded_; req.downloaded = downloaded_; req.left = left_;
         if (ep.trackerId) req.trackerId = ep.trackerId;
       }
+      out.push_back({std::move(f), ep.url, ep.scheme, std::move(req)});
+    }
+  }
+
+  // Outside stateMu_: either transport may run the reply inline.
+  void TrackerManager::launch(std::vector<Launch>& launches) {
+    for (auto& l : launches) {
+      auto f = l.flight;
+      {
+        std::scoped_lock lk(f->mu);
+        if (f->cancelled) continue;     // abandoned before it went out
+      }
+      auto done = [f](Expected<AnnounceResponse> r) { onReply(f, std::move(r)); };
+      std::function<void()> cancel;
+      if (l.scheme == Scheme::udp) {
+        // The engine cannot withdraw a request; abandoning it just drops the late reply.
+        udp_->engine().announce(l.req, l.url, std::move(done));
+      } else {
+        auto handle = http_->announceAsync(l.req, l.url, std::move(done));
+        cancel = [handle] { handle.cancel(); };
+      }
+
+      bool late = false;
+      {
+        std::scoped_lock lk(f->mu);
+        late = f->cancelled && !f->replied;
+        if (!f->cancelled && !f->replied) f->cancel = std::move(cancel);
+      }
+      if (late && cancel) cancel();     // abandoned while it was being sent
+    }
+  }
+
+  void TrackerManager::onReply(const std::shared_ptr<Flight>& f, Expected<AnnounceResponse> res) {
+    std::scoped_lock lk(f->mu);
+    f->replied = true;
+    f->cancel = nullptr;
+    if (f->owner) f->owner->handleReply(*f, std::move(res));
+  }
+
+  // The first answer in a tier wins its round: the rest of the tier is abandoned and the winner
+  // moves to the front (BEP 12). A failure hands the slot to the tier's next endpoint.
+  void TrackerManager::handleReply(Flight& f, Expected<AnnounceResponse> res) {
+    std::vector<std::shared_ptr<Flight>> losers;
+    std::vector<Launch> launches;
+    std::vector<PeerEndpoint> peers;
+    {
+      std::scoped_lock lk(stateMu_);
+      if (!running_ || f.abandoned) {
+        flights_.remove_if([&](auto const& p) { return p.get() == &f; });
+        return;
+      }
+      ++handlers_;
+      Round& r = rounds_[f.tier];
+      TrackerTier& tier = tiers_[f.tier];
+      auto& ep = tier.endpoints[f.index];
+      --r.inFlight;
 
-      auto& client = clientFor(ep);
-      auto res = client.announce(req, ep.url);
       if (res.has_value()) {
         auto& a = res.get();
         ep.recordSuccess(a.minInterval.value_or(a.interval), a.minInterval);
         if (a.trackerId) ep.trackerId = a.trackerId;
-        if (!a.peers.empty()) {
-          {
-            std::scoped_lock lk(peersMu_);
-            for (auto& p : a.peers) pendingPeers_.push_back(p);
-          }
+        if (r.event == unacked_) unacked_ = AnnounceEvent::none;
+        r.failed = false;
+        r.nextAnnounce = ep.nextAllowed;
 
-          deliverPeers(a.peers);
+        for (auto& other : flights_) {
+          if (other.get() == &f || other->tier != f.tier || other->abandoned) continue;
+          other->abandoned = true;
+          losers.push_back(other);
         }
-        return; // success, stop trying endpoints in this tier
+        r.inFlight = 0;
+        tier.promote(f.index);
+
+        peers = std::move(a.peers);
       } else {
         ep.recordFailure();
-        tier.rotate();
+        fill(f.tier, TrackerScheduler::Clock::now(), launches);
+        if (r.inFlight == 0) r.failed = true;
       }
-
-      if (tier.currentIndex == startIdx) break; // full loop
+      flights_.remove_if([&](auto const& p) { return p.get() == &f; });
     }
-  }
 
-  void TrackerManager::workerLoop() {
-    using namespace std::chrono_literals;
+    for (auto& l : losers) l->abandon();
+    launch(launches);
+    // A full queue drops the batch rather than holding it for a later push: the consumer is
+    // behind, droppedPeerBatches() counts it, and the tracker's next reply reports these peers again.
+    if (!peers.empty()) (void)queuePeers(std::move(peers), PeerSource::tracker);
+    // A finished round may make another tier eligible or let a queued announce through.
+    sched_->wake(task_);
 
-    while (running_) {
-      auto now = std::chrono::steady_clock::now();
-      bool didWork = false;
+    std::scoped_lock lk(stateMu_);
+    if (--handlers_ == 0) handlersIdle_.notify_all();
+  }
 
-      for (auto& tier : tiers_) {
-        if (!running_) break;
-        if (tier.anyAvailable(now)) { tryOneTier(tier, AnnounceEvent::none, 50); didWork = true; break; }
-      }
+  // One scheduled pass: hands the next queued announce to the tiers, starts every round that
+  // is due and idle, and sends its first requests. Replies are handled as they arrive; a
+  // finished round wakes the task again.
+  TrackerScheduler::Clock::time_point TrackerManager::runPass(TrackerScheduler::Clock::time_point now) {
+    using TimePoint = TrackerScheduler::Clock::time_point;
+    std::vector<Launch> launches;
+    auto next = TimePoint::max();
+    bool more = false;
+    {
+      std::scoped_lock lk(stateMu_);
+      if (!running_) return TimePoint::max();
 
-      if (!running_) break;
+      // One queued announce at a time; the next waits until every tier has taken this one.
+      auto waiting = [&] { return std::any_of(rounds_.begin(), rounds_.end(), [](auto const& r) { return r.pending.has_value(); }); };
+      if (!queued_.empty() && !waiting()) {
+        const QueuedAnnounce q = queued_.front();
+        queued_.erase(queued_.begin());
+        if (q.event == AnnounceEvent::started || q.event == AnnounceEvent::completed) unacked_ = q.event;
+        for (std::size_t t = 0; t < tiers_.size(); ++t) {
+          const auto& eps = tiers_[t].endpoints;
+          if (std::none_of(eps.begin(), eps.end(), [](auto const& ep) { return !ep.disabled; })) continue;
+          rounds_[t].pending = q;
+          if (!cfg_.allTiers) break;
+        }
+      }
 
-      std::chrono::steady_clock::time_point earliest = now + 5s; bool haveEarliest=false;
-      for (auto& tier : tiers_) {
-        for (auto& ep : tier.endpoints) {
-          if (ep.disabled) continue;
-          if (ep.nextAllowed.time_since_epoch().count() == 0) { earliest = now + 1s; haveEarliest=true; continue; }
-          if (!haveEarliest || ep.nextAllowed < earliest) { earliest = ep.nextAllowed; haveEarliest = true; }
+      for (std::size_t t = 0; t < tiers_.size(); ++t) {
+        Round& r = rounds_[t];
+        if (r.inFlight > 0 || !eligible(t)) continue;
+        if (!r.pending) {
+          const auto due = dueAt(t);
+          if (due > now) { next = std::min(next, due); continue; }
         }
+        startRound(t, now, launches);
       }
+      more = !queued_.empty() && !waiting();
+    }
 
-      using namespace std::chrono;
+    launch(launches);
+    return more ? TrackerScheduler::Clock::now() : next;
+  }
 
-      auto sleepDur = 1s;
-      if (haveEarliest) {
-        auto now = steady_clock::now();
-        auto delta = earliest - now; // steady_clock::duration
-        sleepDur = (delta > 0ns) ? duration_cast<seconds>(delta) : 1s;
-      }
+  std::vector<PeerEndpoint> TrackerManager::drainNewPeers() {
+    const auto now = std::chrono::steady_clock::now();
+    PeerBatch batch;
+    do {
+      while (peerQueue_.tryPop(batch)) peerPool_.add(batch.peers, batch.source, now);
+    } while (!peerQueue_.park());
+    return peerPool_.drainNew();
+  }
 
-      std::this_thread::sleep_for(sleepDur); 
-    }
+  bool TrackerManager::addPeers(std::vector<PeerEndpoint> peers, PeerSource source) {
+    if (peers.empty()) return true;
+    return queuePeers(std::move(peers), source);
   }
 
-  std::vector<PeerAddr> TrackerManager::drainNewPeers() {
-    std::scoped_lock lk(peersMu_); std::vector<PeerAddr> out; out.swap(pendingPeers_); return out;
+  void TrackerManager::reportConnectResult(const PeerEndpoint& peer, bool connected) {
+    if (connected) peerPool_.recordSuccess(peer); else peerPool_.recordFailure(peer);
   }
 
   void TrackerManager::announce(AnnounceEvent ev, std::uint32_t numwant) {
-    for (auto& tier : tiers_) { if (tier.anyAvailable(std::chrono::steady_clock::now())) { tryOneTier(tier, ev, numwant); return; } }
+    {
+      std::scoped_lock lk(stateMu_);
+      queued_.push_back({ev, numwant});
+    }
+    if (running_) sched_->wake(task_);
   }
 
-  void TrackerManager::setPeersCallback(PeersCallback cb) { peersCb_ = std::move(cb); }
+  void TrackerManager::setPeersReadyCallback(PeersReadyCallback cb) { peersReady_ = std::move(cb); }
+
+  void TrackerManager::scrape(ScrapeCallback cb) {
+    auto shared = std::make_shared<ScrapeCallback>(std::move(cb));
+    std::vector<TrackerTier> tiers;
+    {
+      std::scoped_lock lk(stateMu_);
+      tiers = tiers_;
+    }
+    for (auto const& tier : tiers) {
+      for (auto const& ep : tier.endpoints) {
+        if (ep.disabled) continue;
+        if (ep.scheme == Scheme::udp) {
+          const std::string url = makeScrapeUrl(ep.url);
+          scrapes_->request(url, infoHash_, [shared, url](Expected<ScrapeStats> r) { (*shared)(url, r); });
+          continue;
+        }
+        auto url = makeHttpScrapeUrl(ep.url);
+        if (!url) continue;
+        httpScrapes_->request(*url, infoHash_, [shared, u = *url](Expected<ScrapeStats> r) { (*shared)(u, r); });
+      }
+    }
+  }
 
 } // namespace bittorrent::tracker
@@ -0,0 +1,34 @@
+#include "packet_pool.hpp"
+
+
+namespace bittorrent::tracker {
+
+    PacketPool::PacketPool(std::size_t perSlab) : perSlab_(perSlab == 0 ? 1 : perSlab)
+    {
+        grow();
+    }
+
+    void PacketPool::grow()
+    {
+        slabs_.push_back(std::make_unique<PacketBuffer[]>(perSlab_));
+        PacketBuffer* slab = slabs_.back().get();
+
+        free_.reserve(capacity());  // release() never reallocates
+        for (std::size_t i = perSlab_; i-- > 0;) free_.push_back(&slab[i]);
+    }
+
+    PacketBuffer* PacketPool::acquire()
+    {
+        if (free_.empty()) grow();
+        PacketBuffer* buf = free_.back();
+        free_.pop_back();
+        buf->len = 0;
+        return buf;
+    }
+
+    void PacketPool::release(PacketBuffer* buf) noexcept
+    {
+        if (buf) free_.push_back(buf);
+    }
+
+} // namespace bittorrent::tracker
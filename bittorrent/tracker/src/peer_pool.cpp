@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <functional>
+#include "../include/peer_pool.hpp"
+
+
+namespace bittorrent::tracker {
+
+    PeerPool::PeerPool(std::size_t maxPeers)
+        : maxPeers_(std::max<std::size_t>(maxPeers, 1))
+    {
+        maxSlots_ = kInitialSlots;
+        while (maxSlots_ < 2 * maxPeers_) maxSlots_ <<= 1;
+        slots_.resize(kInitialSlots);
+        mask_ = kInitialSlots - 1;
+    }
+
+    void PeerPool::grow()
+    {
+        std::vector<Entry> old = std::move(slots_);
+        slots_.assign(old.size() * 2, Entry{});
+        mask_ = slots_.size() - 1;
+        for (auto& e : old) {
+            if (e.endpoint.family == 0) continue;
+            std::size_t i = home(e.endpoint);
+            while (slots_[i].endpoint.family != 0) i = (i + 1) & mask_;
+            slots_[i] = e;
+        }
+    }
+
+    std::size_t PeerPool::home(const PeerEndpoint& ep) const
+    {
+        return std::hash<PeerEndpoint>{}(ep) & mask_;
+    }
+
+    std::size_t PeerPool::findSlot(const PeerEndpoint& ep) const
+    {
+        for (std::size_t i = home(ep);; i = (i + 1) & mask_) {
+            const auto& s = slots_[i];
+            if (s.endpoint.family == 0) return slots_.size();
+            if (s.endpoint == ep) return i;
+        }
+    }
+
+    // Local peers first, then trackers, PEX and DHT; corroboration by another source helps,
+    // every failed connect costs more than any of that.
+    std::int32_t PeerPool::scoreOf(const Entry& e)
+    {
+        static constexpr std::int32_t kBase[] = {200, 150, 100, 300};   // tracker, pex, dht, lsd
+        std::int32_t s = kBase[static_cast<int>(e.source)];
+        for (std::uint8_t m = e.sources; m; m &= static_cast<std::uint8_t>(m - 1)) s += 50;
+        return s - 50 - 120 * static_cast<std::int32_t>(e.failures);
+    }
+
+    bool PeerPool::add(const PeerEndpoint& ep, PeerSource src, Clock::time_point now)
+    {
+        if (ep.family == 0) return false;
+        const auto bit = static_cast<std::uint8_t>(1u << static_cast<int>(src));
+
+        if (auto i = findSlot(ep); i != slots_.size()) {
+            auto& e = slots_[i];
+            if (!(e.sources & bit)) {
+                e.sources |= bit;
+                e.score = scoreOf(e);
+            }
+            return false;
+        }
+
+        if (size_ >= maxPeers_) evictOne();
+        else if (2 * (size_ + 1) > slots_.size() && slots_.size() < maxSlots_) grow();
+
+        std::size_t i = home(ep);
+        while (slots_[i].endpoint.family != 0) i = (i + 1) & mask_;
+        auto& e = slots_[i];
+        e = Entry{};
+        e.endpoint = ep;
+        e.source = src;
+        e.sources = bit;
+        e.firstSeen = now;
+        e.score = scoreOf(e);
+        ++size_;
+        ++undrained_;
+        return true;
+    }
+
+    std::size_t PeerPool::add(const std::vector<PeerEndpoint>& eps, PeerSource src,
+                              Clock::time_point now, std::vector<PeerEndpoint>* fresh)
+    {
+        std::size_t added = 0;
+        for (const auto& ep : eps) {
+            if (!add(ep, src, now)) continue;
+            ++added;
+            if (fresh) fresh->push_back(ep);
+        }
+        return added;
+    }
+
+    void PeerPool::recordFailure(const PeerEndpoint& ep)
+    {
+        auto i = findSlot(ep);
+        if (i == slots_.size()) return;
+        auto& e = slots_[i];
+        if (e.failures < std::numeric_limits<std::uint16_t>::max()) ++e.failures;
+        e.score = scoreOf(e);
+    }
+
+    void PeerPool::recordSuccess(const PeerEndpoint& ep)
+    {
+        auto i = findSlot(ep);
+        if (i == slots_.size()) return;
+        slots_[i].failures = 0;
+        slots_[i].score = scoreOf(slots_[i]);
+    }
+
+    std::vector<PeerEndpoint> PeerPool::drainNew(std::size_t max)
+    {
+        std::vector<Entry*> pending;
+        if (undrained_ == 0 || max == 0) return {};
+        pending.reserve(undrained_);
+        for (auto& s : slots_) {
+            if (s.endpoint.family != 0 && !s.drained) pending.push_back(&s);
+        }
+
+        auto better = [](const Entry* a, const Entry* b) {
+            if (a->score != b->score) return a->score > b->score;
+            return a->firstSeen < b->firstSeen;
+        };
+        const std::size_t n = std::min(max, pending.size());
+        if (n < pending.size()) {
+            std::partial_sort(pending.begin(), pending.begin() + n, pending.end(), better);
+        } else {
+            std::sort(pending.begin(), pending.end(), better);
+        }
+
+        std::vector<PeerEndpoint> out;
+        out.reserve(n);
+        for (std::size_t k = 0; k < n; ++k) {
+            pending[k]->drained = true;
+            out.push_back(pending[k]->endpoint);
+        }
+        undrained_ -= n;
+        return out;
+    }
+
+    const PeerPool::Entry* PeerPool::find(const PeerEndpoint& ep) const
+    {
+        auto i = findSlot(ep);
+        return i == slots_.size() ? nullptr : &slots_[i];
+    }
+
+    bool PeerPool::erase(const PeerEndpoint& ep)
+    {
+        auto i = findSlot(ep);
+        if (i == slots_.size()) return false;
+        eraseAt(i);
+        return true;
+    }
+
+    // Backward-shift deletion: pull later members of the probe run into the hole unless
+    // their home slot lies cyclically in (hole, j], where they are already reachable.
+    void PeerPool::eraseAt(std::size_t hole)
+    {
+        --size_;
+        if (!slots_[hole].drained) --undrained_;
+
+        for (std::size_t j = (hole + 1) & mask_; slots_[j].endpoint.family != 0; j = (j + 1) & mask_) {
+            const std::size_t h = home(slots_[j].endpoint);
+            const bool stays = hole <= j ? (h > hole && h <= j) : (h > hole || h <= j);
+            if (stays) continue;
+            slots_[hole] = slots_[j];
+            hole = j;
+        }
+        slots_[hole] = Entry{};
+    }
+
+    // Worst of the next kEvictSample residents after the cursor: already handed out before
+    // still pending, then lowest score, then oldest. O(1) per insert instead of a full scan.
+    void PeerPool::evictOne()
+    {
+        auto worse = [](const Entry& a, const Entry& b) {
+            if (a.drained != b.drained) return a.drained;
+            if (a.score != b.score) return a.score < b.score;
+            return a.firstSeen < b.firstSeen;
+        };
+
+        std::size_t victim = slots_.size();
+        std::size_t seen = 0;
+        std::size_t i = evictCursor_ & mask_;
+        for (std::size_t walked = 0; walked < slots_.size() && seen < kEvictSample; ++walked, i = (i + 1) & mask_) {
+            if (slots_[i].endpoint.family == 0) continue;
+            ++seen;
+            if (victim == slots_.size() || worse(slots_[i], slots_[victim])) victim = i;
+        }
+        evictCursor_ = i;
+        if (victim == slots_.size()) return;
+
+        eraseAt(victim);
+        ++evictions_;
+    }
+
+} // namespace bittorrent::tracker
@@ -0,0 +1,97 @@
+#include <bit>
+#include "../include/peer_queue.hpp"
+
+
+namespace bittorrent::tracker {
+
+    PeerBatchQueue::PeerBatchQueue(std::size_t capacity)
+        : mask_(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity) - 1)
+    {
+    }
+
+    PeerBatchQueue::~PeerBatchQueue()
+    {
+        delete[] cells_.load(std::memory_order_acquire);
+    }
+
+    PeerBatchQueue::Cell* PeerBatchQueue::ring()
+    {
+        Cell* cells = cells_.load(std::memory_order_acquire);
+        if (cells) return cells;
+
+        Cell* fresh = new Cell[mask_ + 1];
+        for (std::size_t i = 0; i <= mask_; ++i) fresh[i].seq.store(i, std::memory_order_relaxed);
+        if (cells_.compare_exchange_strong(cells, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return fresh;
+        }
+        delete[] fresh;
+        return cells;
+    }
+
+    PeerBatchQueue::PushResult PeerBatchQueue::tryPush(PeerBatch&& batch)
+    {
+        Cell* const cells = ring();
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask_];
+            const std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                // The consumer has not freed this cell from the previous lap.
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+                return PushResult::full;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->batch = std::move(batch);
+        cell->seq.store(pos + 1, std::memory_order_release);
+
+        // Pairs with the fence in park(): either the consumer sees this batch or we see it parked.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked_.load(std::memory_order_relaxed) && parked_.exchange(false, std::memory_order_acq_rel)) {
+            return PushResult::wakeConsumer;
+        }
+        return PushResult::queued;
+    }
+
+    bool PeerBatchQueue::tryPop(PeerBatch& out)
+    {
+        Cell* const cells = cells_.load(std::memory_order_acquire);
+        if (!cells) return false;                  // nothing was ever pushed
+        const std::size_t pos = head_.load(std::memory_order_relaxed);
+        Cell& cell = cells[pos & mask_];
+        if (cell.seq.load(std::memory_order_acquire) != pos + 1) return false;
+
+        out = std::move(cell.batch);
+        cell.batch.peers.clear();
+        cell.seq.store(pos + mask_ + 1, std::memory_order_release);     // free for the next lap
+        head_.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool PeerBatchQueue::park()
+    {
+        parked_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        Cell* const cells = cells_.load(std::memory_order_acquire);
+        if (!cells) return true;                   // the first push allocates the ring and sees the flag
+        const std::size_t pos = head_.load(std::memory_order_relaxed);
+        if (cells[pos & mask_].seq.load(std::memory_order_acquire) != pos + 1) return true;
+        // A batch slipped in before we parked. Take the flag back unless its producer already
+        // did (it then reports wakeConsumer, and the consumer is woken anyway).
+        return !parked_.exchange(false, std::memory_order_acq_rel);
+    }
+
+    std::size_t PeerBatchQueue::size() const noexcept
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+} // namespace bittorrent::tracker
@@ -0,0 +1,229 @@
+#include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "scrape_aggregator.hpp"
+#include "udp_tracker.hpp"
+#include "udp_url.hpp"
+#include "udp_wire.hpp"
+
+
+namespace bittorrent::tracker {
+
+    // What differs between UDP and HTTP batching.
+    struct ScrapeAggregator::Transport
+    {
+        using Done = std::function<void(Expected<std::map<InfoHash, ScrapeStats>>)>;
+
+        std::shared_ptr<UdpTrackerEngine> engine;   // flush timers for both; the wire for UDP
+
+        explicit Transport(std::shared_ptr<UdpTrackerEngine> e) : engine(std::move(e)) {}
+        virtual ~Transport() = default;
+
+        virtual std::optional<std::string> batchKey(const std::string& scrapeUrl) const = 0;
+        virtual std::size_t maxHashes() const = 0;
+        virtual void scrape(const std::vector<InfoHash>& hashes, const std::string& url, Done done) = 0;
+        virtual std::string invalidUrlError() const = 0;
+    };
+
+    struct ScrapeAggregator::UdpTransport : Transport
+    {
+        using Transport::Transport;
+
+        std::optional<std::string> batchKey(const std::string& scrapeUrl) const override {
+            auto parts = detail::parse_udp_url_minimal(scrapeUrl);
+            if (!parts.has_value()) return std::nullopt;
+            return parts->host + ":" + std::to_string(parts->port);
+        }
+        std::size_t maxHashes() const override { return wire::kMaxScrapeHashes; }
+        void scrape(const std::vector<InfoHash>& hashes, const std::string& url, Done done) override {
+            engine->scrape(hashes, url, std::move(done));
+        }
+        std::string invalidUrlError() const override { return "udp: invalid URL (expect udp://host[:port]/...)"; }
+    };
+
+    struct ScrapeAggregator::HttpTransport : Transport
+    {
+        std::shared_ptr<HttpTracker> http;
+
+        HttpTransport(std::shared_ptr<HttpTracker> h, std::shared_ptr<UdpTrackerEngine> e)
+            : Transport(std::move(e)), http(std::move(h)) {}
+
+        std::optional<std::string> batchKey(const std::string& scrapeUrl) const override {
+            if (scrapeUrl.rfind("http://", 0) != 0 && scrapeUrl.rfind("https://", 0) != 0) return std::nullopt;
+            return scrapeUrl;
+        }
+        std::size_t maxHashes() const override { return std::numeric_limits<std::size_t>::max(); }
+        void scrape(const std::vector<InfoHash>& hashes, const std::string& url, Done done) override {
+            http->scrapeAsync(hashes, url, std::move(done));
+        }
+        std::string invalidUrlError() const override { return "http: invalid scrape URL"; }
+    };
+
+
+    struct ScrapeAggregator::State
+    {
+        struct Batch
+        {
+            std::string url;                                    // first requester's URL (UDP: path is irrelevant)
+            std::vector<InfoHash> order;                        // distinct hashes in arrival order
+            std::map<InfoHash, std::vector<Callback>> waiters;
+            uint64_t generation{0};
+        };
+
+        std::unique_ptr<Transport> transport;
+        ScrapeAggregatorConfig cfg;
+
+        mutable std::mutex mu;
+        std::unordered_map<std::string, Batch> pending;         // "host:port" -> open batch
+        uint64_t nextGeneration{1};
+        Stats stats{};
+
+        void dispatch(Batch batch);
+        void flushKey(const std::string& key, uint64_t generation);
+    };
+
+
+    void ScrapeAggregator::State::dispatch(Batch batch)
+    {
+        {
+            std::lock_guard<std::mutex> lk(mu);
+            ++stats.packets;
+            stats.hashes += batch.order.size();
+        }
+
+        auto waiters = std::make_shared<std::map<InfoHash, std::vector<Callback>>>(std::move(batch.waiters));
+        transport->scrape(batch.order, batch.url, [waiters](Expected<std::map<InfoHash, ScrapeStats>> r) {
+            for (auto& [ih, cbs] : *waiters) {
+                Expected<ScrapeStats> one;
+                if (!r.has_value()) {
+                    one = Expected<ScrapeStats>::failure(r.error.has_value() ? r.error->message : "scrape failed");
+                } else if (auto it = r.get().find(ih); it != r.get().end()) {
+                    one = Expected<ScrapeStats>::success(it->second);
+                } else {
+                    one = Expected<ScrapeStats>::failure("scrape: no stats for info-hash");
+                }
+                for (auto& cb : cbs) cb(one);
+            }
+        });
+    }
+
+    void ScrapeAggregator::State::flushKey(const std::string& key, uint64_t generation)
+    {
+        Batch batch;
+        {
+            std::lock_guard<std::mutex> lk(mu);
+            auto it = pending.find(key);
+            if (it == pending.end() || it->second.generation != generation) return; // already sent
+            batch = std::move(it->second);
+            pending.erase(it);
+        }
+        dispatch(std::move(batch));
+    }
+
+
+    ScrapeAggregator::ScrapeAggregator(std::shared_ptr<UdpTrackerEngine> engine, ScrapeAggregatorConfig cfg)
+        : state_(std::make_shared<State>())
+    {
+        state_->transport = std::make_unique<UdpTransport>(std::move(engine));
+        state_->cfg = cfg;
+        const std::size_t cap = state_->transport->maxHashes();
+        if (state_->cfg.maxHashesPerPacket == 0 || state_->cfg.maxHashesPerPacket > cap) {
+            state_->cfg.maxHashesPerPacket = cap;
+        }
+    }
+
+    ScrapeAggregator::ScrapeAggregator(std::shared_ptr<HttpTracker> http, std::shared_ptr<UdpTrackerEngine> timers,
+                                       ScrapeAggregatorConfig cfg)
+        : state_(std::make_shared<State>())
+    {
+        state_->transport = std::make_unique<HttpTransport>(std::move(http), std::move(timers));
+        state_->cfg = cfg;
+        if (state_->cfg.maxHashesPerPacket == 0) state_->cfg.maxHashesPerPacket = 1;
+    }
+
+    ScrapeAggregator::~ScrapeAggregator()
+    {
+        flush();
+    }
+
+    std::shared_ptr<ScrapeAggregator> ScrapeAggregator::shared()
+    {
+        static const auto instance = std::make_shared<ScrapeAggregator>(UdpTracker::sharedEngine());
+        return instance;
+    }
+
+    std::shared_ptr<ScrapeAggregator> ScrapeAggregator::sharedHttp()
+    {
+        static const auto instance = std::make_shared<ScrapeAggregator>(
+            std::make_shared<HttpTracker>(makeCurlMultiClient()), UdpTracker::sharedEngine());
+        return instance;
+    }
+
+    void ScrapeAggregator::request(const std::string& scrapeUrl, const InfoHash& ih, Callback cb)
+    {
+        State& st = *state_;
+        auto parsed = st.transport->batchKey(scrapeUrl);
+        if (!parsed) {
+            cb(Expected<ScrapeStats>::failure(st.transport->invalidUrlError()));
+            return;
+        }
+        const std::string key = std::move(*parsed);
+
+        std::optional<State::Batch> full;
+        uint64_t openedGeneration = 0;
+        {
+            std::lock_guard<std::mutex> lk(st.mu);
+            ++st.stats.requests;
+
+            auto [it, opened] = st.pending.try_emplace(key);
+            State::Batch& b = it->second;
+            if (opened) {
+                b.url = scrapeUrl;
+                b.generation = st.nextGeneration++;
+                openedGeneration = b.generation;
+            }
+
+            auto& cbs = b.waiters[ih];
+            if (cbs.empty()) b.order.push_back(ih);
+            cbs.push_back(std::move(cb));
+
+            if (b.order.size() >= st.cfg.maxHashesPerPacket) {
+                full = std::move(b);
+                st.pending.erase(it);
+            }
+        }
+
+        if (full) {
+            st.dispatch(std::move(*full));
+            return;
+        }
+        if (openedGeneration != 0) {
+            auto self = state_;
+            const bool armed = st.transport->engine->post(st.cfg.flushDelay, [self, key, openedGeneration] {
+                self->flushKey(key, openedGeneration);
+            });
+            if (!armed) st.flushKey(key, openedGeneration);   // engine down: fail fast rather than hold
+        }
+    }
+
+    void ScrapeAggregator::flush()
+    {
+        std::unordered_map<std::string, State::Batch> all;
+        {
+            std::lock_guard<std::mutex> lk(state_->mu);
+            all.swap(state_->pending);
+        }
+        for (auto& [key, batch] : all) state_->dispatch(std::move(batch));
+    }
+
+    ScrapeAggregator::Stats ScrapeAggregator::stats() const
+    {
+        std::lock_guard<std::mutex> lk(state_->mu);
+        return state_->stats;
+    }
+
+} // namespace bittorrent::tracker
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include "timer_wheel.hpp"
+
+
+namespace bittorrent::tracker {
+
+    TimerWheel::TimerWheel(std::chrono::milliseconds tick, Clock::time_point origin)
+        : tick_(tick.count() > 0 ? Clock::duration(tick) : Clock::duration(std::chrono::milliseconds{1})),
+          origin_(origin)
+    {
+        // Slot buffers only ever trade places (see visiting_), so a floor set here holds for
+        // good: a slot the wheel reaches for the first time does not allocate.
+        for (auto& level : slots_)
+            for (auto& slot : level) slot.reserve(kSlotReserve);
+        visiting_.reserve(kSlotReserve);
+    }
+
+    uint64_t TimerWheel::tickOf(Clock::time_point t) const
+    {
+        if (t <= origin_) return 0;
+        return static_cast<uint64_t>((t - origin_) / tick_);
+    }
+
+    TimerWheel::TimerId TimerWheel::schedule(Clock::time_point when, Callback cb)
+    {
+        // Round up so a timer never fires before its deadline.
+        uint64_t due = tickOf(when);
+        if (origin_ + tick_ * due < when) ++due;
+        if (due <= current_) due = current_ + 1;
+
+        const TimerId id = nextId_++;
+        if (spare_.empty()) {
+            timers_.emplace(id, Timer{due, std::move(cb)});
+        } else {
+            auto node = std::move(spare_.back());
+            spare_.pop_back();
+            node.key() = id;
+            node.mapped() = Timer{due, std::move(cb)};
+            timers_.insert(std::move(node));
+        }
+        place(id, due);
+        return id;
+    }
+
+    bool TimerWheel::cancel(TimerId id)
+    {
+        auto node = timers_.extract(id);
+        if (node.empty()) return false;
+        node.mapped().cb = nullptr;
+        spare_.push_back(std::move(node));
+        return true;
+    }
+
+    void TimerWheel::clear()
+    {
+        timers_.clear();
+        spare_.clear();
+        for (auto& level : slots_)
+            for (auto& slot : level) slot.clear();
+    }
+
+    void TimerWheel::place(TimerId id, uint64_t due)
+    {
+        const uint64_t delta = due > current_ ? due - current_ : 0;
+
+        int level = 0;
+        while (level < kLevels - 1 && (delta >> (kBits * (level + 1))) != 0) ++level;
+
+        // Beyond the wheel's span: park in the furthest top-level slot; cascade re-files it.
+        uint64_t at = due;
+        const uint64_t span = uint64_t(1) << (kBits * kLevels);
+        if (delta >= span) at = current_ + span - 1;
+
+        auto& ids = slots_[level][(at >> (kBits * level)) & kMask];
+        if (ids.size() == ids.capacity()) {
+            // Make room from cancelled ids before growing the slot.
+            ids.erase(std::remove_if(ids.begin(), ids.end(), [this](TimerId t) { return timers_.count(t) == 0; }),
+                      ids.end());
+        }
+        ids.push_back(id);
+    }
+
+    void TimerWheel::cascade(int level, uint64_t slot)
+    {
+        visiting_.clear();
+        visiting_.swap(slots_[level][slot]);
+        for (TimerId id : visiting_) {
+            auto it = timers_.find(id);
+            if (it != timers_.end()) place(id, it->second.due);
+        }
+    }
+
+    std::size_t TimerWheel::advance(Clock::time_point now)
+    {
+        const uint64_t target = tickOf(now);
+        std::size_t fired = 0;
+
+        while (current_ < target) {
+            if (timers_.empty()) {
+                // Nothing to fire or cascade: jump straight to now.
+                current_ = target;
+                for (auto& level : slots_)
+                    for (auto& slot : level) slot.clear();
+                break;
+            }
+
+            ++current_;
+
+            // Higher levels first so their timers can land in the slot about to fire.
+            for (int level = kLevels - 1; level >= 1; --level) {
+                if ((current_ & ((uint64_t(1) << (kBits * level)) - 1)) == 0) {
+                    cascade(level, (current_ >> (kBits * level)) & kMask);
+                }
+            }
+
+            // Callbacks may schedule, but never into the slot being visited (due > current_
+            // lands at least one tick ahead), so the ids stay put while they run.
+            visiting_.clear();
+            visiting_.swap(slots_[0][current_ & kMask]);
+            for (std::size_t i = 0; i < visiting_.size(); ++i) {
+                const TimerId id = visiting_[i];
+                auto it = timers_.find(id);
+                if (it == timers_.end()) continue;
+                if (it->second.due > current_) {      // parked beyond the span; not yet
+                    place(id, it->second.due);
+                    continue;
+                }
+                auto node = timers_.extract(it);
+                Callback cb = std::move(node.mapped().cb);
+                node.mapped().cb = nullptr;
+                spare_.push_back(std::move(node));
+                cb();
+                ++fired;
+            }
+        }
+        return fired;
+    }
+
+    bool TimerWheel::slotLive(int level, uint64_t slot) const
+    {
+        // Drop the dead prefix so repeated nextExpiry() calls don't rescan it.
+        auto& ids = slots_[level][slot];
+        std::size_t dead = 0;
+        while (dead < ids.size() && timers_.count(ids[dead]) == 0) ++dead;
+        ids.erase(ids.begin(), ids.begin() + static_cast<std::ptrdiff_t>(dead));
+        return !ids.empty();
+    }
+
+    std::optional<TimerWheel::Clock::time_point> TimerWheel::nextExpiry() const
+    {
+        if (timers_.empty()) return std::nullopt;
+
+        uint64_t best = UINT64_MAX;
+
+        // Level 0 slots fire on consecutive ticks.
+        for (uint64_t t = current_ + 1; t <= current_ + kSlots; ++t) {
+            if (slotLive(0, t & kMask)) { best = t; break; }
+        }
+
+        // Level L slots cascade at multiples of 64^L.
+        for (int level = 1; level < kLevels; ++level) {
+            const int shift = kBits * level;
+            for (uint64_t k = (current_ >> shift) + 1; k <= (current_ >> shift) + kSlots; ++k) {
+                const uint64_t t = k << shift;
+                if (t >= best) break;
+                if (slotLive(level, k & kMask)) { best = t; break; }
+            }
+        }
+
+        if (best == UINT64_MAX) return std::nullopt;
+        return origin_ + tick_ * best;
+    }
+
+} // namespace bittorrent::tracker
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include "../include/tracker_scheduler.hpp"
+
+
+namespace bittorrent::tracker {
+
+    namespace {
+        // The task this pool thread is running, so remove() from inside it does not wait on itself.
+        thread_local const TrackerScheduler* tlsScheduler = nullptr;
+        thread_local std::uint32_t tlsSlot = 0;
+    }
+
+    TrackerScheduler::TrackerScheduler(TrackerSchedulerConfig cfg)
+    {
+        const std::size_t n = std::max<std::size_t>(cfg.threads, 1);
+        pool_.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) pool_.emplace_back([this] { workerLoop(); });
+    }
+
+    TrackerScheduler::~TrackerScheduler()
+    {
+        {
+            std::scoped_lock lk(mu_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : pool_) t.join();
+    }
+
+    std::shared_ptr<TrackerScheduler> TrackerScheduler::shared()
+    {
+        static const auto instance = std::make_shared<TrackerScheduler>();
+        return instance;
+    }
+
+    // ---------- Heap (slot indices ordered by due; every slot knows its position) ----------
+
+    void TrackerScheduler::place(std::uint32_t pos, std::uint32_t idx)
+    {
+        heap_[pos] = idx;
+        slots_[idx].heapPos = pos;
+    }
+
+    void TrackerScheduler::siftUp(std::uint32_t pos)
+    {
+        const std::uint32_t idx = heap_[pos];
+        while (pos > 0) {
+            const std::uint32_t parent = (pos - 1) / 2;
+            if (!(slots_[idx].due < slots_[heap_[parent]].due)) break;
+            place(pos, heap_[parent]);
+            pos = parent;
+        }
+        place(pos, idx);
+    }
+
+    void TrackerScheduler::siftDown(std::uint32_t pos)
+    {
+        const std::uint32_t idx = heap_[pos];
+        const auto n = static_cast<std::uint32_t>(heap_.size());
+        for (;;) {
+            std::uint32_t child = 2 * pos + 1;
+            if (child >= n) break;
+            if (child + 1 < n && slots_[heap_[child + 1]].due < slots_[heap_[child]].due) ++child;
+            if (!(slots_[heap_[child]].due < slots_[idx].due)) break;
+            place(pos, heap_[child]);
+            pos = child;
+        }
+        place(pos, idx);
+    }
+
+    void TrackerScheduler::push(std::uint32_t idx, Clock::time_point due)
+    {
+        slots_[idx].due = due;
+        heap_.push_back(idx);
+        siftUp(static_cast<std::uint32_t>(heap_.size() - 1));
+        if (slots_[idx].heapPos == 0) cv_.notify_one();     // new earliest deadline
+    }
+
+    void TrackerScheduler::unlink(std::uint32_t idx)
+    {
+        const std::uint32_t pos = slots_[idx].heapPos;
+        if (pos == kNotQueued) return;
+        slots_[idx].heapPos = kNotQueued;
+
+        const std::uint32_t last = heap_.back();
+        heap_.pop_back();
+        if (pos == heap_.size()) return;
+        place(pos, last);
+        siftDown(pos);
+        siftUp(slots_[last].heapPos);
+    }
+
+    // ---------- Slots ----------
+
+    TrackerScheduler::Slot* TrackerScheduler::find(TaskId id)
+    {
+        const auto lo = static_cast<std::uint32_t>(id);
+        if (lo == 0 || lo > slots_.size()) return nullptr;
+        Slot& s = slots_[lo - 1];
+        if (!s.task || s.removed || s.generation != static_cast<std::uint32_t>(id >> 32)) return nullptr;
+        return &s;
+    }
+
+    void TrackerScheduler::release(std::uint32_t idx)
+    {
+        Slot& s = slots_[idx];
+        s.task.reset();
+        s.removed = false;
+        s.running = false;
+        s.heapPos = kNotQueued;
+        s.wakeAt = Clock::time_point::max();
+        ++s.generation;     // stale ids stop matching
+        free_.push_back(idx);
+        --live_;
+    }
+
+    TrackerScheduler::TaskId TrackerScheduler::add(Task task, Clock::time_point firstRun)
+    {
+        std::scoped_lock lk(mu_);
+        std::uint32_t idx;
+        if (!free_.empty()) {
+            idx = free_.back();
+            free_.pop_back();
+        } else {
+            idx = static_cast<std::uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+        slots_[idx].task = std::make_unique<Task>(std::move(task));
+        ++live_;
+        push(idx, firstRun);
+        return (static_cast<TaskId>(slots_[idx].generation) << 32) | (idx + 1);
+    }
+
+    void TrackerScheduler::wake(TaskId id, Clock::time_point when)
+    {
+        std::scoped_lock lk(mu_);
+        Slot* s = find(id);
+        if (!s) return;
+        const auto idx = static_cast<std::uint32_t>(id) - 1;
+
+        if (s->running) {
+            s->wakeAt = std::min(s->wakeAt, when);
+        } else if (s->heapPos == kNotQueued) {
+            push(idx, when);
+        } else if (when < s->due) {
+            s->due = when;
+            siftUp(s->heapPos);
+            if (s->heapPos == 0) cv_.notify_one();
+        }
+    }
+
+    void TrackerScheduler::remove(TaskId id)
+    {
+        std::unique_lock lk(mu_);
+        Slot* s = find(id);
+        if (!s) return;
+        const auto idx = static_cast<std::uint32_t>(id) - 1;
+
+        if (!s->running) {
+            unlink(idx);
+            release(idx);
+            return;
+        }
+        // The worker releases it once the run returns; a task removing itself cannot wait for that.
+        s->removed = true;
+        if (tlsScheduler == this && tlsSlot == idx) return;
+        const auto generation = s->generation;
+        idle_.wait(lk, [&] { return slots_[idx].generation != generation; });
+    }
+
+    TrackerScheduler::Stats TrackerScheduler::stats() const
+    {
+        std::scoped_lock lk(mu_);
+        return Stats{runs_, live_, heap_.size()};
+    }
+
+    // ---------- Pool ----------
+
+    void TrackerScheduler::workerLoop()
+    {
+        std::unique_lock lk(mu_);
+        while (!stopping_) {
+            if (heap_.empty()) { cv_.wait(lk); continue; }
+            const auto due = slots_[heap_[0]].due;
+            if (due > Clock::now()) { cv_.wait_until(lk, due); continue; }
+
+            const std::uint32_t idx = heap_[0];
+            unlink(idx);
+            slots_[idx].running = true;
+            Task* task = slots_[idx].task.get();
+            ++runs_;
+            if (!heap_.empty()) cv_.notify_one();   // another thread takes the next deadline
+            lk.unlock();
+
+            tlsScheduler = this;
+            tlsSlot = idx;
+            const auto next = (*task)(Clock::now());
+            tlsScheduler = nullptr;
+
+            lk.lock();
+            Slot& s = slots_[idx];
+            s.running = false;
+            if (s.removed) {
+                release(idx);
+                idle_.notify_all();
+                continue;
+            }
+            const auto when = std::min(next, s.wakeAt);
+            s.wakeAt = Clock::time_point::max();
+            if (when != Clock::time_point::max()) push(idx, when);
+        }
+    }
+
+} // namespace bittorrent::tracker
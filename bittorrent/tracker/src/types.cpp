@@ -2,6 +2,8 @@
 #include <iomanip>
 #include <cctype>
 #include <algorithm>
+#include <cstring>
+#include <arpa/inet.h>
 #include "../include/types.hpp"
 
 
@@ -17,4 +19,79 @@ namespace bittorrent::tracker {
     }
 
 
-} // namespace bittorrent::tracker
\ No newline at end of file
+    PeerEndpoint PeerEndpoint::v4(const std::uint8_t* addr4, std::uint16_t port) {
+        PeerEndpoint e;
+        e.family = kV4;
+        std::memcpy(e.addr.data(), addr4, 4);
+        e.setPort(port);
+        return e;
+    }
+
+    PeerEndpoint PeerEndpoint::v6(const std::uint8_t* addr16, std::uint16_t port) {
+        PeerEndpoint e;
+        e.family = kV6;
+        std::memcpy(e.addr.data(), addr16, 16);
+        e.setPort(port);
+        return e;
+    }
+
+    std::optional<PeerEndpoint> PeerEndpoint::parse(std::string_view ip, std::uint16_t port) {
+        char buf[kMaxIpText];
+        if (ip.empty() || ip.size() >= sizeof(buf)) return std::nullopt;
+        std::memcpy(buf, ip.data(), ip.size());
+        buf[ip.size()] = '\0';
+
+        std::uint8_t raw[16];
+        if (inet_pton(AF_INET, buf, raw) == 1) return v4(raw, port);
+        if (inet_pton(AF_INET6, buf, raw) == 1) return v6(raw, port);
+        return std::nullopt;
+    }
+
+    // Dotted quad without inet_ntop; IPv6 is rare enough to take the libc path.
+    std::size_t PeerEndpoint::formatIp(char* out) const {
+        if (isV6()) {
+            if (!inet_ntop(AF_INET6, addr.data(), out, kMaxIpText)) return 0;
+            return std::strlen(out);
+        }
+        if (!isV4()) return 0;
+
+        char* o = out;
+        for (int i = 0; i < 4; ++i) {
+            unsigned v = addr[i];
+            if (v >= 100) { *o++ = static_cast<char>('0' + v / 100); v %= 100; *o++ = static_cast<char>('0' + v / 10); v %= 10; }
+            else if (v >= 10) { *o++ = static_cast<char>('0' + v / 10); v %= 10; }
+            *o++ = static_cast<char>('0' + v);
+            if (i != 3) *o++ = '.';
+        }
+        return static_cast<std::size_t>(o - out);
+    }
+
+    std::string PeerEndpoint::ip() const {
+        char buf[kMaxIpText];
+        return std::string(buf, formatIp(buf));
+    }
+
+    std::string PeerEndpoint::toString() const {
+        std::string out = isV6() ? "[" + ip() + "]" : ip();
+        out += ':';
+        out += std::to_string(port());
+        return out;
+    }
+
+
+} // namespace bittorrent::tracker
+
+
+std::size_t std::hash<bittorrent::tracker::PeerEndpoint>::operator()(const bittorrent::tracker::PeerEndpoint& e) const noexcept
+{
+    // All 19 bytes in three loads, folded with a 64-bit multiply-xorshift (from splitmix64).
+    std::uint64_t a, b;
+    std::memcpy(&a, e.addr.data(), 8);
+    std::memcpy(&b, e.addr.data() + 8, 8);
+    std::uint64_t h = a ^ (b * 0x9E3779B97F4A7C15ull)
+                    ^ (std::uint64_t(e.family) << 56 | std::uint64_t(e.portBE[0]) << 8 | e.portBE[1]);
+    h ^= h >> 31; h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27; h *= 0x94D049BB133111EBull;
+    h ^= h >> 31;
+    return static_cast<std::size_t>(h);
+}
@@ -0,0 +1,841 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <random>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "udp_engine.hpp"
+#include "udp_url.hpp"
+#include "compact_peer_codec.hpp"
+#include "udp_wire.hpp"
+
+
+namespace bittorrent::tracker {
+
+    using namespace std::chrono;
+
+    namespace {
+
+        using namespace wire;
+
+        // Same family, address and port (what ConnectionIdCache::keyFor encodes, without building a string).
+        bool sameEndpoint(const sockaddr_storage& a, const sockaddr_storage& b) {
+            if (a.ss_family != b.ss_family) return false;
+            if (a.ss_family == AF_INET) {
+                const auto& x = reinterpret_cast<const sockaddr_in&>(a);
+                const auto& y = reinterpret_cast<const sockaddr_in&>(b);
+                return x.sin_port == y.sin_port && x.sin_addr.s_addr == y.sin_addr.s_addr;
+            }
+            if (a.ss_family == AF_INET6) {
+                const auto& x = reinterpret_cast<const sockaddr_in6&>(a);
+                const auto& y = reinterpret_cast<const sockaddr_in6&>(b);
+                return x.sin6_port == y.sin6_port && std::memcmp(&x.sin6_addr, &y.sin6_addr, 16) == 0;
+            }
+            return false;
+        }
+
+        uint32_t rand_u32() {
+            static thread_local std::mt19937 rng([]{
+                std::random_device rd;
+                std::seed_seq ss{rd(), rd(), rd(), rd(), rd(), rd()};
+                return std::mt19937{ss};
+            }());
+            return std::uniform_int_distribution<uint32_t>{}(rng);
+        }
+
+        // Datagrams per sendmmsg/recvmmsg call at most, and the size of each receive slot.
+        // Larger replies (over ~2700 IPv4 peers) are dropped as truncated.
+        constexpr std::size_t kMaxBatch    = 32;
+        constexpr std::size_t kRxSlotBytes = 16384;
+
+        // Finished Op records kept for reuse; past this, they are freed.
+        constexpr std::size_t kMaxSpareOps = 256;
+
+        void setPort(sockaddr_storage& ss, uint16_t port) {
+            if (ss.ss_family == AF_INET) reinterpret_cast<sockaddr_in&>(ss).sin_port = htons(port);
+            else reinterpret_cast<sockaddr_in6&>(ss).sin6_port = htons(port);
+        }
+
+        int openSocket(int family) {
+            int fd = ::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (fd < 0) return fd;
+            if (family == AF_INET6) {
+                int on = 1;
+                ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &on, sizeof(on));
+            }
+            // Start-up and shutdown bursts queue thousands of datagrams at once (best effort).
+            int bytes = 4 << 20;
+            ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bytes, sizeof(bytes));
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bytes, sizeof(bytes));
+            return fd;
+        }
+
+        // Whether the host has a route for this family. connect() on a UDP socket only
+        // consults the routing table; nothing is sent. (Addresses are from RFC 5737/3849.)
+        bool hasRoute(int family) {
+            int fd = ::socket(family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) return false;
+            sockaddr_storage ss{};
+            socklen_t len;
+            if (family == AF_INET) {
+                auto& a = reinterpret_cast<sockaddr_in&>(ss);
+                a.sin_family = AF_INET;
+                a.sin_port = htons(9);
+                ::inet_pton(AF_INET, "192.0.2.1", &a.sin_addr);
+                len = sizeof(sockaddr_in);
+            } else {
+                auto& a = reinterpret_cast<sockaddr_in6&>(ss);
+                a.sin6_family = AF_INET6;
+                a.sin6_port = htons(9);
+                ::inet_pton(AF_INET6, "2001:db8::1", &a.sin6_addr);
+                len = sizeof(sockaddr_in6);
+            }
+            const bool ok = ::connect(fd, reinterpret_cast<const sockaddr*>(&ss), len) == 0;
+            ::close(fd);
+            return ok;
+        }
+
+    } // namespace
+
+
+    struct UdpTrackerEngine::Op
+    {
+        enum class Kind { announce, scrape };
+        enum class Stage { connect, request };
+
+        Kind kind{Kind::announce};
+        Stage stage{Stage::connect};
+        sockaddr_storage addr{};
+        socklen_t addrlen{0};
+        std::string key;                    // ConnectionIdCache::keyFor(addr)
+        bool connector{false};              // parked_[key] waits on this op's connect
+
+        AnnounceRequest req;
+        std::vector<InfoHash> hashes;
+        AnnounceCallback onAnnounce;
+        ScrapeCallback onScrape;
+
+        uint32_t tx{0};                     // transaction_id of the packet currently on the wire
+        int attempt{0};                     // BEP 15 "n"
+        uint64_t connId{0};
+        Clock::time_point connExpiry{};
+        TimerWheel::TimerId timer{0};       // pending retransmit
+    };
+
+
+    // Lets resolver callbacks that outlive the engine see that it is gone.
+    struct UdpTrackerEngine::Lifeline
+    {
+        std::mutex mu;
+        UdpTrackerEngine* engine{nullptr};
+    };
+
+
+    // Fixed recvmmsg scatter buffers, allocated once per engine.
+    struct UdpTrackerEngine::RxBuffers
+    {
+        struct alignas(64) Slot { uint8_t bytes[kRxSlotBytes]; };
+
+        explicit RxBuffers(std::size_t slots)
+            : slot(slots), from(slots), iov(slots), hdrs(slots) {}
+
+        std::vector<Slot> slot;
+        std::vector<sockaddr_storage> from;
+        std::vector<iovec> iov;
+        std::vector<mmsghdr> hdrs;
+    };
+
+
+    UdpTrackerEngine::UdpTrackerEngine(UdpEngineConfig cfg, std::shared_ptr<ConnectionIdCache> connCache,
+                                       std::shared_ptr<DnsResolver> resolver)
+        : cfg_(cfg),
+          connCache_(connCache ? std::move(connCache) : std::make_shared<ConnectionIdCache>()),
+          resolver_(resolver ? std::move(resolver) : DnsResolver::shared()),
+          lifeline_(std::make_shared<Lifeline>())
+    {
+        lifeline_->engine = this;
+        if (cfg_.ioBatch == 0) cfg_.ioBatch = 1;
+        rx_ = std::make_unique<RxBuffers>(std::min(cfg_.ioBatch, kMaxBatch));
+        outbox4_.reserve(kMaxBatch * 8);
+        outbox6_.reserve(kMaxBatch * 8);
+    }
+
+    UdpTrackerEngine::~UdpTrackerEngine()
+    {
+        {
+            std::lock_guard<std::mutex> lk(lifeline_->mu);
+            lifeline_->engine = nullptr;
+        }
+        stop();
+    }
+
+    // ---------- Lifecycle ----------
+    Expected<void> UdpTrackerEngine::start()
+    {
+        std::lock_guard<std::mutex> lk(queueMu_);
+        if (running_.load()) return Expected<void>::success();
+
+        v4Fd_ = openSocket(AF_INET);
+        v6Fd_ = cfg_.ipv6 ? openSocket(AF_INET6) : -1;     // optional: hosts without IPv6 only get the v4 socket
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (v4Fd_ < 0 || epollFd_ < 0 || wakeFd_ < 0) {
+            closeAll();
+            return Expected<void>::failure(std::string("udp: engine setup failed: ") + std::strerror(errno));
+        }
+
+        for (int fd : {v4Fd_, v6Fd_, wakeFd_}) {
+            if (fd < 0) continue;
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+                closeAll();
+                return Expected<void>::failure("udp: epoll_ctl failed");
+            }
+        }
+
+        v4Route_.store(hasRoute(AF_INET));
+        v6Socket_.store(v6Fd_ >= 0);
+        v6Route_.store(v6Fd_ >= 0 && hasRoute(AF_INET6));
+
+        running_.store(true);
+        io_ = std::thread([this]{ loop(); });
+        return Expected<void>::success();
+    }
+
+    void UdpTrackerEngine::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lk(queueMu_);
+            if (!running_.exchange(false)) return;
+            const uint64_t one = 1;
+            (void)!::write(wakeFd_, &one, sizeof(one));
+        }
+        if (io_.joinable()) io_.join();
+
+        // The I/O thread is gone; everything left is owned by this thread now.
+        drainSubmissions();
+        auto pending = std::move(byTx_);
+        byTx_.clear();
+        timers_.clear();
+        for (auto* q : {&outbox4_, &outbox6_}) {
+            for (auto& o : *q) txPool_.release(o.buf);
+            q->clear();
+        }
+        wantOut4_ = wantOut6_ = false;
+        {
+            std::lock_guard<std::mutex> lk(queueMu_);
+            closeAll();
+        }
+
+        // Finishing a connector also fails the operations parked behind it.
+        for (auto& [tx, op] : pending) finish(std::move(op), "udp: engine stopped");
+        parked_.clear();
+
+        // Posted tasks are not dropped: a caller waiting on one (a scrape batch's flush) would
+        // otherwise wait forever. They run now and see the engine stopped.
+        auto tasks = std::move(postedTasks_);
+        postedTasks_.clear();
+        for (auto& [id, fn] : tasks) fn();
+    }
+
+    void UdpTrackerEngine::closeAll()
+    {
+        for (int* fd : {&v4Fd_, &v6Fd_, &epollFd_, &wakeFd_}) {
+            if (*fd >= 0) ::close(*fd);
+            *fd = -1;
+        }
+    }
+
+    UdpTrackerEngine::IoStats UdpTrackerEngine::ioStats() const noexcept
+    {
+        IoStats s;
+        s.datagramsSent = datagramsSent_.load();
+        s.sendCalls = sendCalls_.load();
+        s.datagramsReceived = datagramsReceived_.load();
+        s.recvCalls = recvCalls_.load();
+        return s;
+    }
+
+    // ---------- Submission ----------
+    namespace {
+        void reject(UdpTrackerEngine::AnnounceCallback& onAnnounce,
+                    UdpTrackerEngine::ScrapeCallback& onScrape, const std::string& msg) {
+            if (onAnnounce) onAnnounce(Expected<AnnounceResponse>::failure(msg));
+            if (onScrape) onScrape(Expected<std::map<InfoHash, ScrapeStats>>::failure(msg));
+        }
+    }
+
+    void UdpTrackerEngine::announce(const AnnounceRequest& req, const std::string& url, AnnounceCallback cb)
+    {
+        auto op = acquireOp();
+        op->kind = Op::Kind::announce;
+        op->req = req;
+        op->onAnnounce = std::move(cb);
+        resolveAndSubmit(url, std::move(op));
+    }
+
+    void UdpTrackerEngine::scrape(const std::vector<InfoHash>& hashes, const std::string& url, ScrapeCallback cb)
+    {
+        if (hashes.empty()) {
+            cb(Expected<std::map<InfoHash, ScrapeStats>>::success({}));
+            return;
+        }
+
+        if (hashes.size() > kMaxScrapeHashes) {
+            cb(Expected<std::map<InfoHash, ScrapeStats>>::failure("udp: at most 74 info-hashes per scrape (BEP 15)"));
+            return;
+        }
+
+        auto op = acquireOp();
+        op->kind = Op::Kind::scrape;
+        op->hashes.assign(hashes.begin(), hashes.end());
+        op->onScrape = std::move(cb);
+        resolveAndSubmit(url, std::move(op));
+    }
+
+    void UdpTrackerEngine::resolveAndSubmit(const std::string& url, std::unique_ptr<Op> op)
+    {
+        // Per calling thread, so repeated announces parse and look up into the same storage.
+        thread_local detail::UdpUrlParts parts;
+        thread_local ResolvedAddrs addrs;
+        if (!detail::parse_udp_url_into(url, parts)) {
+            reject(op->onAnnounce, op->onScrape, "udp: invalid URL (expect udp://host[:port]/...)");
+            return;
+        }
+
+        // Numeric and cached hosts go straight to the queue.
+        if (resolver_->tryCached(parts.host, addrs)) {
+            const ResolvedAddr* a = pickAddress(addrs);
+            if (!a) {
+                reject(op->onAnnounce, op->onScrape, "udp: no usable address family");
+                return;
+            }
+            op->addr = a->addr;
+            op->addrlen = a->len;
+            setPort(op->addr, parts.port);
+            submit(std::move(op));
+            return;
+        }
+
+        // std::function needs a copyable callable; the op is moved back out exactly once.
+        std::shared_ptr<Op> holder(std::move(op));
+        const uint16_t port = parts.port;
+        const std::string host = parts.host;    // parts may be reused by a callback run inline
+
+        resolver_->resolve(host, [life = lifeline_, holder, port](Expected<ResolvedAddrs> r) {
+            auto owned = std::make_unique<Op>(std::move(*holder));
+            if (!r.has_value()) {
+                reject(owned->onAnnounce, owned->onScrape, r.error.has_value() ? r.error->message : "udp: resolve failed");
+                return;
+            }
+
+            std::lock_guard<std::mutex> lk(life->mu);
+            if (!life->engine) {
+                reject(owned->onAnnounce, owned->onScrape, "udp: engine stopped");
+                return;
+            }
+
+            const ResolvedAddr* a = life->engine->pickAddress(r.get());
+            if (!a) {
+                reject(owned->onAnnounce, owned->onScrape, "udp: no usable address family");
+                return;
+            }
+            owned->addr = a->addr;
+            owned->addrlen = a->len;
+            setPort(owned->addr, port);
+            life->engine->submit(std::move(owned));
+        });
+    }
+
+    // First address whose family we can reach (resolver order: IPv4, then IPv6); a v6-only
+    // host thus skips the A records of dual-stack trackers. Falls back to the first address
+    // we have a socket for, and nullptr when there is none: such an op could never be sent.
+    const ResolvedAddr* UdpTrackerEngine::pickAddress(const ResolvedAddrs& addrs) const
+    {
+        for (const auto& a : addrs) {
+            if (a.addr.ss_family == AF_INET && v4Route_.load()) return &a;
+            if (a.addr.ss_family == AF_INET6 && v6Route_.load()) return &a;
+        }
+        for (const auto& a : addrs) {
+            if (a.addr.ss_family == AF_INET) return &a;
+            if (a.addr.ss_family == AF_INET6 && v6Socket_.load()) return &a;
+        }
+        return nullptr;
+    }
+
+    void UdpTrackerEngine::submit(std::unique_ptr<Op> op)
+    {
+        ConnectionIdCache::keyFor(op->addr, op->key);
+        {
+            // wakeFd_ is only closed under queueMu_, so it is valid while running_ holds.
+            std::lock_guard<std::mutex> lk(queueMu_);
+            if (running_.load()) {
+                inFlight_.fetch_add(1);
+                // Only the first submission since the last drain needs to wake the engine.
+                const bool wake = submitted_.empty() && posted_.empty();
+                submitted_.push_back(std::move(op));
+                if (wake) {
+                    const uint64_t one = 1;
+                    (void)!::write(wakeFd_, &one, sizeof(one));
+                }
+                return;
+            }
+        }
+        reject(op->onAnnounce, op->onScrape, "udp: engine not running");
+    }
+
+    bool UdpTrackerEngine::post(std::chrono::milliseconds delay, std::function<void()> fn)
+    {
+        std::lock_guard<std::mutex> lk(queueMu_);
+        if (!running_.load()) return false;
+        const bool wake = submitted_.empty() && posted_.empty();
+        posted_.emplace_back(Clock::now() + delay, std::move(fn));
+        if (wake) {
+            const uint64_t one = 1;
+            (void)!::write(wakeFd_, &one, sizeof(one));
+        }
+        return true;
+    }
+
+    void UdpTrackerEngine::drainSubmissions()
+    {
+        std::vector<std::pair<Clock::time_point, std::function<void()>>> tasks;
+        {
+            std::lock_guard<std::mutex> lk(queueMu_);
+            draining_.swap(submitted_);             // submitted_ takes over the old, empty buffer
+            tasks.swap(posted_);
+        }
+        for (auto& [when, fn] : tasks) {
+            const uint64_t id = nextPostedTask_++;
+            postedTasks_.emplace(id, std::move(fn));
+            if (!running_.load()) continue;                 // stop() runs it
+            timers_.schedule(when, [this, id] {
+                auto it = postedTasks_.find(id);
+                if (it == postedTasks_.end()) return;
+                auto fn = std::move(it->second);
+                postedTasks_.erase(it);
+                fn();
+            });
+        }
+        for (auto& op : draining_) {
+            if (running_.load()) begin(std::move(op));
+            else finish(std::move(op), "udp: engine stopped");
+        }
+        draining_.clear();
+    }
+
+    std::unique_ptr<UdpTrackerEngine::Op> UdpTrackerEngine::acquireOp()
+    {
+        {
+            std::lock_guard<std::mutex> lk(opsMu_);
+            if (!spareOps_.empty()) {
+                auto op = std::move(spareOps_.back());
+                spareOps_.pop_back();
+                return op;
+            }
+        }
+        return std::make_unique<Op>();
+    }
+
+    void UdpTrackerEngine::recycleOp(std::unique_ptr<Op> op)
+    {
+        // Reset to a fresh Op, keeping the capacity of key and hashes.
+        op->stage = Op::Stage::connect;
+        op->connector = false;
+        op->hashes.clear();
+        op->onAnnounce = nullptr;
+        op->onScrape = nullptr;
+        op->attempt = 0;
+        op->timer = 0;
+
+        std::lock_guard<std::mutex> lk(opsMu_);
+        if (spareOps_.size() < kMaxSpareOps) spareOps_.push_back(std::move(op));
+    }
+
+    UdpTrackerEngine::Op& UdpTrackerEngine::track(std::unique_ptr<Op> op)
+    {
+        Op& ref = *op;
+        if (spareTx_.empty()) {
+            byTx_.emplace(ref.tx, std::move(op));
+        } else {
+            auto node = std::move(spareTx_.back());
+            spareTx_.pop_back();
+            node.key() = ref.tx;
+            node.mapped() = std::move(op);
+            byTx_.insert(std::move(node));
+        }
+        return ref;
+    }
+
+    std::unique_ptr<UdpTrackerEngine::Op> UdpTrackerEngine::untrack(TxMap::iterator it)
+    {
+        auto node = byTx_.extract(it);
+        auto op = std::move(node.mapped());
+        spareTx_.push_back(std::move(node));
+        return op;
+    }
+
+    // ---------- Engine thread ----------
+    void UdpTrackerEngine::loop()
+    {
+        epoll_event events[8];
+
+        while (running_.load()) {
+            const int n = ::epoll_wait(epollFd_, events, 8, pollTimeoutMs(Clock::now()));
+            if (n < 0 && errno != EINTR) break;
+
+            for (int i = 0; i < n; ++i) {
+                const int fd = events[i].data.fd;
+                if (fd == wakeFd_) {
+                    uint64_t v;
+                    while (::read(wakeFd_, &v, sizeof(v)) > 0) {}
+                } else if (events[i].events & (EPOLLIN | EPOLLERR)) {
+                    onReadable(fd);
+                }
+                // EPOLLOUT needs no handling of its own: flushOutbox() below retries the queue.
+            }
+
+            if (!running_.load()) break;
+            drainSubmissions();
+            timers_.advance(Clock::now());
+            flushOutbox();
+        }
+    }
+
+    int UdpTrackerEngine::pollTimeoutMs(Clock::time_point now) const
+    {
+        const auto next = timers_.nextExpiry();
+        if (!next) return -1;
+        const auto wait = *next - now;
+        if (wait <= Clock::duration::zero()) return 0;
+        // Round up so we never wake just before the deadline and spin.
+        return static_cast<int>(ceil<milliseconds>(wait).count());
+    }
+
+    uint32_t UdpTrackerEngine::freshTx() const
+    {
+        uint32_t tx;
+        do { tx = rand_u32(); } while (byTx_.count(tx) != 0);
+        return tx;
+    }
+
+    void UdpTrackerEngine::begin(std::unique_ptr<Op> op)
+    {
+        const auto now = Clock::now();
+        if (auto hit = connCache_->get(op->addr, now)) {
+            op->connId = hit->connId;
+            op->connExpiry = hit->expiry;
+            op->stage = Op::Stage::request;
+        } else {
+            auto [pit, first] = parked_.try_emplace(op->key);
+            if (!first) {
+                pit->second.push_back(std::move(op)); // a connect to this tracker is already on the wire
+                return;
+            }
+            op->connector = true;
+        }
+
+        op->tx = freshTx();
+        transmit(track(std::move(op)), now);
+    }
+
+    // Move an op that has a connection_id into the request stage under a new transaction id.
+    void UdpTrackerEngine::startRequest(std::unique_ptr<Op> op, Clock::time_point now)
+    {
+        op->stage = Op::Stage::request;
+        op->tx = freshTx();
+        transmit(track(std::move(op)), now);
+    }
+
+    void UdpTrackerEngine::transmit(Op& op, Clock::time_point now)
+    {
+        PacketBuffer* buf = txPool_.acquire();
+        if (op.stage == Op::Stage::connect) {
+            buf->len = encodeConnect(buf->data, op.tx);
+        } else if (op.kind == Op::Kind::announce) {
+            buf->len = encodeAnnounce(buf->data, op.connId, op.tx, op.req);
+        } else {
+            buf->len = encodeScrape(buf->data, op.connId, op.tx, op.hashes);
+        }
+
+        // Sent by flushOutbox() once this wakeup's work is done; a failed send is handled like a lost packet.
+        auto& q = (op.addr.ss_family == AF_INET6) ? outbox6_ : outbox4_;
+        q.push_back(Outgoing{op.addr, op.addrlen, buf});
+
+        timers_.cancel(op.timer);
+        op.timer = timers_.schedule(now + cfg_.timeout * (1 << op.attempt),
+                                    [this, tx = op.tx] { onTimeout(tx); });
+    }
+
+    // ---------- Socket I/O ----------
+    void UdpTrackerEngine::flushOutbox()
+    {
+        const bool more4 = sendQueued(v4Fd_, outbox4_);
+        const bool more6 = sendQueued(v6Fd_, outbox6_);
+        armWritable(v4Fd_, wantOut4_, more4);
+        armWritable(v6Fd_, wantOut6_, more6);
+    }
+
+    // Sends q front to back, ioBatch datagrams per syscall. Returns true if the socket
+    // buffer filled up and the rest of q must wait for EPOLLOUT.
+    bool UdpTrackerEngine::sendQueued(int fd, std::vector<Outgoing>& q)
+    {
+        if (q.empty()) return false;
+        if (fd < 0) {
+            for (auto& o : q) txPool_.release(o.buf);
+            q.clear();  // not reached: pickAddress() only picks families with a socket
+            return false;
+        }
+
+        mmsghdr hdrs[kMaxBatch];
+        iovec iov[kMaxBatch];
+        const std::size_t batch = std::min(cfg_.ioBatch, kMaxBatch);
+
+        std::size_t sent = 0;
+        bool blocked = false;
+        while (sent < q.size()) {
+            const std::size_t n = std::min(q.size() - sent, batch);
+            int r;
+            if (n == 1) {
+                const Outgoing& o = q[sent];
+                r = ::sendto(fd, o.buf->data, o.buf->len, MSG_NOSIGNAL,
+                             reinterpret_cast<const sockaddr*>(&o.addr), o.addrlen) < 0 ? -1 : 1;
+            } else {
+                for (std::size_t i = 0; i < n; ++i) {
+                    Outgoing& o = q[sent + i];
+                    iov[i].iov_base = o.buf->data;
+                    iov[i].iov_len = o.buf->len;
+                    hdrs[i] = mmsghdr{};
+                    hdrs[i].msg_hdr.msg_name = &o.addr;
+                    hdrs[i].msg_hdr.msg_namelen = o.addrlen;
+                    hdrs[i].msg_hdr.msg_iov = &iov[i];
+                    hdrs[i].msg_hdr.msg_iovlen = 1;
+                }
+                r = ::sendmmsg(fd, hdrs, static_cast<unsigned>(n), MSG_NOSIGNAL);
+            }
+            sendCalls_.fetch_add(1, std::memory_order_relaxed);
+
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+                    blocked = true;
+                    break;
+                }
+                ++sent;     // the first datagram failed outright (unreachable, ...): treat it as lost
+                continue;
+            }
+            sent += static_cast<std::size_t>(r);
+            datagramsSent_.fetch_add(static_cast<uint64_t>(r), std::memory_order_relaxed);
+        }
+
+        for (std::size_t i = 0; i < sent; ++i) txPool_.release(q[i].buf);
+        q.erase(q.begin(), q.begin() + static_cast<std::ptrdiff_t>(sent));
+        return blocked;
+    }
+
+    void UdpTrackerEngine::armWritable(int fd, bool& armed, bool want)
+    {
+        if (fd < 0 || armed == want) return;
+        epoll_event ev{};
+        ev.events = EPOLLIN | (want ? EPOLLOUT : 0u);
+        ev.data.fd = fd;
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev) == 0) armed = want;
+    }
+
+    void UdpTrackerEngine::onReadable(int fd)
+    {
+        RxBuffers& rx = *rx_;
+        const std::size_t slots = rx.hdrs.size();
+        for (;;) {
+            for (std::size_t i = 0; i < slots; ++i) {
+                rx.iov[i].iov_base = rx.slot[i].bytes;
+                rx.iov[i].iov_len = kRxSlotBytes;
+                rx.hdrs[i] = mmsghdr{};
+                rx.hdrs[i].msg_hdr.msg_name = &rx.from[i];
+                rx.hdrs[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+                rx.hdrs[i].msg_hdr.msg_iov = &rx.iov[i];
+                rx.hdrs[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            int r;
+            if (slots == 1) {
+                socklen_t flen = sizeof(sockaddr_storage);
+                const ssize_t n = ::recvfrom(fd, rx.slot[0].bytes, kRxSlotBytes, MSG_DONTWAIT | MSG_TRUNC,
+                                             reinterpret_cast<sockaddr*>(&rx.from[0]), &flen);
+                r = n < 0 ? -1 : 1;
+                if (n >= 0) {
+                    rx.hdrs[0].msg_len = static_cast<unsigned>(n);
+                    if (static_cast<std::size_t>(n) > kRxSlotBytes) rx.hdrs[0].msg_hdr.msg_flags = MSG_TRUNC;
+                }
+            } else {
+                r = ::recvmmsg(fd, rx.hdrs.data(), static_cast<unsigned>(slots), MSG_DONTWAIT, nullptr);
+            }
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                return; // EAGAIN or a queued ICMP error; retransmit timers cover both
+            }
+            recvCalls_.fetch_add(1, std::memory_order_relaxed);
+            datagramsReceived_.fetch_add(static_cast<uint64_t>(r), std::memory_order_relaxed);
+
+            for (int i = 0; i < r; ++i) {
+                if (rx.hdrs[i].msg_hdr.msg_flags & MSG_TRUNC) continue;
+                handleDatagram(static_cast<const uint8_t*>(rx.iov[i].iov_base), rx.hdrs[i].msg_len, rx.from[i]);
+            }
+            if (static_cast<std::size_t>(r) < slots) return;  // socket drained
+        }
+    }
+
+    void UdpTrackerEngine::handleDatagram(const uint8_t* p, std::size_t n, const sockaddr_storage& from)
+    {
+        if (n < 8) return;
+        const uint32_t action = load_be32(p);
+        const uint32_t tx     = load_be32(p + 4);
+
+        auto it = byTx_.find(tx);
+        if (it == byTx_.end()) return;              // late duplicate or unknown
+        Op& op = *it->second;
+        if (!sameEndpoint(from, op.addr)) return;   // not from the tracker we asked
+
+        if (action == kError) {
+            std::string msg(reinterpret_cast<const char*>(p) + 8, n - 8);
+            if (op.stage == Op::Stage::request) connCache_->invalidate(op.addr, op.connId);
+            auto owned = untrack(it);
+            finish(std::move(owned), "udp error: " + msg);
+            return;
+        }
+
+        if (op.stage == Op::Stage::connect) {
+            if (action != kConnect || n < 16) return;
+            const auto now = Clock::now();
+            op.connId = load_be64(p + 8);
+            op.connExpiry = now + cfg_.connTtl;
+            connCache_->put(op.addr, op.connId, op.connExpiry);
+
+            auto owned = untrack(it);
+
+            std::vector<std::unique_ptr<Op>> waiters;
+            if (owned->connector) {
+                owned->connector = false;
+                auto pit = parked_.find(owned->key);
+                if (pit != parked_.end()) {
+                    waiters = std::move(pit->second);
+                    parked_.erase(pit);
+                }
+            }
+            for (auto& w : waiters) {
+                w->connId = owned->connId;
+                w->connExpiry = owned->connExpiry;
+                startRequest(std::move(w), now);
+            }
+            startRequest(std::move(owned), now);
+            return;
+        }
+
+        if (op.kind == Op::Kind::announce) {
+            if (action != kAnnounce || n < 20) return;  // malformed: let the retransmit timer handle it
+
+            AnnounceResponse out{};
+            out.interval   = load_be32(p + 8);
+            out.incomplete = load_be32(p + 12);
+            out.complete   = load_be32(p + 16);
+
+            // BEP 15: the peer list matches the family the announce went out on (6 or 18 bytes).
+            const bool v6 = op.addr.ss_family == AF_INET6;
+            const std::size_t entry = v6 ? 18 : 6;
+            const std::size_t peerBytes = (n - 20) - (n - 20) % entry;
+            const std::string_view raw(reinterpret_cast<const char*>(p) + 20, peerBytes);
+            out.peers = v6 ? CompactPeerCodec::parseIPv6(raw) : CompactPeerCodec::parseIPv4(raw);
+
+            auto owned = untrack(it);
+            finish(std::move(owned), std::move(out));
+            return;
+        }
+
+        if (action != kScrape || n < 8 + 12 * op.hashes.size()) return;
+
+        std::map<InfoHash, ScrapeStats> out;
+        std::size_t off = 8;
+        for (const auto& h : op.hashes) {
+            ScrapeStats s{};
+            s.complete   = load_be32(p + off + 0);
+            s.downloaded = load_be32(p + off + 4);
+            s.incomplete = load_be32(p + off + 8);
+            out.emplace(h, s);
+            off += 12;
+        }
+        auto owned = untrack(it);
+        finish(std::move(owned), std::move(out));
+    }
+
+    void UdpTrackerEngine::onTimeout(uint32_t tx)
+    {
+        auto it = byTx_.find(tx);
+        if (it == byTx_.end()) return;
+        Op& op = *it->second;
+        op.timer = 0;
+
+        if (++op.attempt > cfg_.maxRetransmits) {
+            const char* what = op.stage == Op::Stage::connect ? "connect"
+                             : op.kind == Op::Kind::announce ? "announce" : "scrape";
+            auto owned = untrack(it);
+            finish(std::move(owned), std::string("udp: ") + what + " exhausted retries");
+            return;
+        }
+
+        const auto now = Clock::now();
+        if (op.stage == Op::Stage::request && now >= op.connExpiry) {
+            op.stage = Op::Stage::connect;  // connection_id went stale while we waited
+        }
+        transmit(op, now);
+    }
+
+    // ---------- Completion ----------
+    // Each finish() recycles the op before running its callback, which may start the next announce.
+    void UdpTrackerEngine::finish(std::unique_ptr<Op> op, std::string error)
+    {
+        timers_.cancel(op->timer);
+        if (op->connector) {
+            // The connect they were waiting on failed; it would fail for them too.
+            auto pit = parked_.find(op->key);
+            if (pit != parked_.end()) {
+                auto waiters = std::move(pit->second);
+                parked_.erase(pit);
+                for (auto& w : waiters) finish(std::move(w), error);
+            }
+        }
+
+        inFlight_.fetch_sub(1);
+        const bool announce = op->kind == Op::Kind::announce;
+        auto onAnnounce = std::move(op->onAnnounce);
+        auto onScrape = std::move(op->onScrape);
+        recycleOp(std::move(op));
+        if (announce) onAnnounce(Expected<AnnounceResponse>::failure(std::move(error)));
+        else onScrape(Expected<std::map<InfoHash, ScrapeStats>>::failure(std::move(error)));
+    }
+
+    void UdpTrackerEngine::finish(std::unique_ptr<Op> op, AnnounceResponse resp)
+    {
+        timers_.cancel(op->timer);
+        inFlight_.fetch_sub(1);
+        auto cb = std::move(op->onAnnounce);
+        recycleOp(std::move(op));
+        cb(Expected<AnnounceResponse>::success(std::move(resp)));
+    }
+
+    void UdpTrackerEngine::finish(std::unique_ptr<Op> op, std::map<InfoHash, ScrapeStats> stats)
+    {
+        timers_.cancel(op->timer);
+        inFlight_.fetch_sub(1);
+        auto cb = std::move(op->onScrape);
+        recycleOp(std::move(op));
+        cb(Expected<std::map<InfoHash, ScrapeStats>>::success(std::move(stats)));
+    }
+
+} // namespace bittorrent::tracker
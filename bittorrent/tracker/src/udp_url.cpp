@@ -13,9 +13,9 @@ namespace bittorrent::tracker::detail {
         return s.size() >= n && s.compare(0, n, pfx) == 0;
     }
 
-    std::optional<UdpUrlParts> parse_udp_url_minimal(const std::string& url)
+    bool parse_udp_url_into(const std::string& url, UdpUrlParts& out)
     {
-        if (!has_prefix(url, "udp://")) return std::nullopt;
+        if (!has_prefix(url, "udp://")) return false;
 
         // Strip scheme
         const std::string_view rest(url.c_str() + 6, url.size() - 6);
@@ -24,32 +24,53 @@ namespace bittorrent::tracker::detail {
         size_t slash = rest.find('/');
         std::string_view hostport = (slash == std::string_view::npos) ? rest : rest.substr(0, slash);
 
-        if (hostport.empty()) return std::nullopt;
+        if (hostport.empty()) return false;
 
-        // NOTE: This minimal parser does not implement bracketed IPv6 literals.
-        size_t colon = hostport.rfind(':');
-        std::string host;
+        std::string& host = out.host;
+        std::string_view port_sv;   // empty => default port
         uint16_t port = 6969; // common default for trackers
 
-        if (colon != std::string_view::npos) {
-            host = std::string(hostport.substr(0, colon));
-            std::string_view port_sv = hostport.substr(colon + 1);
-            if (!port_sv.empty()) {
-                unsigned long p = 0;
-                for (char ch : port_sv) {
-                    if (!std::isdigit(static_cast<unsigned char>(ch))) { p = 0; break; }
-                    p = p * 10 + (ch - '0');
-                    if (p > 65535) { p = 0; break; }
-                }
-                if (p == 0) return std::nullopt;
-                port = static_cast<uint16_t>(p);
+        if (hostport.front() == '[') {
+            // [v6-literal][:port]
+            const size_t close = hostport.find(']');
+            if (close == std::string_view::npos) return false;
+            host.assign(hostport.substr(1, close - 1));
+            std::string_view after = hostport.substr(close + 1);
+            if (!after.empty()) {
+                if (after.front() != ':') return false;
+                port_sv = after.substr(1);
             }
         } else {
-            host = std::string(hostport);
+            size_t colon = hostport.rfind(':');
+            if (colon != std::string_view::npos) {
+                host.assign(hostport.substr(0, colon));
+                port_sv = hostport.substr(colon + 1);
+            } else {
+                host.assign(hostport);
+            }
+        }
+
+        if (!port_sv.empty()) {
+            unsigned long p = 0;
+            for (char ch : port_sv) {
+                if (!std::isdigit(static_cast<unsigned char>(ch))) { p = 0; break; }
+                p = p * 10 + (ch - '0');
+                if (p > 65535) { p = 0; break; }
+            }
+            if (p == 0) return false;
+            port = static_cast<uint16_t>(p);
         }
 
-        if (host.empty()) return std::nullopt;
-        return UdpUrlParts{std::move(host), port};
+        if (host.empty()) return false;
+        out.port = port;
+        return true;
+    }
+
+    std::optional<UdpUrlParts> parse_udp_url_minimal(const std::string& url)
+    {
+        UdpUrlParts parts;
+        if (!parse_udp_url_into(url, parts)) return std::nullopt;
+        return parts;
     }
 
 } // namespace bittorrent::tracker::detail
@@ -0,0 +1,165 @@
+// Usage:
+//   ./bench_compact_peer [--peers N] [--iterations N]
+//
+// Decodes an N-peer compact "peers" blob (6-byte records) and "peers6" blob (18-byte records)
+// with the previous string-based decoder (kept here as the baseline: hand-rolled dotted quad /
+// inet_ntop into a std::string per peer) and with every CompactPeerCodec::Decoder this CPU
+// runs, reporting ns per peer and heap allocations per blob. The last column is the full
+// appendIPv4/appendIPv6 path into a reused vector (what the trackers call).
+// Outputs are cross-checked first (exit 1 on mismatch).
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../include/compact_peer_codec.hpp"
+
+using namespace bittorrent::tracker;
+using Clock = std::chrono::steady_clock;
+
+// --------------------- allocation counter ---------------------
+static std::atomic<std::uint64_t> g_allocs{0};
+
+void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// --------------------- baseline (previous PeerAddr decoder) ---------------------
+struct LegacyPeerAddr {
+    std::string ip;
+    std::uint16_t port{0};
+    std::optional<std::array<std::uint8_t,20>> peerId;
+};
+
+static std::size_t legacyFormatIPv4(const unsigned char* a, char* out) {
+    char* o = out;
+    for (int i = 0; i < 4; ++i) {
+        unsigned v = a[i];
+        if (v >= 100) { *o++ = static_cast<char>('0' + v / 100); v %= 100; *o++ = static_cast<char>('0' + v / 10); v %= 10; }
+        else if (v >= 10) { *o++ = static_cast<char>('0' + v / 10); v %= 10; }
+        *o++ = static_cast<char>('0' + v);
+        if (i != 3) *o++ = '.';
+    }
+    return static_cast<std::size_t>(o - out);
+}
+
+static std::vector<LegacyPeerAddr> legacyParseCompact(std::string_view raw, int elemBytes) {
+    std::vector<LegacyPeerAddr> out;
+    const std::size_t n = raw.size() / elemBytes;
+    out.reserve(n);
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(raw.data());
+    for (std::size_t i = 0; i < n; ++i) {
+        LegacyPeerAddr pa;
+        char buf[INET6_ADDRSTRLEN] = {0};
+        std::uint16_t port;
+        if (elemBytes == 6) {
+            pa.ip.assign(buf, legacyFormatIPv4(p + i * 6, buf));
+            std::memcpy(&port, p + i * 6 + 4, 2);
+        } else {
+            if (!inet_ntop(AF_INET6, p + i * 18, buf, sizeof(buf))) continue;
+            pa.ip = buf;
+            std::memcpy(&port, p + i * 18 + 16, 2);
+        }
+        pa.port = ntohs(port);
+        out.push_back(std::move(pa));
+    }
+    return out;
+}
+
+// --------------------- harness ---------------------
+static std::size_t g_sink = 0;
+
+struct Result { double nsPerPeer; double allocs; };
+
+template <typename Fn>
+static Result run(std::size_t iterations, std::size_t peers, Fn&& fn) {
+    const auto a0 = g_allocs.load();
+    const auto t0 = Clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) g_sink += fn();
+    const auto t1 = Clock::now();
+    const auto a1 = g_allocs.load();
+    return {std::chrono::duration<double, std::nano>(t1 - t0).count() / double(iterations * peers),
+            static_cast<double>(a1 - a0) / double(iterations)};
+}
+
+static void cell(const Result& r) {
+    std::cout << std::setw(9) << std::setprecision(2) << r.nsPerPeer << " ns"
+              << std::setw(6) << std::setprecision(0) << r.allocs << " al";
+}
+
+int main(int argc, char** argv) {
+    std::size_t peers = 200, iterations = 20000;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--peers" && i + 1 < argc) peers = std::stoul(argv[++i]);
+        else if (a == "--iterations" && i + 1 < argc) iterations = std::stoul(argv[++i]);
+        else { std::cerr << "unknown option " << a << "\n"; return 2; }
+    }
+    if (peers == 0) peers = 1;
+
+    std::string blob4(peers * 6, '\0'), blob6(peers * 18, '\0');
+    for (std::size_t i = 0; i < blob6.size(); ++i) blob6[i] = static_cast<char>((i * 2654435761u) >> 13);
+    for (std::size_t i = 0; i < blob4.size(); ++i) blob4[i] = blob6[i * 3];
+    const auto* in4 = reinterpret_cast<const std::uint8_t*>(blob4.data());
+    const auto* in6 = reinterpret_cast<const std::uint8_t*>(blob6.data());
+
+    // Cross-check: every decoder gives the baseline's text and port for every peer.
+    const auto& decoders = CompactPeerCodec::decoders();
+    {
+        const auto l4 = legacyParseCompact(blob4, 6), l6 = legacyParseCompact(blob6, 18);
+        std::vector<PeerEndpoint> e4(peers), e6(peers);
+        for (const auto& d : decoders) {
+            d.v4(in4, peers, e4.data());
+            d.v6(in6, peers, e6.data());
+            for (std::size_t i = 0; i < peers; ++i) {
+                if (e4[i].ip() != l4[i].ip || e4[i].port() != l4[i].port ||
+                    e6[i].ip() != l6[i].ip || e6[i].port() != l6[i].port) {
+                    std::cerr << d.name << ": mismatch at peer " << i << "\n";
+                    return 1;
+                }
+            }
+        }
+    }
+
+    std::cout << peers << " peers/blob, " << iterations << " iterations\n"
+              << std::left << std::setw(8) << "" << std::right << std::setw(20) << "string baseline";
+    for (const auto& d : decoders) std::cout << std::setw(20) << d.name;
+    std::cout << std::setw(20) << "append (" << CompactPeerCodec::decoder().name << ")\n" << std::fixed;
+
+    std::vector<PeerEndpoint> scratch(peers), reused;
+    for (int fam = 0; fam < 2; ++fam) {
+        const bool v6 = fam == 1;
+        const std::string& blob = v6 ? blob6 : blob4;
+        const auto* in = v6 ? in6 : in4;
+
+        std::cout << std::left << std::setw(8) << (v6 ? "peers6" : "peers") << std::right;
+        cell(run(iterations, peers, [&] { return legacyParseCompact(blob, v6 ? 18 : 6).size(); }));
+        for (const auto& d : decoders) {
+            cell(run(iterations, peers, [&] {
+                (v6 ? d.v6 : d.v4)(in, peers, scratch.data());
+                return std::size_t(scratch[peers - 1].portBE[1]);
+            }));
+        }
+        cell(run(iterations, peers, [&] {
+            reused.clear();
+            return v6 ? CompactPeerCodec::appendIPv6(blob, reused) : CompactPeerCodec::appendIPv4(blob, reused);
+        }));
+        std::cout << "\n";
+    }
+
+    return g_sink == 0 ? 1 : 0;
+}
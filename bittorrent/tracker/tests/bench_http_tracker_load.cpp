@@ -0,0 +1,297 @@
+// Usage:
+//   ./bench_http_tracker_load [--announces N] [--mode all|oneshot|multi|async] [--threads T]
+//                             [--window W] [--latency-ms L] [--jitter-ms J] [--peers P]
+//                             [--peers6 P6] [--compact 0|1] [--redirects R] [--body-bytes B]
+//                             [--failure F] [--host-connections H] [--compress 0|1]
+//
+// End-to-end HTTP announce benchmark against a FakeHttpTracker: every announce goes
+// through HttpTracker (URL building, bencode parsing) over the real curl clients.
+//   oneshot : makeCurlClient(nullptr), T threads calling announce() (one easy handle per request)
+//   multi   : makeCurlMultiClient(nullptr, cfg), T threads calling announce()
+//   async   : makeCurlMultiClient(nullptr, cfg), one thread keeping W announceAsync() calls in flight
+// The multi client caps connections per host (CurlMultiConfig::maxHostConnections, default 8)
+// and every announce here targets one host, so throughput is bounded by H / latency;
+// --host-connections raises the cap to compare. --compress 1 has the stand-in gzip its replies
+// (the clients always advertise Accept-Encoding); compare the stand-in's bytes out.
+// Reports announces/s, latency percentiles, heap allocations per announce (operator new on
+// client threads, and libcurl's own mallocs via curl_global_init_mem) and client CPU time
+// per announce (the stand-in's thread excluded).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "../include/http_tracker.hpp"
+#include "fake_http_server.hpp"
+
+using namespace bittorrent::tracker;
+using Clock = std::chrono::steady_clock;
+
+// --------------------- allocation counters ---------------------
+static std::atomic<uint64_t> g_news{0};
+static std::atomic<uint64_t> g_curlAllocs{0};
+static thread_local bool tl_uncounted = false;     // set on the stand-in's thread
+
+void* operator new(std::size_t n) {
+    if (!tl_uncounted) g_news.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static void* curlMalloc(size_t n) { g_curlAllocs.fetch_add(1, std::memory_order_relaxed); return std::malloc(n); }
+static void curlFree(void* p) { std::free(p); }
+static void* curlRealloc(void* p, size_t n) {
+    if (!p) g_curlAllocs.fetch_add(1, std::memory_order_relaxed);
+    return std::realloc(p, n);
+}
+static char* curlStrdup(const char* s) { g_curlAllocs.fetch_add(1, std::memory_order_relaxed); return ::strdup(s); }
+static void* curlCalloc(size_t n, size_t sz) { g_curlAllocs.fetch_add(1, std::memory_order_relaxed); return std::calloc(n, sz); }
+
+// --------------------- options ---------------------
+struct Options {
+    std::size_t announces{5000};
+    std::string mode{"all"};
+    unsigned threads{16};
+    std::size_t window{64};
+    double latencyMs{2};
+    double jitterMs{2};
+    std::size_t peers{50};
+    std::size_t peers6{0};
+    bool compact{true};
+    unsigned redirects{0};
+    std::size_t bodyBytes{0};
+    double failure{0.0};
+    std::size_t hostConnections{CurlMultiConfig{}.maxHostConnections};
+    bool compress{false};
+};
+
+static Options parseArgs(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) { std::cerr << a << " needs a value\n"; std::exit(2); }
+            return argv[++i];
+        };
+        if (a == "--announces") o.announces = std::stoul(next());
+        else if (a == "--mode") o.mode = next();
+        else if (a == "--threads") o.threads = static_cast<unsigned>(std::stoul(next()));
+        else if (a == "--window") o.window = std::stoul(next());
+        else if (a == "--latency-ms") o.latencyMs = std::stod(next());
+        else if (a == "--jitter-ms") o.jitterMs = std::stod(next());
+        else if (a == "--peers") o.peers = std::stoul(next());
+        else if (a == "--peers6") o.peers6 = std::stoul(next());
+        else if (a == "--compact") o.compact = next() != "0";
+        else if (a == "--redirects") o.redirects = static_cast<unsigned>(std::stoul(next()));
+        else if (a == "--body-bytes") o.bodyBytes = std::stoul(next());
+        else if (a == "--failure") o.failure = std::stod(next());
+        else if (a == "--host-connections") o.hostConnections = std::stoul(next());
+        else if (a == "--compress") o.compress = next() != "0";
+        else { std::cerr << "unknown option " << a << "\n"; std::exit(2); }
+    }
+    if (o.threads == 0) o.threads = 1;
+    if (o.window == 0) o.window = 1;
+    return o;
+}
+
+static double processCpuSeconds() {
+    timespec ts{};
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return double(ts.tv_sec) + double(ts.tv_nsec) / 1e9;
+}
+
+static AnnounceRequest makeRequest(std::size_t i, bool compact) {
+    AnnounceRequest req{};
+    for (std::size_t b = 0; b < req.infoHash.bytes.size(); ++b) req.infoHash.bytes[b] = static_cast<uint8_t>(i >> (8 * (b % 4)));
+    req.peerId.bytes.fill(0x2D);
+    req.port = 51413;
+    req.left = 1;
+    req.numwant = 50;
+    req.compact = compact;
+    return req;
+}
+
+// --------------------- runs ---------------------
+struct Result {
+    std::vector<double> latMs;      // successful announces
+    std::size_t failed{0};
+    double wallSec{0};
+    double clientCpuSec{0};
+    uint64_t news{0};
+    uint64_t curlAllocs{0};
+};
+
+struct Meter {
+    double cpu0, stand0;
+    uint64_t news0, curl0;
+    Clock::time_point t0;
+    const FakeHttpTracker& srv;
+
+    explicit Meter(const FakeHttpTracker& s)
+        : cpu0(processCpuSeconds()), stand0(s.cpuSeconds()), news0(g_news.load()), curl0(g_curlAllocs.load()),
+          t0(Clock::now()), srv(s) {}
+
+    void finish(Result& r) const {
+        r.wallSec = std::chrono::duration<double>(Clock::now() - t0).count();
+        r.clientCpuSec = (processCpuSeconds() - cpu0) - (srv.cpuSeconds() - stand0);
+        r.news = g_news.load() - news0;
+        r.curlAllocs = g_curlAllocs.load() - curl0;
+    }
+};
+
+static Result runThreads(const Options& o, const FakeHttpTracker& srv, std::shared_ptr<IHttpClient> client) {
+    HttpTracker tracker(std::move(client));
+    const std::string url = srv.url();
+    (void)tracker.announce(makeRequest(0, o.compact), url);     // connection and handle warm-up
+
+    Result r;
+    r.latMs.reserve(o.announces);
+    std::mutex mu;
+    std::atomic<std::size_t> next{0};
+
+    Meter m(srv);
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < o.threads; ++t) {
+        pool.emplace_back([&] {
+            for (std::size_t i; (i = next.fetch_add(1)) < o.announces;) {
+                const auto sent = Clock::now();
+                auto res = tracker.announce(makeRequest(i, o.compact), url);
+                const double ms = std::chrono::duration<double, std::milli>(Clock::now() - sent).count();
+                std::lock_guard<std::mutex> lk(mu);
+                if (res.has_value()) r.latMs.push_back(ms);
+                else ++r.failed;
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    m.finish(r);
+    return r;
+}
+
+static std::shared_ptr<IHttpClient> multiClient(const Options& o) {
+    CurlMultiConfig cfg;
+    cfg.maxHostConnections = o.hostConnections;
+    cfg.maxTotalConnections = std::max(cfg.maxTotalConnections, o.hostConnections);
+    return makeCurlMultiClient(nullptr, cfg);
+}
+
+static Result runAsync(const Options& o, const FakeHttpTracker& srv) {
+    HttpTracker tracker(multiClient(o));
+    const std::string url = srv.url();
+    (void)tracker.announce(makeRequest(0, o.compact), url);
+
+    Result r;
+    r.latMs.reserve(o.announces);
+    std::mutex mu;
+    std::condition_variable cv;
+    std::size_t done = 0;   // guarded by mu
+
+    Meter m(srv);
+    for (std::size_t i = 0; i < o.announces; ++i) {
+        {
+            std::unique_lock<std::mutex> lk(mu);
+            cv.wait(lk, [&] { return i - done < o.window; });
+        }
+        const auto sent = Clock::now();
+        tracker.announceAsync(makeRequest(i, o.compact), url, [&, sent](Expected<AnnounceResponse> res) {
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - sent).count();
+            {
+                std::lock_guard<std::mutex> lk(mu);
+                if (res.has_value()) r.latMs.push_back(ms);
+                else ++r.failed;
+                ++done;
+            }
+            cv.notify_one();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lk(mu);
+        cv.wait(lk, [&] { return done == o.announces; });
+    }
+    m.finish(r);
+    return r;
+}
+
+static void report(const std::string& name, Result& r, std::size_t total) {
+    std::sort(r.latMs.begin(), r.latMs.end());
+    auto pct = [&](double p) {
+        if (r.latMs.empty()) return 0.0;
+        return r.latMs[std::min(r.latMs.size() - 1, static_cast<std::size_t>(p * r.latMs.size()))];
+    };
+    std::cout << std::left << std::setw(9) << name << std::right << std::fixed
+              << std::setw(8) << total
+              << std::setw(8) << r.failed
+              << std::setw(10) << std::setprecision(0) << double(total) / r.wallSec
+              << std::setw(9) << std::setprecision(2) << pct(0.50)
+              << std::setw(9) << pct(0.99)
+              << std::setw(9) << (r.latMs.empty() ? 0.0 : r.latMs.back())
+              << std::setw(9) << std::setprecision(1) << double(r.news) / double(total)
+              << std::setw(10) << double(r.curlAllocs) / double(total)
+              << std::setw(12) << r.clientCpuSec * 1e6 / double(total) << "\n";
+}
+
+int main(int argc, char** argv) {
+    const Options o = parseArgs(argc, argv);
+    curl_global_init_mem(CURL_GLOBAL_DEFAULT, curlMalloc, curlFree, curlRealloc, curlStrdup, curlCalloc);
+
+    FakeHttpTrackerConfig cfg;
+    cfg.latency = std::chrono::microseconds(static_cast<int64_t>(o.latencyMs * 1000));
+    cfg.jitter = std::chrono::microseconds(static_cast<int64_t>(o.jitterMs * 1000));
+    cfg.peers = o.peers;
+    cfg.peers6 = o.peers6;
+    cfg.failureRate = o.failure;
+    cfg.redirectHops = o.redirects;
+    cfg.minBodyBytes = o.bodyBytes;
+    cfg.compress = o.compress;
+    cfg.onThreadStart = [] { tl_uncounted = true; };
+    FakeHttpTracker srv(cfg);
+    if (!srv.start()) {
+        std::cerr << "stand-in: bind failed\n";
+        return 1;
+    }
+
+    std::cout << o.announces << " announces, latency " << o.latencyMs << "+[0," << o.jitterMs << ") ms, "
+              << o.peers << (o.compact ? " compact" : " dict") << " peers + " << o.peers6 << " peers6, "
+              << o.redirects << " redirects, failure " << o.failure << ", threads " << o.threads
+              << ", async window " << o.window << ", host connections " << o.hostConnections << "\n";
+    std::cout << std::left << std::setw(9) << "client" << std::right
+              << std::setw(8) << "total" << std::setw(8) << "failed" << std::setw(10) << "ann/s"
+              << std::setw(9) << "p50 ms" << std::setw(9) << "p99" << std::setw(9) << "max"
+              << std::setw(9) << "new/ann" << std::setw(10) << "curl/ann" << std::setw(12) << "cpu us/ann" << "\n";
+
+    const bool all = o.mode == "all";
+    if (all || o.mode == "oneshot") {
+        auto r = runThreads(o, srv, makeCurlClient(nullptr));
+        report("oneshot", r, o.announces);
+    }
+    if (all || o.mode == "multi") {
+        auto r = runThreads(o, srv, multiClient(o));
+        report("multi", r, o.announces);
+    }
+    if (all || o.mode == "async") {
+        auto r = runAsync(o, srv);
+        report("async", r, o.announces);
+    }
+
+    const auto c = srv.counters();
+    std::cout << "stand-in: " << c.connections << " connections, " << c.requests << " requests, "
+              << c.bytesOut / 1024 << " KiB out (" << c.bodyBytes / 1024 << " KiB of bodies, "
+              << c.compressed << " compressed)\n";
+    return 0;
+}
@@ -0,0 +1,188 @@
+// Usage:
+//   ./bench_peer_queue [--producers P]... [--batches N] [--batch-size B] [--capacity C]
+//
+// Peer delivery under producer contention. P producer threads (default 1, 2, 4, 8; think
+// announce replies, DHT and PEX) each hand N batches (default 100000) of B peers (default 16)
+// to one consumer thread that feeds a PeerPool and drains it, as the peer layer does with
+// TrackerManager::drainNewPeers(). Two models:
+//   - mutex: producers lock the pool and add to it (the previous peersMu_ path);
+//   - mpsc:  producers push onto a PeerBatchQueue of C batches (default 256) and retry after
+//            a yield when it is full; the consumer pops and adds.
+// Reports producer throughput, push latency (every 16th push) and, for the queue, how many
+// pushes were refused by back-pressure.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/peer_pool.hpp"
+#include "../include/peer_queue.hpp"
+
+using namespace bittorrent::tracker;
+using Clock = std::chrono::steady_clock;
+using Nanos = std::chrono::duration<double, std::nano>;
+
+struct Options {
+    std::vector<std::size_t> producers;
+    std::size_t batches{100000};
+    std::size_t batchSize{16};
+    std::size_t capacity{256};
+};
+
+static Options parseArgs(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--producers" && i + 1 < argc) o.producers.push_back(std::stoul(argv[++i]));
+        else if (a == "--batches" && i + 1 < argc) o.batches = std::stoul(argv[++i]);
+        else if (a == "--batch-size" && i + 1 < argc) o.batchSize = std::stoul(argv[++i]);
+        else if (a == "--capacity" && i + 1 < argc) o.capacity = std::stoul(argv[++i]);
+        else { std::cerr << "unknown option " << a << "\n"; std::exit(2); }
+    }
+    if (o.producers.empty()) o.producers = {1, 2, 4, 8};
+    o.batches = std::max<std::size_t>(o.batches, 1);
+    o.batchSize = std::max<std::size_t>(o.batchSize, 1);
+    return o;
+}
+
+static std::vector<PeerEndpoint> makeBatch(std::size_t producer, std::size_t seq, std::size_t size) {
+    std::vector<PeerEndpoint> peers;
+    peers.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        const std::size_t n = seq * size + i;
+        const std::array<std::uint8_t, 4> ip{10, static_cast<std::uint8_t>(producer),
+                                             static_cast<std::uint8_t>(n >> 8), static_cast<std::uint8_t>(n)};
+        peers.push_back(PeerEndpoint::v4(ip.data(), static_cast<std::uint16_t>(1024 + (n >> 16))));
+    }
+    return peers;
+}
+
+struct Row {
+    double seconds{0};
+    std::vector<double> latencyNs;
+    std::uint64_t refused{0};
+    std::uint64_t drained{0};
+};
+
+// Producers start together; each returns its sampled push latencies.
+template <typename Push>
+static Row runProducers(const Options& o, std::size_t producers, Push push, std::atomic<bool>& done) {
+    Row row;
+    std::vector<std::vector<double>> samples(producers);
+    std::atomic<std::size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (std::size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            // Batches are built up front so only the hand-over is measured.
+            std::vector<std::vector<PeerEndpoint>> batches;
+            batches.reserve(o.batches);
+            for (std::size_t i = 0; i < o.batches; ++i) batches.push_back(makeBatch(p, i, o.batchSize));
+            samples[p].reserve(o.batches / 16 + 1);
+            ++ready;
+            while (!go) std::this_thread::yield();
+            for (std::size_t i = 0; i < o.batches; ++i) {
+                if (i % 16 == 0) {
+                    const auto t0 = Clock::now();
+                    push(std::move(batches[i]));
+                    samples[p].push_back(Nanos(Clock::now() - t0).count());
+                } else {
+                    push(std::move(batches[i]));
+                }
+            }
+        });
+    }
+    while (ready < producers) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const auto t0 = Clock::now();
+    go = true;
+    for (auto& t : threads) t.join();
+    row.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    done = true;
+    for (auto& s : samples) row.latencyNs.insert(row.latencyNs.end(), s.begin(), s.end());
+    return row;
+}
+
+static Row runMutex(const Options& o, std::size_t producers) {
+    PeerPool pool;
+    std::mutex mu;
+    std::atomic<bool> done{false};
+    std::uint64_t drained = 0;
+
+    std::thread consumer([&] {
+        while (!done) {
+            std::scoped_lock lk(mu);
+            drained += pool.drainNew().size();
+        }
+    });
+    Row row = runProducers(o, producers, [&](std::vector<PeerEndpoint>&& peers) {
+        std::vector<PeerEndpoint> fresh;
+        std::scoped_lock lk(mu);
+        pool.add(peers, PeerSource::tracker, Clock::now(), &fresh);
+    }, done);
+    consumer.join();
+    row.drained = drained;
+    return row;
+}
+
+static Row runQueue(const Options& o, std::size_t producers) {
+    PeerPool pool;
+    PeerBatchQueue queue(o.capacity);
+    std::atomic<bool> done{false};
+    std::uint64_t drained = 0;
+
+    std::thread consumer([&] {
+        PeerBatch batch;
+        for (;;) {
+            const bool finished = done.load();
+            while (queue.tryPop(batch)) pool.add(batch.peers, batch.source, Clock::now());
+            drained += pool.drainNew().size();
+            if (finished) break;
+            if (queue.park()) std::this_thread::yield();
+        }
+    });
+    Row row = runProducers(o, producers, [&](std::vector<PeerEndpoint>&& peers) {
+        PeerBatch batch{PeerSource::tracker, std::move(peers)};
+        while (queue.tryPush(std::move(batch)) == PeerBatchQueue::PushResult::full) std::this_thread::yield();
+    }, done);
+    consumer.join();
+    row.refused = queue.rejected();
+    row.drained = drained;
+    return row;
+}
+
+static void print(const char* model, std::size_t producers, const Options& o, Row r) {
+    std::sort(r.latencyNs.begin(), r.latencyNs.end());
+    auto at = [&](double q) {
+        return r.latencyNs[std::min(r.latencyNs.size() - 1, static_cast<std::size_t>(q * double(r.latencyNs.size())))];
+    };
+    const double batches = double(producers * o.batches);
+    std::cout << std::left << std::setw(8) << model << std::right
+              << std::setw(10) << producers
+              << std::setw(14) << std::fixed << std::setprecision(2) << batches / r.seconds / 1e6
+              << std::setw(11) << std::setprecision(0) << at(0.50)
+              << std::setw(11) << at(0.99)
+              << std::setw(12) << r.latencyNs.back()
+              << std::setw(12) << r.refused
+              << std::setw(12) << r.drained << "\n";
+}
+
+int main(int argc, char** argv) {
+    const Options o = parseArgs(argc, argv);
+    std::cout << std::left << std::setw(8) << "model" << std::right
+              << std::setw(10) << "producers" << std::setw(14) << "Mbatches/s"
+              << std::setw(11) << "p50 ns" << std::setw(11) << "p99 ns" << std::setw(12) << "max ns"
+              << std::setw(12) << "refused" << std::setw(12) << "drained" << "\n";
+    for (std::size_t p : o.producers) {
+        print("mutex", p, o, runMutex(o, p));
+        print("mpsc", p, o, runQueue(o, p));
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Usage:
+//   ./bench_tracker_first_peer [--runs R] [--rtt-ms T] [--dead-ms D]
+//
+// Time from start() to the first peer for a freshly added torrent, against an in-process
+// HTTP server. Live trackers answer after T ms (default 50) with one peer; dead ones hold
+// the request for D ms (default 5000, standing in for a connect/transfer timeout) and then
+// fail. Two announce lists:
+//   - dead tier:    {dead, dead}, {live}
+//   - dead tracker: {dead, live}
+// each under the sequential BEP 12 order ({false, 1}, the default), every tier at once
+// ({true, 1}) and every tier with two endpoints racing per tier ({true, 2}). Prints p50 and
+// max over R runs (default 5) in milliseconds.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/manager.hpp"
+#include "fake_http_server.hpp"
+
+using namespace bittorrent::tracker;
+using Clock = std::chrono::steady_clock;
+using Millis = std::chrono::duration<double, std::milli>;
+
+struct Options {
+    std::size_t runs{5};
+    int rttMs{50};
+    int deadMs{5000};
+};
+
+static Options parseArgs(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--runs" && i + 1 < argc) o.runs = std::stoul(argv[++i]);
+        else if (a == "--rtt-ms" && i + 1 < argc) o.rttMs = std::stoi(argv[++i]);
+        else if (a == "--dead-ms" && i + 1 < argc) o.deadMs = std::stoi(argv[++i]);
+        else { std::cerr << "unknown option " << a << "\n"; std::exit(2); }
+    }
+    o.runs = std::max<std::size_t>(o.runs, 1);
+    return o;
+}
+
+static InfoHash hashOf(std::size_t i) {
+    InfoHash ih{};
+    for (std::size_t b = 0; b < ih.bytes.size(); ++b) ih.bytes[b] = static_cast<std::uint8_t>(i >> (8 * (b % 4)));
+    return ih;
+}
+
+// One run: start a manager, wait for its first peer (or give up after a minute).
+static double firstPeerMs(const std::vector<std::vector<std::string>>& list, TrackerManagerConfig cfg,
+                          std::shared_ptr<IHttpClient> http, std::size_t run) {
+    std::atomic<Clock::rep> firstAt{0};
+    TrackerManager mgr(list, hashOf(run), PeerID{}, 51413, std::move(http), nullptr, cfg);
+    mgr.setPeersReadyCallback([&] {
+        Clock::rep none = 0;
+        firstAt.compare_exchange_strong(none, Clock::now().time_since_epoch().count());
+    });
+
+    const auto t0 = Clock::now();
+    mgr.announce(AnnounceEvent::started);
+    mgr.start();
+    while (firstAt.load() == 0 && Clock::now() - t0 < std::chrono::seconds(60)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    mgr.stop();
+    if (firstAt.load() == 0) return -1;
+    return Millis(Clock::time_point(Clock::duration(firstAt.load())) - t0).count();
+}
+
+static void report(const char* layout, const char* mode, std::vector<double> ms) {
+    std::sort(ms.begin(), ms.end());
+    std::cout << std::left << std::setw(14) << layout << std::setw(22) << mode << std::right
+              << std::fixed << std::setprecision(1)
+              << std::setw(12) << ms[ms.size() / 2] << std::setw(12) << ms.back()
+              << (ms.front() < 0 ? "  (no peer within 60 s)" : "") << "\n";
+}
+
+int main(int argc, char** argv) {
+    const Options o = parseArgs(argc, argv);
+
+    FakeHttpServer srv([&](const std::string& target) {
+        if (target.rfind("/dead", 0) == 0) return FakeHttpReply{503, "", std::chrono::milliseconds(o.deadMs)};
+        // d8:intervali1800e5:peers6:<10.0.0.1:6881>e
+        return FakeHttpReply{200, std::string("d8:intervali1800e5:peers6:\x0a\x00\x00\x01\x1a\xe1" "e", 33),
+                             std::chrono::milliseconds(o.rttMs)};
+    });
+    if (!srv.start()) return 1;
+    auto http = makeCurlMultiClient(nullptr, {});
+
+    const std::vector<std::pair<const char*, std::vector<std::vector<std::string>>>> layouts{
+        {"dead tier", {{srv.url("/dead1/announce"), srv.url("/dead2/announce")}, {srv.url("/live/announce")}}},
+        {"dead tracker", {{srv.url("/dead1/announce"), srv.url("/live/announce")}}},
+    };
+    const std::vector<std::pair<const char*, TrackerManagerConfig>> modes{
+        {"sequential {false,1}", {false, 1}},
+        {"all tiers {true,1}", {true, 1}},
+        {"all + race {true,2}", {true, 2}},
+    };
+
+    std::cout << std::left << std::setw(14) << "layout" << std::setw(22) << "mode" << std::right
+              << std::setw(12) << "p50 ms" << std::setw(12) << "max ms" << "\n";
+    std::size_t run = 0;
+    for (auto const& [name, list] : layouts) {
+        for (auto const& [mode, cfg] : modes) {
+            std::vector<double> ms;
+            for (std::size_t r = 0; r < o.runs; ++r) ms.push_back(firstPeerMs(list, cfg, http, run++));
+            report(name, mode, ms);
+        }
+    }
+    return 0;
+}
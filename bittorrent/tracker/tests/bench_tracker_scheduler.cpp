@@ -0,0 +1,225 @@
+// Usage:
+//   ./bench_tracker_scheduler [--torrents N]... [--threads T] [--idle-seconds S] [--baseline]
+//
+// Starts N TrackerManagers (two single-tracker tiers each, announced together with
+// TrackerManagerConfig{true, 1}) on one TrackerScheduler with T pool threads, against an
+// in-process HTTP client that answers every announce at once (interval 1800, one compact
+// peer). Reports, per N (default 1000, 10000, 100000):
+//   - threads and resident memory added per torrent once every torrent is running,
+//   - wall and CPU time until every torrent has announced to both tiers,
+//   - CPU burned while all of them sit idle for S seconds (default 3),
+//   - how long stopping and destroying them takes.
+// --baseline adds the same numbers for the previous model, a thread per torrent that
+// announces once per tier and then sleeps in 1 s steps (the old worker's floor); thread
+// creation failures are reported rather than fatal.
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "../include/manager.hpp"
+
+using namespace bittorrent::tracker;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::vector<std::size_t> torrents;
+    std::size_t threads{4};
+    double idleSeconds{3};
+    bool baseline{false};
+};
+
+static Options parseArgs(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--torrents" && i + 1 < argc) o.torrents.push_back(std::stoul(argv[++i]));
+        else if (a == "--threads" && i + 1 < argc) o.threads = std::stoul(argv[++i]);
+        else if (a == "--idle-seconds" && i + 1 < argc) o.idleSeconds = std::stod(argv[++i]);
+        else if (a == "--baseline") o.baseline = true;
+        else { std::cerr << "unknown option " << a << "\n"; std::exit(2); }
+    }
+    if (o.torrents.empty()) o.torrents = {1000, 10000, 100000};
+    return o;
+}
+
+// --------------------- process probes ---------------------
+static double cpuSeconds() {
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return double(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) + double(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static std::size_t residentBytes() {
+    std::ifstream f("/proc/self/statm");
+    std::size_t size = 0, resident = 0;
+    f >> size >> resident;
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+static std::size_t threadCount() {
+    std::ifstream f("/proc/self/status");
+    for (std::string line; std::getline(f, line);) {
+        if (line.rfind("Threads:", 0) == 0) return std::stoul(line.substr(8));
+    }
+    return 0;
+}
+
+// --------------------- instant tracker ---------------------
+struct InstantHttpClient : IHttpClient {
+    std::atomic<std::uint64_t> calls{0};
+
+    Expected<HttpResponse> get(const std::string&, int, int, bool) override {
+        const auto n = calls.fetch_add(1, std::memory_order_relaxed);
+        std::string body = "d8:intervali1800e5:peers6:";
+        for (int i = 0; i < 4; ++i) body.push_back(static_cast<char>(n >> (8 * i)));
+        body += "\x1a\xe1" "e";
+        return Expected<HttpResponse>::success(HttpResponse{200, std::move(body)});
+    }
+};
+
+static InfoHash hashOf(std::size_t i) {
+    InfoHash ih{};
+    for (std::size_t b = 0; b < ih.bytes.size(); ++b) ih.bytes[b] = static_cast<std::uint8_t>(i >> (8 * (b % 4)));
+    return ih;
+}
+
+static const std::vector<std::vector<std::string>> kAnnounceList{
+    {"http://tracker-a.example/announce"}, {"http://tracker-b.example/announce"}};
+
+struct Row {
+    std::size_t threads{0};
+    double bytesPerTorrent{0};
+    double startMs{0}, startCpuMs{0};
+    double idleCpuPct{0};
+    double stopMs{0};
+    std::string note;
+};
+
+static void waitForCalls(const InstantHttpClient& http, std::uint64_t target) {
+    const auto deadline = Clock::now() + std::chrono::seconds(120);
+    while (http.calls.load() < target && Clock::now() < deadline) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+static Row runScheduler(std::size_t n, const Options& o) {
+    Row row;
+    auto http = std::make_shared<InstantHttpClient>();
+    PeerID pid{};
+
+    const auto rss0 = residentBytes();
+    const auto thr0 = threadCount();
+    const double cpu0 = cpuSeconds();
+    const auto t0 = Clock::now();
+
+    auto sched = std::make_shared<TrackerScheduler>(TrackerSchedulerConfig{o.threads});
+
+    std::vector<std::unique_ptr<TrackerManager>> mgrs;
+    mgrs.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        mgrs.push_back(std::make_unique<TrackerManager>(kAnnounceList, hashOf(i), pid, 51413, http, sched,
+                                                         TrackerManagerConfig{true, 1}));
+        mgrs.back()->start();
+    }
+    waitForCalls(*http, 2 * n);
+    row.startMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    row.startCpuMs = (cpuSeconds() - cpu0) * 1e3;
+    if (http->calls.load() < 2 * n) row.note = "announces incomplete";
+
+    row.threads = threadCount() - thr0;
+    row.bytesPerTorrent = double(residentBytes() - rss0) / double(n);
+
+    const double idle0 = cpuSeconds();
+    std::this_thread::sleep_for(std::chrono::duration<double>(o.idleSeconds));
+    row.idleCpuPct = (cpuSeconds() - idle0) / o.idleSeconds * 100.0;
+
+    const auto s0 = Clock::now();
+    for (auto& m : mgrs) m->stop();
+    mgrs.clear();
+    row.stopMs = std::chrono::duration<double, std::milli>(Clock::now() - s0).count();
+    return row;
+}
+
+// The previous model: one thread per torrent, announcing to each tier, then sleeping.
+static Row runBaseline(std::size_t n, const Options& o) {
+    Row row;
+    auto http = std::make_shared<InstantHttpClient>();
+    auto tracker = std::make_shared<HttpTracker>(http);
+    std::atomic<bool> running{true};
+
+    const auto rss0 = residentBytes();
+    const auto thr0 = threadCount();
+    const double cpu0 = cpuSeconds();
+    const auto t0 = Clock::now();
+
+    std::vector<std::thread> workers;
+    workers.reserve(n);
+    try {
+        for (std::size_t i = 0; i < n; ++i) {
+            workers.emplace_back([&, i] {
+                AnnounceRequest req{};
+                req.infoHash = hashOf(i);
+                req.port = 51413;
+                req.compact = true;
+                for (auto const& tier : kAnnounceList) (void)tracker->announce(req, tier.front());
+                while (running.load()) std::this_thread::sleep_for(std::chrono::seconds(1));
+            });
+        }
+    } catch (const std::system_error& e) {
+        row.note = "thread " + std::to_string(workers.size()) + ": " + e.what();
+    }
+    waitForCalls(*http, 2 * workers.size());
+    row.startMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    row.startCpuMs = (cpuSeconds() - cpu0) * 1e3;
+    row.threads = threadCount() - thr0;
+    row.bytesPerTorrent = double(residentBytes() - rss0) / double(std::max<std::size_t>(workers.size(), 1));
+
+    const double idle0 = cpuSeconds();
+    std::this_thread::sleep_for(std::chrono::duration<double>(o.idleSeconds));
+    row.idleCpuPct = (cpuSeconds() - idle0) / o.idleSeconds * 100.0;
+
+    const auto s0 = Clock::now();
+    running = false;
+    for (auto& t : workers) t.join();
+    row.stopMs = std::chrono::duration<double, std::milli>(Clock::now() - s0).count();
+    return row;
+}
+
+static void print(const char* model, std::size_t n, const Row& r) {
+    std::cout << std::left << std::setw(18) << model << std::right
+              << std::setw(9) << n
+              << std::setw(9) << r.threads
+              << std::setw(12) << std::fixed << std::setprecision(0) << r.bytesPerTorrent
+              << std::setw(11) << std::setprecision(1) << r.startMs
+              << std::setw(11) << r.startCpuMs
+              << std::setw(10) << std::setprecision(2) << r.idleCpuPct
+              << std::setw(10) << std::setprecision(1) << r.stopMs
+              << (r.note.empty() ? "" : "  (" + r.note + ")") << "\n";
+}
+
+int main(int argc, char** argv) {
+    const Options o = parseArgs(argc, argv);
+    (void)UdpTracker::sharedEngine();       // process-wide; keep it out of the first row
+
+    std::cout << std::left << std::setw(18) << "model" << std::right
+              << std::setw(9) << "torrents" << std::setw(9) << "threads" << std::setw(12) << "B/torrent"
+              << std::setw(11) << "start ms" << std::setw(11) << "start cpu" << std::setw(10) << "idle cpu%"
+              << std::setw(10) << "stop ms" << "\n";
+
+    const std::string label = "scheduler x" + std::to_string(o.threads);
+    for (std::size_t n : o.torrents) {
+        print(label.c_str(), n, runScheduler(n, o));
+        if (o.baseline) print("thread/torrent", n, runBaseline(n, o));
+    }
+    return 0;
+}
@@ -0,0 +1,199 @@
+// Usage:
+//   ./bench_tracker_wakeup [--torrents N] [--events K] [--stops M]
+//
+// Wake-up precision and shutdown of the scheduled announce path. Prints p50/p99/max for:
+//   - event latency: announce(completed) on one of N running torrents (default 1000) until
+//     the tracker sees the request, K times (default 2000), against an in-process client;
+//   - deadline lateness: how long after its due time each of K scheduler tasks starts,
+//     with deadlines spread over one second;
+//   - stop() latency for M torrents (default 20) that are idle, waiting on an HTTP tracker
+//     that holds its reply for 5 s, or on a UDP tracker that never answers;
+//   - the previous model for comparison: a worker sleeping in whole seconds, joined by stop().
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/manager.hpp"
+#include "fake_http_server.hpp"
+#include "fake_udp_tracker.hpp"
+
+using namespace bittorrent::tracker;
+using Clock = std::chrono::steady_clock;
+using Micros = std::chrono::duration<double, std::micro>;
+
+struct Options {
+    std::size_t torrents{1000};
+    std::size_t events{2000};
+    std::size_t stops{20};
+};
+
+static Options parseArgs(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--torrents" && i + 1 < argc) o.torrents = std::stoul(argv[++i]);
+        else if (a == "--events" && i + 1 < argc) o.events = std::stoul(argv[++i]);
+        else if (a == "--stops" && i + 1 < argc) o.stops = std::stoul(argv[++i]);
+        else { std::cerr << "unknown option " << a << "\n"; std::exit(2); }
+    }
+    o.torrents = std::max<std::size_t>(o.torrents, 1);
+    o.events = std::max<std::size_t>(o.events, 1);
+    o.stops = std::max<std::size_t>(o.stops, 1);
+    return o;
+}
+
+static void report(const char* what, std::vector<double> us) {
+    std::sort(us.begin(), us.end());
+    auto at = [&](double q) { return us[std::min(us.size() - 1, static_cast<std::size_t>(q * double(us.size())))]; };
+    std::cout << std::left << std::setw(34) << what << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << us.size()
+              << std::setw(12) << at(0.50) << std::setw(12) << at(0.99) << std::setw(12) << us.back() << "\n";
+}
+
+static InfoHash hashOf(std::size_t i) {
+    InfoHash ih{};
+    for (std::size_t b = 0; b < ih.bytes.size(); ++b) ih.bytes[b] = static_cast<std::uint8_t>(i >> (8 * (b % 4)));
+    return ih;
+}
+
+// Answers at once and timestamps every completed event it sees.
+struct StampingHttpClient : IHttpClient {
+    std::atomic<std::uint64_t> completed{0};
+    std::atomic<Clock::rep> lastCompleted{0};
+
+    Expected<HttpResponse> get(const std::string& url, int, int, bool) override {
+        if (url.find("event=completed") != std::string::npos) {
+            lastCompleted = Clock::now().time_since_epoch().count();
+            completed.fetch_add(1);
+        }
+        return Expected<HttpResponse>::success(HttpResponse{200, "d8:intervali1800ee"});
+    }
+};
+
+static void eventLatency(const Options& o) {
+    auto http = std::make_shared<StampingHttpClient>();
+    auto sched = std::make_shared<TrackerScheduler>();
+    const std::vector<std::vector<std::string>> list{{"http://t.example/announce"}};
+
+    std::vector<std::unique_ptr<TrackerManager>> mgrs;
+    for (std::size_t i = 0; i < o.torrents; ++i) {
+        mgrs.push_back(std::make_unique<TrackerManager>(list, hashOf(i), PeerID{}, 51413, http, sched));
+        mgrs.back()->start();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));    // let the first announces settle
+
+    std::vector<double> us;
+    us.reserve(o.events);
+    for (std::size_t k = 0; k < o.events; ++k) {
+        const auto before = http->completed.load();
+        const auto t0 = Clock::now();
+        mgrs[(k * 7919) % mgrs.size()]->announce(AnnounceEvent::completed);
+        while (http->completed.load() == before) std::this_thread::yield();
+        us.push_back(Micros(Clock::time_point(Clock::duration(http->lastCompleted.load())) - t0).count());
+    }
+    report(("event latency (" + std::to_string(o.torrents) + " torrents)").c_str(), us);
+    for (auto& m : mgrs) m->stop();
+}
+
+static void deadlineLateness(const Options& o) {
+    TrackerScheduler sched;
+    std::mutex mu;
+    std::vector<double> us;
+    us.reserve(o.events);
+
+    const auto t0 = Clock::now() + std::chrono::milliseconds(50);
+    for (std::size_t k = 0; k < o.events; ++k) {
+        const auto due = t0 + std::chrono::microseconds((k * 7919) % 1000000);
+        sched.add([&, due](Clock::time_point now) {
+            std::scoped_lock lk(mu);
+            us.push_back(Micros(now - due).count());
+            return Clock::time_point::max();
+        }, due);
+    }
+    while (sched.stats().runs < o.events) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    std::scoped_lock lk(mu);
+    report("deadline lateness (scheduler)", us);
+}
+
+template <typename MakeList, typename InFlight>
+static void stopLatency(const char* what, const Options& o, std::shared_ptr<IHttpClient> http,
+                        MakeList makeList, InFlight inFlight) {
+    std::vector<std::unique_ptr<TrackerManager>> mgrs;
+    for (std::size_t i = 0; i < o.stops; ++i) {
+        mgrs.push_back(std::make_unique<TrackerManager>(makeList(), hashOf(i), PeerID{}, 51413, http));
+        mgrs.back()->announce(AnnounceEvent::started);
+        mgrs.back()->start();
+    }
+    const auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (!inFlight() && Clock::now() < deadline) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<double> us;
+    for (auto& m : mgrs) {
+        const auto t0 = Clock::now();
+        m->stop();
+        us.push_back(Micros(Clock::now() - t0).count());
+    }
+    report(what, us);
+}
+
+// The previous worker: sleeps in whole seconds, so stop() waits for the sleep to run out.
+static void stopLatencyOldLoop(const Options& o) {
+    std::vector<double> us;
+    for (std::size_t i = 0; i < o.stops; ++i) {
+        std::atomic<bool> running{true};
+        std::thread worker([&] { while (running) std::this_thread::sleep_for(std::chrono::seconds(1)); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(37 * (i % 27)));
+        const auto t0 = Clock::now();
+        running = false;
+        worker.join();
+        us.push_back(Micros(Clock::now() - t0).count());
+    }
+    report("stop, idle (previous sleep loop)", us);
+}
+
+int main(int argc, char** argv) {
+    const Options o = parseArgs(argc, argv);
+    (void)UdpTracker::sharedEngine();
+
+    std::cout << std::left << std::setw(34) << "microseconds" << std::right << std::setw(8) << "n"
+              << std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "max" << "\n";
+
+    eventLatency(o);
+    deadlineLateness(o);
+
+    auto instant = std::make_shared<StampingHttpClient>();
+    stopLatency("stop, idle", o, instant,
+                [] { return std::vector<std::vector<std::string>>{{"http://t.example/announce"}}; },
+                [] { return true; });
+
+    std::atomic<std::size_t> httpHits{0};
+    FakeHttpServer slow([&](const std::string&) {
+        ++httpHits;
+        return FakeHttpReply{200, "d8:intervali1800ee", std::chrono::milliseconds(5000)};
+    });
+    if (!slow.start()) return 1;
+    stopLatency("stop, HTTP reply held 5 s", o, makeCurlMultiClient(nullptr, {}),
+                [&] { return std::vector<std::vector<std::string>>{{slow.url("/announce")}}; },
+                [&] { return httpHits.load() > 0; });
+
+    FakeUdpTrackerConfig silent;
+    silent.lossRate = 1.0;
+    FakeUdpTrackerServer udp(silent);
+    if (!udp.start()) return 1;
+    stopLatency("stop, UDP tracker silent", o, instant,
+                [&] { return std::vector<std::vector<std::string>>{{udp.url()}}; },
+                [&] { return udp.counters().received >= o.stops; });
+
+    stopLatencyOldLoop(o);
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Usage:
+//   ./bench_udp_engine [--announces N] [--window W] [--batch B]...
+//
+// Pushes N announces through one UdpTrackerEngine to a FakeUdpTrackerServer (no delay),
+// keeping at most W outstanding (so loopback socket buffers don't overflow), and
+// reports completed announces/s plus datagrams per syscall, once for each --batch
+// value (default: 1 and 32; 1 is the sendto/recvfrom path). The connection id is
+// cached before the clock starts, so every timed datagram is an announce.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/udp_engine.hpp"
+#include "fake_udp_tracker.hpp"
+
+using namespace bittorrent::tracker;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::size_t announces{50000};
+    std::size_t window{2048};
+    std::vector<std::size_t> batches;
+};
+
+static Options parseArgs(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--announces" && i + 1 < argc) o.announces = std::stoul(argv[++i]);
+        else if (a == "--window" && i + 1 < argc) o.window = std::stoul(argv[++i]);
+        else if (a == "--batch" && i + 1 < argc) o.batches.push_back(std::stoul(argv[++i]));
+        else { std::cerr << "unknown option " << a << "\n"; std::exit(2); }
+    }
+    if (o.batches.empty()) o.batches = {1, 32};
+    if (o.window == 0) o.window = 1;
+    return o;
+}
+
+static AnnounceRequest makeRequest(std::size_t i) {
+    AnnounceRequest req{};
+    for (std::size_t b = 0; b < req.infoHash.bytes.size(); ++b) req.infoHash.bytes[b] = static_cast<uint8_t>(i >> (8 * (b % 4)));
+    req.port = 51413;
+    req.left = 1;
+    req.numwant = 50;
+    return req;
+}
+
+int main(int argc, char** argv) {
+    const Options opt = parseArgs(argc, argv);
+
+    FakeUdpTrackerServer tracker;
+    if (!tracker.start()) {
+        std::cerr << "stand-in: bind failed\n";
+        return 1;
+    }
+    const std::string url = tracker.url();
+
+    std::cout << std::left << std::setw(8) << "batch" << std::setw(14) << "announces/s"
+              << std::setw(14) << "tx dgram/call" << std::setw(14) << "rx dgram/call"
+              << std::setw(12) << "retransmits" << "failed\n";
+
+    for (std::size_t batch : opt.batches) {
+        UdpEngineConfig cfg;
+        cfg.timeout = std::chrono::milliseconds(2000);
+        cfg.maxRetransmits = 2;
+        cfg.ioBatch = batch;
+        UdpTrackerEngine eng(cfg, std::make_shared<ConnectionIdCache>());
+        if (!eng.start().has_value()) return 1;
+
+        std::atomic<std::size_t> done{0}, failed{0};
+        auto cb = [&](Expected<AnnounceResponse> r) {
+            if (!r.has_value()) ++failed;
+            ++done;
+        };
+
+        // Warm-up: caches the connection id so the timed run is announce-only.
+        eng.announce(makeRequest(0), url, cb);
+        while (done.load() < 1) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        done = 0;
+        failed = 0;
+
+        const auto before = eng.ioStats();
+        const auto t0 = Clock::now();
+        for (std::size_t i = 0; i < opt.announces; ++i) {
+            while (i - done.load() >= opt.window) std::this_thread::yield();
+            eng.announce(makeRequest(i + 1), url, cb);
+        }
+        while (done.load() < opt.announces) std::this_thread::sleep_for(std::chrono::microseconds(200));
+        const double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+        const auto after = eng.ioStats();
+
+        const double txPer = double(after.datagramsSent - before.datagramsSent) / double(std::max<uint64_t>(1, after.sendCalls - before.sendCalls));
+        const double rxPer = double(after.datagramsReceived - before.datagramsReceived) / double(std::max<uint64_t>(1, after.recvCalls - before.recvCalls));
+        std::cout << std::left << std::setw(8) << batch
+                  << std::setw(14) << std::fixed << std::setprecision(0) << double(opt.announces) / secs
+                  << std::setw(14) << std::setprecision(1) << txPer
+                  << std::setw(14) << rxPer
+                  << std::setw(12) << (after.datagramsSent - before.datagramsSent) - opt.announces
+                  << failed.load() << "\n";
+    }
+    return 0;
+}
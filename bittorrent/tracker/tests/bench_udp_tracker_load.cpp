@@ -0,0 +1,246 @@
+// Usage:
+//   ./bench_udp_tracker_load [--torrents N] [--trackers M] [--mode engine|blocking|both]
+//                            [--threads T] [--window W] [--latency-ms L] [--jitter-ms J]
+//                            [--loss P] [--error P] [--peers K] [--timeout-ms R]
+//
+// Announces N torrents to each of M FakeUdpTrackerServer stand-ins (N x M announces)
+// and reports latency percentiles (submit -> result) and client CPU per announce
+// (process CPU minus the stand-ins' own threads).
+//   engine  : UdpTrackerEngine callbacks, at most W announces in flight
+//   blocking: T threads calling UdpTracker::announce() over the same kind of engine
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/udp_engine.hpp"
+#include "../include/udp_tracker.hpp"
+#include "fake_udp_tracker.hpp"
+
+using namespace bittorrent::tracker;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::size_t torrents{2000};
+    std::size_t trackers{4};
+    std::string mode{"both"};
+    unsigned threads{64};
+    std::size_t window{1024};
+    double latencyMs{5};
+    double jitterMs{5};
+    double loss{0.0};
+    double error{0.0};
+    std::size_t peers{50};
+    int timeoutMs{250};
+};
+
+static Options parseArgs(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) { std::cerr << a << " needs a value\n"; std::exit(2); }
+            return argv[++i];
+        };
+        if (a == "--torrents") o.torrents = std::stoul(next());
+        else if (a == "--trackers") o.trackers = std::stoul(next());
+        else if (a == "--mode") o.mode = next();
+        else if (a == "--threads") o.threads = static_cast<unsigned>(std::stoul(next()));
+        else if (a == "--window") o.window = std::stoul(next());
+        else if (a == "--latency-ms") o.latencyMs = std::stod(next());
+        else if (a == "--jitter-ms") o.jitterMs = std::stod(next());
+        else if (a == "--loss") o.loss = std::stod(next());
+        else if (a == "--error") o.error = std::stod(next());
+        else if (a == "--peers") o.peers = std::stoul(next());
+        else if (a == "--timeout-ms") o.timeoutMs = std::stoi(next());
+        else { std::cerr << "unknown option " << a << "\n"; std::exit(2); }
+    }
+    if (o.threads == 0) o.threads = 1;
+    if (o.window == 0) o.window = 1;
+    if (o.trackers == 0) o.trackers = 1;
+    return o;
+}
+
+static double processCpuSeconds() {
+    timespec ts{};
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return double(ts.tv_sec) + double(ts.tv_nsec) / 1e9;
+}
+
+static AnnounceRequest makeRequest(std::size_t torrent) {
+    AnnounceRequest req{};
+    for (std::size_t b = 0; b < req.infoHash.bytes.size(); ++b) {
+        req.infoHash.bytes[b] = static_cast<uint8_t>(torrent >> (8 * (b % 4)));
+    }
+    req.peerId.bytes.fill(0x2D);
+    req.port = 51413;
+    req.left = 1;
+    req.numwant = 50;
+    req.event = AnnounceEvent::started;
+    return req;
+}
+
+struct Result {
+    std::vector<double> latMs;      // successful announces
+    std::size_t failed{0};
+    double wallSec{0};
+    double clientCpuSec{0};
+};
+
+static void report(const std::string& name, Result& r, std::size_t total) {
+    std::sort(r.latMs.begin(), r.latMs.end());
+    auto pct = [&](double p) {
+        if (r.latMs.empty()) return 0.0;
+        return r.latMs[std::min(r.latMs.size() - 1, static_cast<std::size_t>(p * r.latMs.size()))];
+    };
+    std::cout << std::left << std::setw(10) << name << std::right << std::fixed
+              << std::setw(9) << total
+              << std::setw(8) << r.failed
+              << std::setw(11) << std::setprecision(0) << double(total) / r.wallSec
+              << std::setw(9) << std::setprecision(2) << pct(0.50)
+              << std::setw(9) << pct(0.90)
+              << std::setw(9) << pct(0.99)
+              << std::setw(9) << pct(0.999)
+              << std::setw(9) << (r.latMs.empty() ? 0.0 : r.latMs.back())
+              << std::setw(12) << std::setprecision(1) << r.clientCpuSec * 1e6 / double(total) << "\n";
+}
+
+static UdpEngineConfig engineConfig(const Options& o) {
+    UdpEngineConfig cfg;
+    cfg.timeout = std::chrono::milliseconds(o.timeoutMs);
+    cfg.maxRetransmits = 3;
+    return cfg;
+}
+
+static std::vector<std::unique_ptr<FakeUdpTrackerServer>> startTrackers(const Options& o) {
+    FakeUdpTrackerConfig tc;
+    tc.latency = std::chrono::microseconds(static_cast<int64_t>(o.latencyMs * 1000));
+    tc.jitter = std::chrono::microseconds(static_cast<int64_t>(o.jitterMs * 1000));
+    tc.lossRate = o.loss;
+    tc.errorRate = o.error;
+    tc.peers = o.peers;
+
+    std::vector<std::unique_ptr<FakeUdpTrackerServer>> trackers;
+    for (std::size_t i = 0; i < o.trackers; ++i) {
+        tc.seed = static_cast<uint32_t>(i + 1);
+        trackers.push_back(std::make_unique<FakeUdpTrackerServer>(tc));
+        if (!trackers.back()->start()) {
+            std::cerr << "stand-in: bind failed\n";
+            std::exit(1);
+        }
+    }
+    return trackers;
+}
+
+static double standinCpu(const std::vector<std::unique_ptr<FakeUdpTrackerServer>>& trackers) {
+    double s = 0;
+    for (auto& t : trackers) s += t->cpuSeconds();
+    return s;
+}
+
+static Result runEngine(const Options& o) {
+    auto trackers = startTrackers(o);
+    UdpTrackerEngine eng(engineConfig(o), std::make_shared<ConnectionIdCache>());
+    if (!eng.start().has_value()) std::exit(1);
+
+    const std::size_t total = o.torrents * o.trackers;
+    Result r;
+    r.latMs.reserve(total);
+    std::mutex mu;
+    std::condition_variable cv;
+    std::size_t done = 0;   // guarded by mu
+
+    const double cpu0 = processCpuSeconds(), stand0 = standinCpu(trackers);
+    const auto t0 = Clock::now();
+    for (std::size_t i = 0; i < total; ++i) {
+        {
+            std::unique_lock<std::mutex> lk(mu);
+            cv.wait(lk, [&] { return i - done < o.window; });
+        }
+        const auto sent = Clock::now();
+        eng.announce(makeRequest(i / o.trackers), trackers[i % o.trackers]->url(),
+                     [&, sent](Expected<AnnounceResponse> res) {
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - sent).count();
+            {
+                std::lock_guard<std::mutex> lk(mu);
+                if (res.has_value()) r.latMs.push_back(ms);
+                else ++r.failed;
+                ++done;
+            }
+            cv.notify_one();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lk(mu);
+        cv.wait(lk, [&] { return done == total; });
+    }
+    r.wallSec = std::chrono::duration<double>(Clock::now() - t0).count();
+    r.clientCpuSec = (processCpuSeconds() - cpu0) - (standinCpu(trackers) - stand0);
+    return r;
+}
+
+static Result runBlocking(const Options& o) {
+    auto trackers = startTrackers(o);
+    auto eng = std::make_shared<UdpTrackerEngine>(engineConfig(o), std::make_shared<ConnectionIdCache>());
+    if (!eng->start().has_value()) std::exit(1);
+    UdpTracker udp(eng);
+
+    const std::size_t total = o.torrents * o.trackers;
+    Result r;
+    r.latMs.reserve(total);
+    std::mutex mu;
+    std::atomic<std::size_t> next{0};
+
+    const double cpu0 = processCpuSeconds(), stand0 = standinCpu(trackers);
+    const auto t0 = Clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < o.threads; ++t) {
+        pool.emplace_back([&] {
+            for (std::size_t i; (i = next.fetch_add(1)) < total;) {
+                const auto sent = Clock::now();
+                auto res = udp.announce(makeRequest(i / o.trackers), trackers[i % o.trackers]->url());
+                const double ms = std::chrono::duration<double, std::milli>(Clock::now() - sent).count();
+                std::lock_guard<std::mutex> lk(mu);
+                if (res.has_value()) r.latMs.push_back(ms);
+                else ++r.failed;
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    r.wallSec = std::chrono::duration<double>(Clock::now() - t0).count();
+    r.clientCpuSec = (processCpuSeconds() - cpu0) - (standinCpu(trackers) - stand0);
+    return r;
+}
+
+int main(int argc, char** argv) {
+    const Options o = parseArgs(argc, argv);
+    const std::size_t total = o.torrents * o.trackers;
+
+    std::cout << o.torrents << " torrents x " << o.trackers << " trackers, latency " << o.latencyMs
+              << "+[0," << o.jitterMs << ") ms, loss " << o.loss << ", error " << o.error
+              << ", " << o.peers << " peers/reply, retransmit after " << o.timeoutMs << " ms\n";
+    std::cout << std::left << std::setw(10) << "mode" << std::right
+              << std::setw(9) << "total" << std::setw(8) << "failed" << std::setw(11) << "ann/s"
+              << std::setw(9) << "p50 ms" << std::setw(9) << "p90" << std::setw(9) << "p99"
+              << std::setw(9) << "p99.9" << std::setw(9) << "max" << std::setw(12) << "cpu us/ann" << "\n";
+
+    if (o.mode == "engine" || o.mode == "both") {
+        auto r = runEngine(o);
+        report("engine", r, total);
+    }
+    if (o.mode == "blocking" || o.mode == "both") {
+        auto r = runBlocking(o);
+        report("blocking", r, total);
+    }
+    return 0;
+}
@@ -45,10 +45,11 @@ int main(int argc, char** argv) {
 
     
     TrackerManager mgr(announceList, hash, pid, 6881, http);
-    mgr.start();
     mgr.onStats(0, 0, meta.totalLength());
 
+    // Queued first, so the very first announce carries event=started.
     mgr.announce(AnnounceEvent::started, 30);
+    mgr.start();
 
     // give some time for background thread
     std::this_thread::sleep_for(std::chrono::seconds(5));
@@ -56,7 +57,7 @@ int main(int argc, char** argv) {
     auto peers = mgr.drainNewPeers();
     std::cout << "Peers:\n";
     for (auto& p : peers) {
-        std::cout << "  " << p.ip << ":" << p.port << "\n";
+        std::cout << "  " << p.toString() << "\n";
     }
 
 
@@ -0,0 +1,521 @@
+#pragma once
+// Loopback HTTP/1.1 server used by the HTTP client tests and benchmarks (POSIX sockets).
+// Keep-alive, GET only; one epoll thread serves any number of connections. The handler
+// maps a request target to a reply, which is held back for its delay without holding up
+// other connections. With compression on, 200 bodies are gzip/deflate-encoded when the
+// request's Accept-Encoding allows.
+//
+// FakeHttpTracker puts a tracker behind it for load tests and benchmarks:
+//   /announce  compact or dict-list "peers" (per the request's compact=), optional
+//              "peers6", tracker failures at failureRate, and redirectHops 302s first
+//   /scrape    a files dict with one entry per info_hash= parameter
+// Announce replies can be inflated to a given size with a padding key trackers are free to add.
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <zlib.h>
+
+struct FakeHttpReply {
+    int status{200};
+    std::string body;
+    std::chrono::microseconds delay{0};     // held back this long before sending
+    std::string headers{};                  // extra header lines, each ending in "\r\n"
+
+    static FakeHttpReply redirect(const std::string& location) {
+        return {302, "", {}, "Location: " + location + "\r\n"};
+    }
+};
+
+struct FakeHttpServerConfig {
+    bool compress{false};                   // honour Accept-Encoding: gzip (preferred) or deflate
+    std::function<void()> onThreadStart;    // runs first on the server thread (benchmarks use it)
+};
+
+class FakeHttpServer {
+public:
+    using Handler = std::function<FakeHttpReply(const std::string& target)>;
+
+    struct Counters {
+        uint64_t connections{0}, requests{0}, bytesOut{0},
+                 compressed{0}, bodyBytes{0};   // bodyBytes: 200 bodies before encoding
+    };
+
+    explicit FakeHttpServer(Handler h, FakeHttpServerConfig cfg = {})
+        : handler_(std::move(h)), cfg_(std::move(cfg)) {}
+    ~FakeHttpServer() { stop(); }
+
+    FakeHttpServer(const FakeHttpServer&) = delete;
+    FakeHttpServer& operator=(const FakeHttpServer&) = delete;
+
+    bool start() {
+        lfd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (lfd_ < 0) return false;
+        int one = 1;
+        ::setsockopt(lfd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in a{};
+        a.sin_family = AF_INET;
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::bind(lfd_, reinterpret_cast<sockaddr*>(&a), sizeof(a)) < 0) return false;
+        if (::listen(lfd_, 1024) < 0) return false;
+        socklen_t len = sizeof(a);
+        ::getsockname(lfd_, reinterpret_cast<sockaddr*>(&a), &len);
+        port_ = ntohs(a.sin_port);
+
+        ep_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (ep_ < 0) return false;
+        watch(lfd_, EPOLLIN);
+
+        running_ = true;
+        th_ = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        if (running_.exchange(false) && th_.joinable()) th_.join();
+        for (auto& [fd, c] : conns_) ::close(fd);
+        conns_.clear();
+        if (lfd_ >= 0) ::close(lfd_);
+        if (ep_ >= 0) ::close(ep_);
+        lfd_ = ep_ = -1;
+    }
+
+    uint16_t port() const { return port_; }
+    std::string url(const std::string& path = "/announce") const {
+        return "http://127.0.0.1:" + std::to_string(port_) + path;
+    }
+
+    int connections() const { return static_cast<int>(connections_.load()); }
+    int requests() const { return static_cast<int>(requests_.load()); }
+
+    // bytesOut counts each reply in full when it is handed to the socket, so a client that
+    // has its reply always sees it counted.
+    Counters counters() const {
+        Counters c;
+        c.connections = connections_.load(); c.requests = requests_.load(); c.bytesOut = bytesOut_.load();
+        c.compressed = compressed_.load(); c.bodyBytes = bodyBytes_.load();
+        return c;
+    }
+
+    // CPU time used by the server thread (so benchmarks can subtract it).
+    double cpuSeconds() const { return cpuNanos_.load() / 1e9; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Conn {
+        std::string in;
+        std::string out;
+        std::size_t sent{0};
+        bool waiting{false};    // a reply is scheduled; no further parsing until it is out
+        uint64_t id{0};
+    };
+
+    struct Reply {
+        Clock::time_point due;
+        int fd;
+        uint64_t connId;
+        std::string bytes;
+        bool operator>(const Reply& o) const { return due > o.due; }
+    };
+
+    void watch(int fd, uint32_t events, int op = EPOLL_CTL_ADD) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        ::epoll_ctl(ep_, op, fd, &ev);
+    }
+
+    static const char* reason(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 302: return "Found";
+            case 400: return "Bad Request";
+            case 404: return "Not Found";
+            default:  return "X";
+        }
+    }
+
+    static std::string response(int status, const std::string& body, const std::string& extra = {}) {
+        return "HTTP/1.1 " + std::to_string(status) + " " + reason(status) + "\r\n"
+               "Content-Type: text/plain\r\n"
+               "Content-Length: " + std::to_string(body.size()) + "\r\n" + extra + "\r\n" + body;
+    }
+
+    // gzip (windowBits 31) or zlib-wrapped deflate (15), the two encodings curl asks for.
+    static std::string deflateBody(const std::string& in, bool gzip) {
+        z_stream zs{};
+        if (::deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, gzip ? 31 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK) return {};
+        std::string out(::deflateBound(&zs, static_cast<uLong>(in.size())) + 32, '\0');
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+        zs.avail_in = static_cast<uInt>(in.size());
+        zs.next_out = reinterpret_cast<Bytef*>(out.data());
+        zs.avail_out = static_cast<uInt>(out.size());
+        const int rc = ::deflate(&zs, Z_FINISH);
+        out.resize(zs.total_out);
+        ::deflateEnd(&zs);
+        return rc == Z_STREAM_END ? out : std::string{};
+    }
+
+    std::string encode(const FakeHttpReply& r, std::string_view acceptEncoding) {
+        if (r.status != 200) return response(r.status, r.body, r.headers);
+        bodyBytes_ += r.body.size();
+        if (cfg_.compress && !r.body.empty()) {
+            const bool gzip = acceptEncoding.find("gzip") != std::string_view::npos;
+            if (gzip || acceptEncoding.find("deflate") != std::string_view::npos) {
+                if (std::string z = deflateBody(r.body, gzip); !z.empty()) {
+                    ++compressed_;
+                    return response(200, z, r.headers + (gzip ? "Content-Encoding: gzip\r\n"
+                                                              : "Content-Encoding: deflate\r\n"));
+                }
+            }
+        }
+        return response(200, r.body, r.headers);
+    }
+
+    // Value of a request header (case-insensitive name), empty if absent.
+    static std::string_view header(std::string_view head, std::string_view name) {
+        for (std::size_t at = head.find("\r\n"); at != std::string_view::npos; at = head.find("\r\n", at + 2)) {
+            const std::string_view line = head.substr(at + 2, std::min(head.find("\r\n", at + 2), head.size()) - at - 2);
+            if (line.size() <= name.size() || line[name.size()] != ':') continue;
+            bool same = true;
+            for (std::size_t i = 0; i < name.size() && same; ++i) {
+                same = std::tolower(static_cast<unsigned char>(line[i])) == std::tolower(static_cast<unsigned char>(name[i]));
+            }
+            if (!same) continue;
+            std::string_view v = line.substr(name.size() + 1);
+            while (!v.empty() && v.front() == ' ') v.remove_prefix(1);
+            return v;
+        }
+        return {};
+    }
+
+    void closeConn(int fd) {
+        ::epoll_ctl(ep_, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        conns_.erase(fd);
+    }
+
+    // Parse one request if a full header block is buffered; GETs only, so no bodies.
+    void maybeSchedule(int fd, Conn& c) {
+        if (c.waiting) return;
+        const std::size_t end = c.in.find("\r\n\r\n");
+        if (end == std::string::npos) return;
+        const std::string_view head(c.in.data(), end);
+        const std::size_t sp1 = head.find(' ');
+        const std::size_t sp2 = head.find(' ', sp1 + 1);
+        ++requests_;
+
+        FakeHttpReply r{400, ""};
+        if (sp1 != std::string_view::npos && sp2 != std::string_view::npos) {
+            r = handler_(std::string(head.substr(sp1 + 1, sp2 - sp1 - 1)));
+        }
+        std::string bytes = encode(r, header(head, "Accept-Encoding"));
+        c.in.erase(0, end + 4);
+        c.waiting = true;
+        pending_.push(Reply{Clock::now() + r.delay, fd, c.id, std::move(bytes)});
+    }
+
+    // Returns false if the connection was closed.
+    bool flush(int fd, Conn& c) {
+        while (c.sent < c.out.size()) {
+            const ssize_t n = ::send(fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                watch(fd, EPOLLIN | EPOLLOUT, EPOLL_CTL_MOD);
+                return true;
+            }
+            if (n <= 0) { closeConn(fd); return false; }
+            c.sent += static_cast<std::size_t>(n);
+        }
+        c.out.clear();
+        c.sent = 0;
+        c.waiting = false;
+        watch(fd, EPOLLIN, EPOLL_CTL_MOD);
+        maybeSchedule(fd, c);
+        return true;
+    }
+
+    void sendDue(Clock::time_point now) {
+        while (!pending_.empty() && pending_.top().due <= now) {
+            Reply r = std::move(const_cast<Reply&>(pending_.top()));
+            pending_.pop();
+            auto it = conns_.find(r.fd);
+            if (it == conns_.end() || it->second.id != r.connId) continue;   // peer went away
+            bytesOut_ += r.bytes.size();
+            it->second.out = std::move(r.bytes);
+            flush(r.fd, it->second);
+        }
+    }
+
+    void accept() {
+        for (;;) {
+            const int fd = ::accept4(lfd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            ++connections_;
+            Conn& c = conns_[fd];
+            c = Conn{};
+            c.id = nextConnId_++;
+            watch(fd, EPOLLIN);
+        }
+    }
+
+    void readable(int fd) {
+        auto it = conns_.find(fd);
+        if (it == conns_.end()) return;
+        char buf[16384];
+        for (;;) {
+            const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+            if (n > 0) { it->second.in.append(buf, static_cast<std::size_t>(n)); continue; }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            closeConn(fd);
+            return;
+        }
+        maybeSchedule(fd, it->second);
+    }
+
+    void run() {
+        if (cfg_.onThreadStart) cfg_.onThreadStart();
+        epoll_event evs[256];
+        while (running_) {
+            int timeoutMs = 50;
+            if (!pending_.empty()) {
+                const auto wait = pending_.top().due - Clock::now();
+                timeoutMs = wait <= Clock::duration::zero() ? 0
+                          : static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(wait).count());
+                if (timeoutMs > 50) timeoutMs = 50;
+            }
+            const int n = ::epoll_wait(ep_, evs, 256, timeoutMs);
+            for (int i = 0; i < n; ++i) {
+                const int fd = evs[i].data.fd;
+                if (fd == lfd_) { accept(); continue; }
+                if (evs[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) readable(fd);
+                if (evs[i].events & EPOLLOUT) {
+                    auto it = conns_.find(fd);
+                    if (it != conns_.end()) flush(fd, it->second);
+                }
+            }
+            sendDue(Clock::now());
+
+            timespec ts{};
+            ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+            cpuNanos_ = static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ull + static_cast<uint64_t>(ts.tv_nsec);
+        }
+    }
+
+    Handler handler_;
+    FakeHttpServerConfig cfg_;
+    std::priority_queue<Reply, std::vector<Reply>, std::greater<Reply>> pending_;
+    std::unordered_map<int, Conn> conns_;
+    uint64_t nextConnId_{1};
+
+    int lfd_{-1}, ep_{-1};
+    uint16_t port_{0};
+    std::atomic<bool> running_{false};
+    std::thread th_;
+    std::atomic<uint64_t> connections_{0}, requests_{0}, bytesOut_{0}, compressed_{0}, bodyBytes_{0};
+    std::atomic<uint64_t> cpuNanos_{0};
+};
+
+// --------------------- Fake HTTP tracker ---------------------
+struct FakeHttpTrackerConfig {
+    std::chrono::microseconds latency{0};   // every reply is held this long...
+    std::chrono::microseconds jitter{0};    // ...plus uniform [0, jitter)
+    std::size_t peers{50};                  // IPv4 peers per announce
+    std::size_t peers6{0};                  // IPv6 peers per announce ("peers6", always compact)
+    double failureRate{0.0};                // announces answered with "failure reason"
+    unsigned redirectHops{0};               // 302s before the real announce reply
+    std::size_t minBodyBytes{0};            // pad announce bodies up to at least this size
+    bool compress{false};                   // see FakeHttpServerConfig
+    uint32_t interval{1800};
+    uint32_t seed{1};
+    std::function<void()> onThreadStart;
+};
+
+class FakeHttpTracker {
+public:
+    struct Counters : FakeHttpServer::Counters {
+        uint64_t announces{0}, scrapes{0}, failures{0}, redirects{0};
+    };
+
+    explicit FakeHttpTracker(FakeHttpTrackerConfig cfg = {})
+        : cfg_(std::move(cfg)), rng_(cfg_.seed),
+          server_([this](const std::string& target) { return handle(target); },
+                  FakeHttpServerConfig{cfg_.compress, cfg_.onThreadStart}) {}
+
+    bool start() {
+        buildPeerBlobs();
+        return server_.start();
+    }
+    void stop() { server_.stop(); }
+
+    uint16_t port() const { return server_.port(); }
+    std::string url(const std::string& path = "/announce") const { return server_.url(path); }
+
+    Counters counters() const {
+        Counters c;
+        static_cast<FakeHttpServer::Counters&>(c) = server_.counters();
+        c.announces = announces_.load(); c.scrapes = scrapes_.load();
+        c.failures = failures_.load(); c.redirects = redirects_.load();
+        return c;
+    }
+    double cpuSeconds() const { return server_.cpuSeconds(); }
+
+private:
+    void buildPeerBlobs() {
+        peerBlob_.clear();
+        peer6Blob_.clear();
+        for (std::size_t i = 0; i < cfg_.peers; ++i) {
+            const uint16_t port = static_cast<uint16_t>(6881 + i % 1000);
+            const char e[6] = {10, char(i >> 16), char(i >> 8), char(i), char(port >> 8), char(port)};
+            peerBlob_.append(e, 6);
+        }
+        for (std::size_t i = 0; i < cfg_.peers6; ++i) {
+            const uint16_t port = static_cast<uint16_t>(6881 + i % 1000);
+            const char e[18] = {0x20, 0x01, 0x0d, char(0xb8), 0, 0, 0, 0, 0, 0, 0, 0,
+                                char(i >> 16), char(i >> 8), char(i), 1, char(port >> 8), char(port)};
+            peer6Blob_.append(e, 18);
+        }
+    }
+
+    bool chance(double p) { return p > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < p; }
+
+    static std::string_view queryValue(std::string_view query, std::string_view key) {
+        for (std::size_t at = 0; at < query.size();) {
+            const std::size_t end = std::min(query.find('&', at), query.size());
+            const std::string_view kv = query.substr(at, end - at);
+            if (kv.size() > key.size() && kv.substr(0, key.size()) == key && kv[key.size()] == '=') {
+                return kv.substr(key.size() + 1);
+            }
+            at = end + 1;
+        }
+        return {};
+    }
+
+    static std::string percentDecode(std::string_view s) {
+        std::string out;
+        for (std::size_t i = 0; i < s.size(); ++i) {
+            if (s[i] == '%' && i + 2 < s.size()) {
+                out += static_cast<char>(std::stoi(std::string(s.substr(i + 1, 2)), nullptr, 16));
+                i += 2;
+            } else {
+                out += s[i];
+            }
+        }
+        return out;
+    }
+
+    std::string announceBody(std::string_view query) {
+        if (chance(cfg_.failureRate)) {
+            ++failures_;
+            return "d14:failure reason16:stand-in failuree";
+        }
+        std::string b = "d8:completei10e10:incompletei20e8:intervali" + std::to_string(cfg_.interval) + "e";
+        if (queryValue(query, "compact") == "0") {
+            b += "5:peersl";
+            for (std::size_t i = 0; i < cfg_.peers; ++i) {
+                const std::string ip = "10." + std::to_string((i >> 16) & 0xFF) + "." +
+                                       std::to_string((i >> 8) & 0xFF) + "." + std::to_string(i & 0xFF);
+                b += "d2:ip" + std::to_string(ip.size()) + ":" + ip + "4:porti" + std::to_string(6881 + i % 1000) + "ee";
+            }
+            b += "e";
+        } else {
+            b += "5:peers" + std::to_string(peerBlob_.size()) + ":" + peerBlob_;
+        }
+        if (!peer6Blob_.empty()) b += "6:peers6" + std::to_string(peer6Blob_.size()) + ":" + peer6Blob_;
+
+        // "zpad" sorts last, keeping the dict canonical; "4:zpad<n>:" counts toward the target.
+        if (b.size() + 1 < cfg_.minBodyBytes) {
+            const std::size_t room = cfg_.minBodyBytes - b.size() - 1;
+            std::size_t n = room > 8 ? room - 8 : 0;
+            while (n > 0 && 7 + std::to_string(n).size() + n > room) --n;
+            b += "4:zpad" + std::to_string(n) + ":" + std::string(n, 'x');
+        }
+        return b + "e";
+    }
+
+    static std::string scrapeBody(std::string_view query) {
+        std::string b = "d5:filesd";
+        for (std::size_t at = query.find("info_hash="); at != std::string_view::npos; at = query.find("info_hash=", at + 1)) {
+            const std::size_t start = at + 10;
+            const std::size_t end = std::min(query.find('&', start), query.size());
+            const std::string ih = percentDecode(query.substr(start, end - start));
+            b += std::to_string(ih.size()) + ":" + ih + "d8:completei5e10:downloadedi50e10:incompletei7ee";
+        }
+        return b + "ee";
+    }
+
+    std::chrono::microseconds delay() {
+        auto d = cfg_.latency;
+        if (cfg_.jitter.count() > 0) {
+            d += std::chrono::microseconds(std::uniform_int_distribution<int64_t>(0, cfg_.jitter.count() - 1)(rng_));
+        }
+        return d;
+    }
+
+    // Runs on the server thread. "/r<k>/announce" is hop k of the redirect chain; plain
+    // "/announce" is hop 0.
+    FakeHttpReply handle(const std::string& target) {
+        const std::size_t q = target.find('?');
+        const std::string_view path = std::string_view(target).substr(0, q);
+        const std::string_view query = q == std::string::npos ? std::string_view{} : std::string_view(target).substr(q + 1);
+
+        unsigned hop = 0;
+        std::string_view leaf = path;
+        if (path.size() > 2 && path[0] == '/' && path[1] == 'r') {
+            const std::size_t slash = path.find('/', 2);
+            if (slash != std::string_view::npos) {
+                hop = static_cast<unsigned>(std::stoul(std::string(path.substr(2, slash - 2))));
+                leaf = path.substr(slash);
+            }
+        }
+
+        FakeHttpReply r{404, ""};
+        if (leaf == "/announce") {
+            if (hop < cfg_.redirectHops) {
+                ++redirects_;
+                r = FakeHttpReply::redirect("/r" + std::to_string(hop + 1) + "/announce" +
+                                            (query.empty() ? "" : "?" + std::string(query)));
+            } else {
+                ++announces_;
+                r.status = 200;
+                r.body = announceBody(query);
+            }
+        } else if (leaf == "/scrape") {
+            ++scrapes_;
+            r.status = 200;
+            r.body = scrapeBody(query);
+        }
+        r.delay = delay();
+        return r;
+    }
+
+    FakeHttpTrackerConfig cfg_;
+    std::mt19937 rng_;
+    std::string peerBlob_, peer6Blob_;
+    std::atomic<uint64_t> announces_{0}, scrapes_{0}, failures_{0}, redirects_{0};
+    FakeHttpServer server_;     // last: its thread stops before the rest goes away
+};
@@ -0,0 +1,441 @@
+#pragma once
+// Loopback BEP 15 tracker used by the UDP tracker tests and benchmarks (POSIX sockets).
+// One thread drains and answers with recvmmsg/sendmmsg. Unit tests script one-off
+// behaviours through the setters; load tests and benchmarks configure latency, jitter,
+// packet loss, random tracker errors and any number of generated peers per reply.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+
+// --------------------- test-side byte helpers ---------------------
+static inline void t_put_u32(std::vector<uint8_t>& b, uint32_t v) {
+    b.push_back(static_cast<uint8_t>((v >> 24) & 0xFF));
+    b.push_back(static_cast<uint8_t>((v >> 16) & 0xFF));
+    b.push_back(static_cast<uint8_t>((v >>  8) & 0xFF));
+    b.push_back(static_cast<uint8_t>( v        & 0xFF));
+}
+static inline void t_put_u64(std::vector<uint8_t>& b, uint64_t v) {
+    t_put_u32(b, static_cast<uint32_t>(v >> 32));
+    t_put_u32(b, static_cast<uint32_t>(v & 0xFFFFFFFFu));
+}
+static inline uint32_t t_get_u32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+static inline uint64_t t_get_u64(const uint8_t* p) {
+    return (uint64_t(t_get_u32(p)) << 32) | t_get_u32(p + 4);
+}
+
+// --------------------- Fake UDP tracker server ---------------------
+struct FakeUdpTrackerConfig {
+    std::chrono::microseconds latency{0};   // every reply is held this long...
+    std::chrono::microseconds jitter{0};    // ...plus uniform [0, jitter)
+    double lossRate{0.0};                   // requests silently dropped (any action)
+    double errorRate{0.0};                  // announces/scrapes answered with action=3
+    std::size_t peers{0};                   // generated peers per announce, until setPeers()
+    int family{AF_INET};                    // for start() without an argument
+    uint32_t seed{1};
+};
+
+class FakeUdpTrackerServer {
+public:
+    struct Counters {
+        uint64_t received{0}, dropped{0}, connects{0}, announces{0}, scrapes{0}, errors{0};
+    };
+
+    explicit FakeUdpTrackerServer(FakeUdpTrackerConfig cfg = {}) : cfg_(cfg), rng_(cfg.seed) {}
+    ~FakeUdpTrackerServer() { stop(); }
+
+    FakeUdpTrackerServer(const FakeUdpTrackerServer&) = delete;
+    FakeUdpTrackerServer& operator=(const FakeUdpTrackerServer&) = delete;
+
+    // Set peers returned by announce (IPv4 strings; IPv6 strings become 18-byte entries)
+    void setPeers(const std::vector<std::pair<std::string,int>>& peers) {
+        std::vector<uint8_t> blob;
+        for (auto& [ip, port] : peers) {
+            if (ip.find(':') != std::string::npos) {
+                in6_addr in6{};
+                ::inet_pton(AF_INET6, ip.c_str(), &in6);
+                blob.insert(blob.end(), in6.s6_addr, in6.s6_addr + 16);
+            } else {
+                in_addr ina{};
+                ::inet_pton(AF_INET, ip.c_str(), &ina);
+                t_put_u32(blob, ntohl(ina.s_addr));
+            }
+            blob.push_back(static_cast<uint8_t>((port >> 8) & 0xFF));
+            blob.push_back(static_cast<uint8_t>(port & 0xFF));
+        }
+        std::lock_guard<std::mutex> lk(mu_);
+        peerBlob_ = std::move(blob);
+        peersSet_ = true;
+    }
+
+    // Configure scrape stats to return (seeders, completed, leechers)
+    void setScrapeTriplet(uint32_t s, uint32_t c, uint32_t l) {
+        std::lock_guard<std::mutex> lk(mu_);
+        scrapeSeeders_ = s; scrapeCompleted_ = c; scrapeLeechers_ = l;
+    }
+
+    void setErrorOnAnnounce(bool on, std::string msg = "nope") {
+        std::lock_guard<std::mutex> lk(mu_);
+        sendErrorOnAnnounce_ = on; errorMsg_ = std::move(msg);
+    }
+    void setErrorOnScrape(bool on, std::string msg = "nope") {
+        std::lock_guard<std::mutex> lk(mu_);
+        sendErrorOnScrape_ = on; errorScrapeMsg_ = std::move(msg);
+    }
+
+    // “once” behaviors to exercise client retry paths
+    void setShortAnnounceOnce(bool on = true) { onceShortAnnounce_ = on; }
+    void setActionMismatchOnce(bool on = true) { onceActionMismatch_ = on; }
+    void setWrongTxOnce(bool on = true) { onceWrongTx_ = on; }
+
+    bool start() { return start(cfg_.family); }
+
+    // family: AF_INET binds 127.0.0.1, AF_INET6 binds ::1
+    bool start(int family) {
+        if (running_.load()) return true;
+
+        sock_ = ::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (sock_ < 0) return false;
+        int bytes = 8 << 20;
+        ::setsockopt(sock_, SOL_SOCKET, SO_RCVBUF, &bytes, sizeof(bytes));
+        ::setsockopt(sock_, SOL_SOCKET, SO_SNDBUF, &bytes, sizeof(bytes));
+
+        sockaddr_storage addr{};
+        socklen_t alen;
+        if (family == AF_INET6) {
+            auto& a6 = reinterpret_cast<sockaddr_in6&>(addr);
+            a6.sin6_family = AF_INET6;
+            a6.sin6_addr = in6addr_loopback;    // ::1
+            alen = sizeof(sockaddr_in6);
+        } else {
+            auto& a4 = reinterpret_cast<sockaddr_in&>(addr);
+            a4.sin_family = AF_INET;
+            a4.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // 127.0.0.1
+            alen = sizeof(sockaddr_in);
+        }
+        // port 0: ephemeral
+
+        if (::bind(sock_, reinterpret_cast<sockaddr*>(&addr), alen) < 0) {
+            ::close(sock_); sock_ = -1; return false;
+        }
+
+        sockaddr_storage bound{}; socklen_t blen = sizeof(bound);
+        if (::getsockname(sock_, reinterpret_cast<sockaddr*>(&bound), &blen) == 0) {
+            port_ = family == AF_INET6 ? ntohs(reinterpret_cast<sockaddr_in6&>(bound).sin6_port)
+                                       : ntohs(reinterpret_cast<sockaddr_in&>(bound).sin_port);
+        } else {
+            ::close(sock_); sock_ = -1; return false;
+        }
+
+        family_ = family;
+        generatePeers();
+        running_.store(true);
+        th_ = std::thread([this]{ this->loop(); });
+        return true;
+    }
+
+    void stop() {
+        if (!running_.exchange(false)) return;
+        if (th_.joinable()) th_.join();
+        if (sock_ >= 0) {
+            ::close(sock_);
+            sock_ = -1;
+        }
+    }
+
+    uint16_t port() const { return port_; }
+
+    std::string url(const std::string& path = "/announce") const {
+        const std::string host = family_ == AF_INET6 ? "[::1]" : "127.0.0.1";
+        return "udp://" + host + ":" + std::to_string(port_) + path;
+    }
+
+    // stats
+    int connectCount() const { return static_cast<int>(connects_.load()); }
+    int announceCount() const { return static_cast<int>(announces_.load()); }
+    int scrapeCount() const { return static_cast<int>(scrapes_.load()); }
+
+    Counters counters() const {
+        Counters c;
+        c.received = received_.load(); c.dropped = dropped_.load(); c.connects = connects_.load();
+        c.announces = announces_.load(); c.scrapes = scrapes_.load(); c.errors = errors_.load();
+        return c;
+    }
+
+    // CPU time used by the server thread (so benchmarks can subtract it).
+    double cpuSeconds() const { return cpuNanos_.load() / 1e9; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr unsigned kBatch = 64;
+
+    struct Reply {
+        Clock::time_point due;
+        sockaddr_storage to;
+        socklen_t tolen;
+        std::vector<uint8_t> bytes;
+        bool operator>(const Reply& o) const { return due > o.due; }
+    };
+
+    // cfg_.peers entries by family: 10.x.y.z or 2001:db8::x:y:z01, ports from 6881.
+    void generatePeers() {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (peersSet_) return;
+        peerBlob_.clear();
+        const bool v6 = family_ == AF_INET6;
+        for (std::size_t i = 0; i < cfg_.peers; ++i) {
+            if (v6) {
+                const uint8_t pfx[] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0};
+                peerBlob_.insert(peerBlob_.end(), pfx, pfx + 12);
+            } else {
+                peerBlob_.push_back(10);
+            }
+            peerBlob_.push_back(static_cast<uint8_t>(i >> 16));
+            peerBlob_.push_back(static_cast<uint8_t>(i >> 8));
+            peerBlob_.push_back(static_cast<uint8_t>(i));
+            if (v6) peerBlob_.push_back(1);
+            peerBlob_.push_back(static_cast<uint8_t>((6881 + i % 1000) >> 8));
+            peerBlob_.push_back(static_cast<uint8_t>(6881 + i % 1000));
+        }
+    }
+
+    bool chance(double p) { return p > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < p; }
+
+    Clock::duration delay() {
+        auto d = Clock::duration(cfg_.latency);
+        if (cfg_.jitter.count() > 0) {
+            d += std::chrono::microseconds(std::uniform_int_distribution<int64_t>(0, cfg_.jitter.count() - 1)(rng_));
+        }
+        return d;
+    }
+
+    // Returns an empty vector when the request is dropped or malformed.
+    std::vector<uint8_t> answer(const uint8_t* p, std::size_t n) {
+        std::vector<uint8_t> out;
+        if (n < 16) return out;
+        if (chance(cfg_.lossRate)) { ++dropped_; return out; }
+
+        // Connect has the protocol id first; action and tx follow at offsets 8 and 12.
+        const uint32_t action = t_get_u32(p + 8);
+        const uint32_t tx     = t_get_u32(p + 12);
+        std::lock_guard<std::mutex> lk(mu_);
+        switch (action) {
+            case 0: // connect
+                ++connects_;
+                connect_reply(out, tx);
+                break;
+            case 1: // announce
+                ++announces_;
+                if (sendErrorOnAnnounce_) {
+                    error_reply(out, tx, errorMsg_);
+                } else if (chance(cfg_.errorRate)) {
+                    error_reply(out, tx, "stand-in error");
+                } else if (onceShortAnnounce_.exchange(false)) {
+                    announce_truncated(out, tx);
+                } else if (onceActionMismatch_.exchange(false)) {
+                    announce_action_mismatch(out, tx);
+                } else if (onceWrongTx_.exchange(false)) {
+                    announce_wrong_tx(out, tx);
+                } else {
+                    announce_reply(out, tx);
+                }
+                break;
+            case 2: // scrape
+                ++scrapes_;
+                if (sendErrorOnScrape_) {
+                    error_reply(out, tx, errorScrapeMsg_);
+                } else if (chance(cfg_.errorRate)) {
+                    error_reply(out, tx, "stand-in error");
+                } else {
+                    scrape_reply(out, tx, n);
+                }
+                break;
+            default:
+                error_reply(out, tx, "unsupported action");
+                break;
+        }
+        return out;
+    }
+
+    void connect_reply(std::vector<uint8_t>& out, uint32_t tx) {
+        // Response: action(0), tx, connection_id(64)
+        t_put_u32(out, 0u);
+        t_put_u32(out, tx);
+        t_put_u64(out, kConnId);
+    }
+
+    void announce_truncated(std::vector<uint8_t>& out, uint32_t tx) {
+        // Only 8 bytes (action + tx), deliberately shorter than 20 required bytes.
+        t_put_u32(out, 1u);      // action=announce
+        t_put_u32(out, tx);      // same tx
+        // no body
+    }
+
+    void announce_action_mismatch(std::vector<uint8_t>& out, uint32_t tx) {
+        // action=2 (scrape) but in response to announce; include 12 more bytes so n>=20
+        t_put_u32(out, 2u);      // wrong action
+        t_put_u32(out, tx);
+        t_put_u32(out, 0);
+        t_put_u32(out, 0);
+        t_put_u32(out, 0);
+    }
+
+    void announce_wrong_tx(std::vector<uint8_t>& out, uint32_t tx) {
+        // Correct action but wrong tx; full announce body present (ignored by client).
+        t_put_u32(out, 1u);
+        t_put_u32(out, tx + 1u); // wrong transaction id
+        t_put_u32(out, kInterval);
+        t_put_u32(out, kLeechers);
+        t_put_u32(out, kSeeders);
+        // no peers needed; it's a mismatch anyway
+    }
+
+    void announce_reply(std::vector<uint8_t>& out, uint32_t tx) {
+        // Response: action(1), tx, interval, leechers, seeders, peers...
+        t_put_u32(out, 1u);
+        t_put_u32(out, tx);
+        t_put_u32(out, kInterval);
+        t_put_u32(out, kLeechers);
+        t_put_u32(out, kSeeders);
+        out.insert(out.end(), peerBlob_.begin(), peerBlob_.end());
+    }
+
+    void scrape_reply(std::vector<uint8_t>& out, uint32_t tx, std::size_t n) {
+        // Request body after the 16-byte header is 20*N info_hashes.
+        // Response: action(2), tx, then for each hash: seeders, completed, leechers.
+        t_put_u32(out, 2u);
+        t_put_u32(out, tx);
+        const std::size_t hashes = std::max<std::size_t>((n - 16) / 20, 1);
+        for (std::size_t i = 0; i < hashes; ++i) {
+            t_put_u32(out, scrapeSeeders_);
+            t_put_u32(out, scrapeCompleted_);
+            t_put_u32(out, scrapeLeechers_);
+        }
+    }
+
+    void error_reply(std::vector<uint8_t>& out, uint32_t tx, const std::string& msg) {
+        ++errors_;
+        t_put_u32(out, 3u);
+        t_put_u32(out, tx);
+        out.insert(out.end(), msg.begin(), msg.end());
+    }
+
+    void sendDue(Clock::time_point now) {
+        mmsghdr hdrs[kBatch];
+        iovec iov[kBatch];
+        std::vector<Reply> batch;
+        while (!pending_.empty() && pending_.top().due <= now) {
+            batch.clear();
+            while (batch.size() < kBatch && !pending_.empty() && pending_.top().due <= now) {
+                batch.push_back(std::move(const_cast<Reply&>(pending_.top())));
+                pending_.pop();
+            }
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                iov[i] = {batch[i].bytes.data(), batch[i].bytes.size()};
+                hdrs[i] = mmsghdr{};
+                hdrs[i].msg_hdr.msg_name = &batch[i].to;
+                hdrs[i].msg_hdr.msg_namelen = batch[i].tolen;
+                hdrs[i].msg_hdr.msg_iov = &iov[i];
+                hdrs[i].msg_hdr.msg_iovlen = 1;
+            }
+            for (unsigned done = 0; done < batch.size();) {
+                const int s = ::sendmmsg(sock_, hdrs + done, static_cast<unsigned>(batch.size() - done), 0);
+                if (s <= 0) break;      // socket full: the client's retransmit covers it
+                done += static_cast<unsigned>(s);
+            }
+        }
+    }
+
+    void loop() {
+        uint8_t in[kBatch][2048];
+        sockaddr_storage from[kBatch];
+        iovec iin[kBatch];
+        mmsghdr rx[kBatch];
+
+        while (running_.load()) {
+            int timeoutMs = 50;
+            if (!pending_.empty()) {
+                const auto wait = pending_.top().due - Clock::now();
+                timeoutMs = wait <= Clock::duration::zero() ? 0
+                          : static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(wait).count());
+                if (timeoutMs > 50) timeoutMs = 50;
+            }
+            pollfd pfd{sock_, POLLIN, 0};
+            ::poll(&pfd, 1, timeoutMs);
+
+            for (;;) {
+                for (unsigned i = 0; i < kBatch; ++i) {
+                    iin[i] = {in[i], sizeof(in[i])};
+                    rx[i] = mmsghdr{};
+                    rx[i].msg_hdr.msg_name = &from[i];
+                    rx[i].msg_hdr.msg_namelen = sizeof(from[i]);
+                    rx[i].msg_hdr.msg_iov = &iin[i];
+                    rx[i].msg_hdr.msg_iovlen = 1;
+                }
+                const int n = ::recvmmsg(sock_, rx, kBatch, MSG_DONTWAIT, nullptr);
+                if (n <= 0) break;
+                received_ += static_cast<uint64_t>(n);
+
+                const auto now = Clock::now();
+                for (int i = 0; i < n; ++i) {
+                    auto bytes = answer(in[i], rx[i].msg_len);
+                    if (bytes.empty()) continue;
+                    pending_.push(Reply{now + delay(), from[i], rx[i].msg_hdr.msg_namelen, std::move(bytes)});
+                }
+                if (static_cast<unsigned>(n) < kBatch) break;
+            }
+            sendDue(Clock::now());
+
+            timespec ts{};
+            ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+            cpuNanos_ = static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ull + static_cast<uint64_t>(ts.tv_nsec);
+        }
+    }
+
+    static constexpr uint32_t kInterval = 900, kLeechers = 5, kSeeders = 3;
+    static constexpr uint64_t kConnId = 0x0123456789ABCDEFULL;
+
+    FakeUdpTrackerConfig cfg_;
+    std::mt19937 rng_;
+    std::priority_queue<Reply, std::vector<Reply>, std::greater<Reply>> pending_;
+
+    std::atomic<bool> running_{false};
+    int sock_{-1};
+    int family_{AF_INET};
+    uint16_t port_{0};
+    std::thread th_;
+
+    std::mutex mu_;     // guards the scripted replies below
+    std::vector<uint8_t> peerBlob_;
+    bool peersSet_{false};
+    uint32_t scrapeSeeders_{12}, scrapeCompleted_{34}, scrapeLeechers_{56};
+    bool sendErrorOnAnnounce_{false};
+    std::string errorMsg_{"nope"};
+    bool sendErrorOnScrape_{false};
+    std::string errorScrapeMsg_{"scrape nope"};
+
+    std::atomic<bool> onceShortAnnounce_{false};
+    std::atomic<bool> onceActionMismatch_{false};
+    std::atomic<bool> onceWrongTx_{false};
+
+    std::atomic<uint64_t> received_{0}, dropped_{0}, connects_{0}, announces_{0}, scrapes_{0}, errors_{0};
+    std::atomic<uint64_t> cpuNanos_{0};
+};
@@ -34,5 +34,38 @@ echo "=== Running test_http_tracker ==="
 echo "=== Running test_udp_tracker ==="
 ./test_udp_tracker
 
+echo "=== Running test_timer_wheel ==="
+./test_timer_wheel
+
+echo "=== Running test_dns_resolver ==="
+./test_dns_resolver
+
+echo "=== Running test_udp_engine ==="
+./test_udp_engine
+
+echo "=== Running test_udp_wire ==="
+./test_udp_wire
+
+echo "=== Running test_scrape_aggregator ==="
+./test_scrape_aggregator
+
+echo "=== Running test_http_client_curl ==="
+./test_http_client_curl
+
+echo "=== Running test_announce_url ==="
+./test_announce_url
+
+echo "=== Running test_peer_pool ==="
+./test_peer_pool
+
+echo "=== Running test_tracker_scheduler ==="
+./test_tracker_scheduler
+
+echo "=== Running test_peer_queue ==="
+./test_peer_queue
+
+echo "=== Running test_udp_engine_alloc ==="
+./test_udp_engine_alloc
+
 # (Optional) also run ctest to integrate with CTest if desired
 # ctest --output-on-failure
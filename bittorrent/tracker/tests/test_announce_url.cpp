@@ -0,0 +1,98 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstdio>
+#include <string>
+
+#include "../include/announce_url.hpp"
+
+using namespace bittorrent::tracker;
+
+// --------------------- helpers ---------------------
+static std::string reference_encode(std::string_view raw) {
+    std::string out;
+    for (unsigned char c : raw) {
+        const bool keep = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                          c == '-' || c == '_' || c == '.' || c == '~';
+        if (keep) { out += static_cast<char>(c); continue; }
+        char buf[4];
+        std::snprintf(buf, sizeof(buf), "%%%02X", c);
+        out += buf;
+    }
+    return out;
+}
+
+static AnnounceRequest make_req() {
+    AnnounceRequest req{};
+    for (int i = 0; i < 20; ++i) {
+        req.infoHash.bytes[i] = static_cast<std::uint8_t>(0xF0 + i);
+        req.peerId.bytes[i] = static_cast<std::uint8_t>('A' + i);
+    }
+    req.port = 6881;
+    req.key = 42;
+    return req;
+}
+
+// --------------------- TESTS ---------------------
+
+TEST_CASE("percentEncoded: every byte value matches the reference encoding") {
+    std::string all;
+    for (int c = 0; c < 256; ++c) all += static_cast<char>(c);
+
+    CHECK(percentEncoded(all) == reference_encode(all));
+    CHECK(percentEncoded("") == "");
+    CHECK(percentEncoded("fe80::1") == "fe80%3A%3A1");
+
+    std::string out = "x=";
+    appendPercentEncoded(out, "a b");
+    CHECK(out == "x=a%20b");
+}
+
+TEST_CASE("AnnounceUrlBuilder: fixed fields in the prefix, counters per build") {
+    auto req = make_req();
+    AnnounceUrlBuilder b("http://t/announce", req);
+
+    const std::string ih = reference_encode(std::string_view(reinterpret_cast<const char*>(req.infoHash.bytes.data()), 20));
+    CHECK(b.prefix() == "http://t/announce?info_hash=" + ih +
+                        "&peer_id=ABCDEFGHIJKLMNOPQRST&port=6881&compact=1&key=42&no_peer_id=1");
+
+    req.uploaded = 18446744073709551615ull;
+    req.downloaded = 0;
+    req.left = 1000;
+    req.event = AnnounceEvent::completed;
+    req.numwant = 80;
+    req.ipv6 = std::string("::1");
+    req.trackerId = std::string("id 7");
+    CHECK(std::string(b.build(req)) == b.prefix() +
+          "&uploaded=18446744073709551615&downloaded=0&left=1000&event=completed&numwant=80"
+          "&ipv6=%3A%3A1&trackerid=id%207");
+
+    req.event = AnnounceEvent::none;
+    req.ipv6.reset();
+    req.trackerId.reset();
+    CHECK(std::string(b.build(req)) == b.prefix() + "&uploaded=18446744073709551615&downloaded=0&left=1000&numwant=80");
+}
+
+TEST_CASE("AnnounceUrlBuilder: existing query string, matches(), buffer reuse") {
+    auto req = make_req();
+    req.compact = false;
+    req.no_peer_id = false;
+    AnnounceUrlBuilder b("http://t/a?passkey=x", req);
+    CHECK(b.prefix().rfind("http://t/a?passkey=x&info_hash=", 0) == 0);
+    CHECK(b.prefix().find("&compact=0") != std::string::npos);
+    CHECK(b.prefix().find("no_peer_id") == std::string::npos);
+
+    CHECK(b.matches(req));
+    auto other = req; other.port = 1;
+    CHECK_FALSE(b.matches(other));
+    other = req; other.infoHash.bytes[0] ^= 1;
+    CHECK_FALSE(b.matches(other));
+    other = req; other.left = 5; other.event = AnnounceEvent::stopped;
+    CHECK(b.matches(other));
+
+    // Steady state: the same storage is rewritten in place.
+    const char* first = b.build(req).data();
+    for (int i = 0; i < 100; ++i) {
+        req.uploaded += 1u << 20;
+        CHECK(b.build(req).data() == first);
+    }
+}
@@ -1,6 +1,7 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
 #include <arpa/inet.h>   // inet_pton, htons
 #include <string>
 #include <vector>
@@ -12,6 +13,11 @@ using namespace bittorrent::tracker;
 
 // --- Helpers --------------------------------------------------------------
 
+// Fills every byte of the endpoints (padding included) with 0xEE.
+static void poison(std::vector<PeerEndpoint>& out) {
+    std::fill_n(reinterpret_cast<unsigned char*>(out.data()), out.size() * sizeof(PeerEndpoint), 0xEE);
+}
+
 static std::string build_ipv4_blob(
     const std::vector<std::pair<std::array<uint8_t,4>, uint16_t>>& peers) {
     std::string raw;
@@ -72,8 +78,8 @@ TEST_CASE("IPv4: single peer parses correctly") {
     auto raw = build_ipv4_blob({{ v4("1.2.3.4"), 6881 }});
     auto peers = CompactPeerCodec::parseIPv4(raw);
     REQUIRE(peers.size() == 1);
-    REQUIRE(peers[0].ip == "1.2.3.4");
-    REQUIRE(peers[0].port == 6881);
+    REQUIRE(peers[0].ip() == "1.2.3.4");
+    REQUIRE(peers[0].port() == 6881);
 }
 
 TEST_CASE("IPv4: multiple peers preserve order") {
@@ -84,12 +90,12 @@ TEST_CASE("IPv4: multiple peers preserve order") {
     });
     auto peers = CompactPeerCodec::parseIPv4(raw);
     REQUIRE(peers.size() == 3);
-    CHECK(peers[0].ip == "1.1.1.1");
-    CHECK(peers[0].port == 6881);
-    CHECK(peers[1].ip == "8.8.8.8");
-    CHECK(peers[1].port == 53);
-    CHECK(peers[2].ip == "127.0.0.1");
-    CHECK(peers[2].port == 80);
+    CHECK(peers[0].ip() == "1.1.1.1");
+    CHECK(peers[0].port() == 6881);
+    CHECK(peers[1].ip() == "8.8.8.8");
+    CHECK(peers[1].port() == 53);
+    CHECK(peers[2].ip() == "127.0.0.1");
+    CHECK(peers[2].port() == 80);
 }
 
 TEST_CASE("IPv4: boundary ports and addresses") {
@@ -101,14 +107,14 @@ TEST_CASE("IPv4: boundary ports and addresses") {
     });
     auto peers = CompactPeerCodec::parseIPv4(raw);
     REQUIRE(peers.size() == 4);
-    CHECK(peers[0].ip == "0.0.0.0");
-    CHECK(peers[0].port == 0);
-    CHECK(peers[1].ip == "255.255.255.255");
-    CHECK(peers[1].port == 65535);
-    CHECK(peers[2].ip == "192.168.0.1");
-    CHECK(peers[2].port == 1);
-    CHECK(peers[3].ip == "10.0.0.1");
-    CHECK(peers[3].port == 51413);
+    CHECK(peers[0].ip() == "0.0.0.0");
+    CHECK(peers[0].port() == 0);
+    CHECK(peers[1].ip() == "255.255.255.255");
+    CHECK(peers[1].port() == 65535);
+    CHECK(peers[2].ip() == "192.168.0.1");
+    CHECK(peers[2].port() == 1);
+    CHECK(peers[3].ip() == "10.0.0.1");
+    CHECK(peers[3].port() == 51413);
 }
 
 // ------------------------------- Tests: IPv6 --------------------------------
@@ -132,8 +138,8 @@ TEST_CASE("IPv6: single peer ::1 parsing and port") {
     auto peers = CompactPeerCodec::parseIPv6(raw);
     REQUIRE(peers.size() == 1);
     // inet_ntop should compress ::1
-    CHECK(peers[0].ip == "::1");
-    CHECK(peers[0].port == 51413);
+    CHECK(peers[0].ip() == "::1");
+    CHECK(peers[0].port() == 51413);
 }
 
 TEST_CASE("IPv6: multiple peers preserve order with typical addresses") {
@@ -146,15 +152,15 @@ TEST_CASE("IPv6: multiple peers preserve order with typical addresses") {
     REQUIRE(peers.size() == 3);
 
     // Formatting from inet_ntop is canonical compressed; match known forms:
-    CHECK(peers[0].ip == "2001:db8::1");
-    CHECK(peers[0].port == 443);
+    CHECK(peers[0].ip() == "2001:db8::1");
+    CHECK(peers[0].port() == 443);
 
-    CHECK(peers[1].ip == "fe80::1");
-    CHECK(peers[1].port == 80);
+    CHECK(peers[1].ip() == "fe80::1");
+    CHECK(peers[1].port() == 80);
 
     // inet_ntop for v4-mapped should render "::ffff:192.0.2.128"
-    CHECK(peers[2].ip == "::ffff:192.0.2.128");
-    CHECK(peers[2].port == 6881);
+    CHECK(peers[2].ip() == "::ffff:192.0.2.128");
+    CHECK(peers[2].port() == 6881);
 }
 
 TEST_CASE("IPv6: boundary ports 0 and 65535") {
@@ -164,8 +170,8 @@ TEST_CASE("IPv6: boundary ports 0 and 65535") {
     });
     auto peers = CompactPeerCodec::parseIPv6(raw);
     REQUIRE(peers.size() == 2);
-    CHECK(peers[0].port == 0);
-    CHECK(peers[1].port == 65535);
+    CHECK(peers[0].port() == 0);
+    CHECK(peers[1].port() == 65535);
 }
 
 
@@ -192,7 +198,53 @@ TEST_CASE("Determinism: same input yields identical output") {
     auto b = CompactPeerCodec::parseIPv4(raw);
     REQUIRE(a.size() == b.size());
     for (size_t i = 0; i < a.size(); ++i) {
-        CHECK(a[i].ip == b[i].ip);
-        CHECK(a[i].port == b[i].port);
+        CHECK(a[i].ip() == b[i].ip());
+        CHECK(a[i].port() == b[i].port());
+    }
+}
+
+
+// ------------------------------- Tests: Decoders --------------------------------
+
+TEST_CASE("Decoders: every implementation matches the portable one at every length") {
+    const auto& all = CompactPeerCodec::decoders();
+    REQUIRE(!all.empty());
+    CHECK(std::string(all.front().name) == "portable");
+    CHECK(&CompactPeerCodec::decoder() == &all.back());
+
+    std::string blob(18 * 40, '\0');
+    for (size_t i = 0; i < blob.size(); ++i) blob[i] = static_cast<char>((i * 131 + 7) ^ (i >> 3));
+    const auto* in = reinterpret_cast<const uint8_t*>(blob.data());
+
+    for (size_t n = 0; n <= 40; ++n) {
+        std::vector<PeerEndpoint> want4(n), want6(n);
+        all.front().v4(in, n, want4.data());
+        all.front().v6(in, n, want6.data());
+
+        for (const auto& d : all) {
+            INFO(d.name << " n=" << n);
+            // Poisoned output: every byte must be written, including the zero padding.
+            std::vector<PeerEndpoint> got4(n + 1), got6(n + 1);
+            poison(got4);
+            poison(got6);
+            d.v4(in, n, got4.data());
+            d.v6(in, n, got6.data());
+
+            CHECK(std::equal(want4.begin(), want4.end(), got4.begin()));
+            CHECK(std::equal(want6.begin(), want6.end(), got6.begin()));
+            CHECK(got4[n].family == 0xEE);      // nothing written past the last record
+            CHECK(got6[n].family == 0xEE);
+        }
     }
+
+    // The portable output itself: record 1 of the blob, both families.
+    std::vector<PeerEndpoint> one(1);
+    all.front().v4(in + 6, 1, one.data());
+    CHECK(one[0].family == PeerEndpoint::kV4);
+    CHECK(std::memcmp(one[0].addr.data(), in + 6, 4) == 0);
+    CHECK(one[0].port() == ((in[10] << 8) | in[11]));
+    all.front().v6(in + 18, 1, one.data());
+    CHECK(one[0].family == PeerEndpoint::kV6);
+    CHECK(std::memcmp(one[0].addr.data(), in + 18, 16) == 0);
+    CHECK(one[0].port() == ((in[34] << 8) | in[35]));
 }
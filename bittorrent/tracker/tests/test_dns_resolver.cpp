@@ -0,0 +1,181 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "../include/dns_resolver.hpp"
+
+using namespace bittorrent::tracker;
+using namespace std::chrono_literals;
+
+// --------------------- helpers ---------------------
+static ResolvedAddr v4(const char* ip) {
+    ResolvedAddr r;
+    auto& a = reinterpret_cast<sockaddr_in&>(r.addr);
+    a.sin_family = AF_INET;
+    ::inet_pton(AF_INET, ip, &a.sin_addr);
+    r.len = sizeof(sockaddr_in);
+    return r;
+}
+
+static std::string ip_of(const ResolvedAddr& r) {
+    char buf[INET6_ADDRSTRLEN] = {0};
+    if (r.addr.ss_family == AF_INET)
+        ::inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in&>(r.addr).sin_addr, buf, sizeof(buf));
+    else
+        ::inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6&>(r.addr).sin6_addr, buf, sizeof(buf));
+    return buf;
+}
+
+// Fake lookup: counts calls, optionally blocks until released
+struct FakeDns {
+    std::atomic<int> calls{0};
+    std::mutex mu;
+    std::condition_variable cv;
+    bool gate{true};
+
+    std::function<Expected<ResolvedAddrs>(const std::string&)> fn() {
+        return [this](const std::string& host) {
+            ++calls;
+            std::unique_lock<std::mutex> lk(mu);
+            cv.wait(lk, [this] { return gate; });
+            if (host == "tracker.example") return Expected<ResolvedAddrs>::success({v4("10.1.2.3")});
+            return Expected<ResolvedAddrs>::failure("dns: NXDOMAIN " + host);
+        };
+    }
+    void hold() { std::lock_guard<std::mutex> lk(mu); gate = false; }
+    void release() { { std::lock_guard<std::mutex> lk(mu); gate = true; } cv.notify_all(); }
+};
+
+// --------------------- TESTS ---------------------
+
+TEST_CASE("DnsResolver: numeric hosts are answered inline") {
+    FakeDns dns;
+    DnsResolverConfig cfg; cfg.lookup = dns.fn();
+    DnsResolver r(cfg);
+
+    auto a = r.resolveSync("192.0.2.7");
+    REQUIRE(a.has_value());
+    CHECK(ip_of(a.get().at(0)) == "192.0.2.7");
+
+    auto b = r.resolveSync("[2001:db8::1]");
+    REQUIRE(b.has_value());
+    CHECK(b.get().at(0).addr.ss_family == AF_INET6);
+    CHECK(ip_of(b.get().at(0)) == "2001:db8::1");
+
+    CHECK(dns.calls == 0);
+}
+
+TEST_CASE("DnsResolver: positive results are cached until their TTL") {
+    FakeDns dns;
+    DnsResolverConfig cfg; cfg.lookup = dns.fn();
+    cfg.positiveTtl = 1s;
+    DnsResolver r(cfg);
+
+    for (int i = 0; i < 5; ++i) {
+        auto a = r.resolveSync("tracker.example");
+        REQUIRE(a.has_value());
+        CHECK(ip_of(a.get().at(0)) == "10.1.2.3");
+    }
+    CHECK(dns.calls == 1);
+    CHECK(r.stats().hits == 4);
+
+    std::this_thread::sleep_for(1100ms);
+    REQUIRE(r.resolveSync("tracker.example").has_value());
+    CHECK(dns.calls == 2);
+}
+
+TEST_CASE("DnsResolver: failures are negatively cached") {
+    FakeDns dns;
+    DnsResolverConfig cfg; cfg.lookup = dns.fn();
+    DnsResolver r(cfg);
+
+    auto a = r.resolveSync("nope.invalid");
+    REQUIRE_FALSE(a.has_value());
+    CHECK(a.error->message.find("NXDOMAIN") != std::string::npos);
+
+    auto b = r.resolveSync("nope.invalid");
+    REQUIRE_FALSE(b.has_value());
+    CHECK(dns.calls == 1);
+}
+
+TEST_CASE("DnsResolver: tryCached answers numeric hosts and cache hits only") {
+    FakeDns dns;
+    DnsResolverConfig cfg; cfg.lookup = dns.fn();
+    DnsResolver r(cfg);
+
+    ResolvedAddrs out;
+    REQUIRE(r.tryCached("[2001:db8::1]", out));
+    REQUIRE(out.size() == 1);
+    CHECK(ip_of(out[0]) == "2001:db8::1");
+
+    CHECK_FALSE(r.tryCached("tracker.example", out));     // never looked up: resolve() must
+    CHECK_FALSE(r.tryCached(std::string(300, '1'), out)); // too long to be a literal
+    CHECK(dns.calls == 0);
+
+    REQUIRE(r.resolveSync("tracker.example").has_value());
+    REQUIRE(r.tryCached("tracker.example", out));
+    REQUIRE(out.size() == 1);
+    CHECK(ip_of(out[0]) == "10.1.2.3");
+
+    REQUIRE_FALSE(r.resolveSync("nope.invalid").has_value());
+    CHECK_FALSE(r.tryCached("nope.invalid", out));         // failures go through resolve()
+    CHECK(dns.calls == 2);
+}
+
+TEST_CASE("DnsResolver: concurrent requests for one host share a lookup") {
+    FakeDns dns;
+    DnsResolverConfig cfg; cfg.lookup = dns.fn();
+    cfg.threads = 4;
+    DnsResolver r(cfg);
+
+    dns.hold();
+    std::vector<std::future<Expected<ResolvedAddrs>>> futs;
+    for (int i = 0; i < 16; ++i) {
+        auto p = std::make_shared<std::promise<Expected<ResolvedAddrs>>>();
+        futs.push_back(p->get_future());
+        r.resolve("tracker.example", [p](Expected<ResolvedAddrs> res) { p->set_value(std::move(res)); });
+    }
+    dns.release();
+
+    for (auto& f : futs) {
+        REQUIRE(f.wait_for(2s) == std::future_status::ready);
+        CHECK(f.get().has_value());
+    }
+    CHECK(dns.calls == 1);
+    CHECK(r.stats().coalesced == 15);
+}
+
+TEST_CASE("DnsResolver: the cache stays at maxEntries; the soonest to expire goes first") {
+    DnsResolverConfig cfg;
+    cfg.maxEntries = 4;
+    cfg.lookup = [](const std::string&) { return Expected<ResolvedAddrs>::success({v4("10.1.2.3")}); };
+    DnsResolver dns(cfg);
+
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(dns.resolveSync("host" + std::to_string(i) + ".example").has_value());
+        CHECK(dns.cacheSize() == std::min<std::size_t>(i + 1, 4));
+    }
+
+    ResolvedAddrs out;
+    CHECK_FALSE(dns.tryCached("host5.example", out));
+    for (int i = 6; i < 10; ++i) CHECK(dns.tryCached("host" + std::to_string(i) + ".example", out));
+
+    REQUIRE(dns.resolveSync("host9.example").has_value());    // a hit: nothing is evicted
+    CHECK(dns.cacheSize() == 4);
+}
+
+TEST_CASE("DnsResolver: system lookup resolves localhost") {
+    auto a = DnsResolver::systemLookup("localhost");
+    REQUIRE(a.has_value());
+    CHECK_FALSE(a.get().empty());
+}
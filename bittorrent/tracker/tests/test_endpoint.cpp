@@ -118,3 +118,24 @@ TEST_CASE("TrackerTier: anyAvailable reflects endpoints' availability") {
     }
     REQUIRE_FALSE(tier.anyAvailable(clock_steady::now()));
 }
+
+TEST_CASE("TrackerTier: promote moves a tracker to the front and keeps the others' order") {
+    TrackerTier tier;
+    for (const char* u : {"http://a", "http://b", "http://c", "http://d"}) {
+        tier.endpoints.push_back(TrackerEndpoint{ .url = u, .scheme = Scheme::http });
+    }
+    tier.rotate();
+
+    tier.promote(2);
+    REQUIRE(tier.endpoints.size() == 4);
+    CHECK(tier.endpoints[0].url == "http://c");
+    CHECK(tier.endpoints[1].url == "http://a");
+    CHECK(tier.endpoints[2].url == "http://b");
+    CHECK(tier.endpoints[3].url == "http://d");
+    CHECK(tier.current().url == "http://c");
+
+    tier.promote(0);                            // already in front
+    CHECK(tier.endpoints[0].url == "http://c");
+    tier.promote(9);                            // out of range: no-op
+    CHECK(tier.endpoints[3].url == "http://d");
+}
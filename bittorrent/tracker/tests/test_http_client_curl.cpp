@@ -0,0 +1,250 @@
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/http_tracker.hpp"
+#include "../include/dns_resolver.hpp"
+#include "fake_http_server.hpp"
+
+using namespace bittorrent::tracker;
+using namespace std::chrono_literals;
+
+// --------------------- helpers ---------------------
+static FakeHttpReply echo(const std::string& target) {
+    if (target.rfind("/missing", 0) == 0) return {404, "not here"};
+    return {200, "ok " + target};
+}
+
+// --------------------- TESTS ---------------------
+
+TEST_CASE("curl multi client: sequential requests reuse one kept-alive connection") {
+    FakeHttpServer srv(echo);
+    REQUIRE(srv.start());
+
+    auto client = makeCurlMultiClient(std::make_shared<DnsResolver>(), {});
+    for (int i = 0; i < 5; ++i) {
+        auto r = client->get(srv.url("/announce?n=" + std::to_string(i)), 5, 5, true);
+        REQUIRE(r.has_value());
+        CHECK(r.get().status == 200);
+        CHECK(r.get().body == "ok /announce?n=" + std::to_string(i));
+    }
+    CHECK(srv.requests() == 5);
+    CHECK(srv.connections() == 1);
+}
+
+TEST_CASE("curl multi client: concurrent callers share the I/O thread and connection pool") {
+    FakeHttpServer srv([](const std::string& target) {
+        return FakeHttpReply{200, target, 50ms};
+    });
+    REQUIRE(srv.start());
+
+    CurlMultiConfig cfg;
+    cfg.maxHostConnections = 4;
+    auto client = makeCurlMultiClient(nullptr, cfg);
+
+    constexpr int kCallers = 16;
+    std::atomic<int> ok{0};
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> callers;
+    for (int i = 0; i < kCallers; ++i) {
+        callers.emplace_back([&, i] {
+            const std::string path = "/announce?i=" + std::to_string(i);
+            auto r = client->get(srv.url(path), 5, 5, true);
+            if (r.has_value() && r.get().body == path) ++ok;
+        });
+    }
+    for (auto& t : callers) t.join();
+    const auto elapsed = std::chrono::steady_clock::now() - t0;
+
+    CHECK(ok == kCallers);
+    CHECK(srv.connections() <= 4);                  // capped per host, then reused
+    CHECK(elapsed < kCallers * 50ms);               // overlapped, not serialised
+}
+
+TEST_CASE("curl multi client: HTTP errors and refused connections are failures") {
+    FakeHttpServer srv(echo);
+    REQUIRE(srv.start());
+    auto client = makeCurlMultiClient(std::make_shared<DnsResolver>(), {});
+
+    auto notFound = client->get(srv.url("/missing"), 5, 5, true);
+    REQUIRE_FALSE(notFound.has_value());
+    CHECK(notFound.error->message == "HTTP status 404");
+
+    const std::string dead = srv.url("/announce");
+    srv.stop();
+    auto refused = client->get(dead, 2, 2, true);
+    REQUIRE_FALSE(refused.has_value());
+    CHECK(refused.error->message.rfind("curl error: ", 0) == 0);
+}
+
+TEST_CASE("curl multi client: unresolvable hosts fail through the resolver") {
+    DnsResolverConfig dcfg;
+    dcfg.lookup = [](const std::string& host) {
+        return Expected<ResolvedAddrs>::failure("dns: NXDOMAIN " + host);
+    };
+    auto client = makeCurlMultiClient(std::make_shared<DnsResolver>(dcfg), {});
+
+    auto r = client->get("http://tracker.invalid:6969/announce", 2, 2, true);
+    REQUIRE_FALSE(r.has_value());
+    CHECK(r.error->message == "dns: NXDOMAIN tracker.invalid");
+}
+
+TEST_CASE("curl multi client: getAsync does not block and a slow request does not hold up others") {
+    FakeHttpServer srv([](const std::string& target) {
+        if (target == "/slow") return FakeHttpReply{200, "slow", 1500ms};
+        return FakeHttpReply{200, "fast"};
+    });
+    REQUIRE(srv.start());
+    auto client = makeCurlMultiClient(nullptr, {});
+
+    std::promise<Expected<HttpResponse>> slow, fast;
+    const auto t0 = std::chrono::steady_clock::now();
+    client->getAsync(srv.url("/slow"), 5, 5, true, [&](Expected<HttpResponse> r) { slow.set_value(std::move(r)); });
+    client->getAsync(srv.url("/fast"), 5, 5, true, [&](Expected<HttpResponse> r) { fast.set_value(std::move(r)); });
+    CHECK(std::chrono::steady_clock::now() - t0 < 200ms);   // returned without waiting
+
+    auto f = fast.get_future().get();
+    CHECK(std::chrono::steady_clock::now() - t0 < 1000ms);  // not queued behind /slow
+    REQUIRE(f.has_value());
+    CHECK(f.get().body == "fast");
+
+    auto s = slow.get_future().get();
+    REQUIRE(s.has_value());
+    CHECK(s.get().body == "slow");
+}
+
+TEST_CASE("curl multi client: cancel completes the callback once and frees the client") {
+    FakeHttpServer srv([](const std::string& target) {
+        if (target == "/slow") return FakeHttpReply{200, "slow", 2000ms};
+        return FakeHttpReply{200, "fast"};
+    });
+    REQUIRE(srv.start());
+    auto client = makeCurlMultiClient(nullptr, {});
+
+    std::atomic<int> calls{0};
+    std::promise<Expected<HttpResponse>> done;
+    auto handle = client->getAsync(srv.url("/slow"), 5, 5, true, [&](Expected<HttpResponse> r) {
+        if (calls++ == 0) done.set_value(std::move(r));
+    });
+    REQUIRE(handle);
+    std::this_thread::sleep_for(100ms);     // let the transfer start
+
+    const auto t0 = std::chrono::steady_clock::now();
+    handle.cancel();
+    handle.cancel();                        // idempotent
+    auto r = done.get_future().get();
+    CHECK(std::chrono::steady_clock::now() - t0 < 200ms);
+    REQUIRE_FALSE(r.has_value());
+    CHECK(r.error->message == "http: cancelled");
+
+    // The client is still usable and never reports the cancelled transfer again.
+    auto next = client->get(srv.url("/fast"), 5, 5, true);
+    REQUIRE(next.has_value());
+    CHECK(next.get().body == "fast");
+    std::this_thread::sleep_for(100ms);
+    CHECK(calls == 1);
+}
+
+TEST_CASE("fake HTTP tracker: compact, dict peers, peers6, failures, redirects, padding") {
+    AnnounceRequest req{};
+    req.port = 6881;
+
+    SECTION("compact peers + peers6 through a redirect chain") {
+        FakeHttpTrackerConfig cfg;
+        cfg.peers = 30;
+        cfg.peers6 = 5;
+        cfg.redirectHops = 2;
+        FakeHttpTracker srv(cfg);
+        REQUIRE(srv.start());
+
+        for (auto client : {makeCurlClient(nullptr), makeCurlMultiClient(nullptr, {})}) {
+            HttpTracker tracker(client);
+            auto r = tracker.announce(req, srv.url());
+            REQUIRE(r.has_value());
+            CHECK(r.get().peers.size() == 35);
+            CHECK(r.get().peers.front().ip() == "10.0.0.0");
+            CHECK(r.get().peers.back().ip() == "2001:db8::401");
+            CHECK(r.get().complete == 10);
+        }
+        CHECK(srv.counters().redirects == 4);
+        CHECK(srv.counters().announces == 2);
+    }
+
+    SECTION("non-compact dict list, padded body") {
+        FakeHttpTrackerConfig cfg;
+        cfg.peers = 3;
+        cfg.minBodyBytes = 4096;
+        FakeHttpTracker srv(cfg);
+        REQUIRE(srv.start());
+
+        HttpTracker tracker(makeCurlMultiClient(nullptr, {}));
+        req.compact = false;
+        auto r = tracker.announce(req, srv.url());
+        REQUIRE(r.has_value());
+        REQUIRE(r.get().peers.size() == 3);
+        CHECK(r.get().peers[2].ip() == "10.0.0.2");
+        CHECK(r.get().peers[2].port() == 6883);
+        CHECK(srv.counters().bytesOut >= 4096);
+    }
+
+    SECTION("failure reasons and scrape") {
+        FakeHttpTrackerConfig cfg;
+        cfg.failureRate = 1.0;
+        FakeHttpTracker srv(cfg);
+        REQUIRE(srv.start());
+
+        HttpTracker tracker(makeCurlMultiClient(nullptr, {}));
+        auto r = tracker.announce(req, srv.url());
+        REQUIRE_FALSE(r.has_value());
+        CHECK(r.error->message == "stand-in failure");
+
+        InfoHash ih{};
+        ih.bytes.fill(0xAB);
+        auto s = tracker.scrape({ih}, srv.url("/scrape"));
+        REQUIRE(s.has_value());
+        REQUIRE(s.get().count(ih) == 1);
+        CHECK(s.get().at(ih).downloaded == 50);
+    }
+}
+
+TEST_CASE("compressed tracker replies: Accept-Encoding advertised, bodies inflated on the fly") {
+    FakeHttpTrackerConfig cfg;
+    cfg.peers = 200;
+    cfg.compress = true;
+    FakeHttpTracker srv(cfg);
+    REQUIRE(srv.start());
+
+    AnnounceRequest req{};
+    req.port = 6881;
+    req.compact = false;    // the dict list is what compresses best
+
+    for (auto client : {makeCurlClient(nullptr), makeCurlMultiClient(nullptr, {})}) {
+        HttpTracker tracker(client);
+        auto r = tracker.announce(req, srv.url());
+        REQUIRE(r.has_value());
+        REQUIRE(r.get().peers.size() == 200);
+        CHECK(r.get().peers[199].ip() == "10.0.0.199");
+        CHECK(r.get().peers[199].port() == 6881 + 199);
+
+        std::vector<InfoHash> hashes(50);
+        for (std::size_t i = 0; i < hashes.size(); ++i) hashes[i].bytes.fill(static_cast<uint8_t>(i));
+        auto s = tracker.scrape(hashes, srv.url("/scrape"));
+        REQUIRE(s.has_value());
+        CHECK(s.get().size() == 50);
+    }
+    const auto c = srv.counters();
+    CHECK(c.compressed == c.announces + c.scrapes);
+    CHECK(c.bytesOut * 3 < c.bodyBytes);
+
+    // Opting out of the header gets identity bodies back.
+    CurlMultiConfig plain;
+    plain.acceptEncoding = false;
+    HttpTracker tracker(makeCurlMultiClient(nullptr, plain));
+    REQUIRE(tracker.announce(req, srv.url()).has_value());
+    CHECK(srv.counters().compressed == c.compressed);
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include <array>
 #include <optional>
+#include <string_view>
 
 #include "../include/http_tracker.hpp"
 #include "../include/http_client.hpp"
@@ -169,8 +170,8 @@ TEST_CASE("announce parse: compact IPv4 peers + stats + tracker id + warning") {
     REQUIRE(a.trackerId.value() == "trk-42");
 
     REQUIRE(a.peers.size() == 1);
-    CHECK(a.peers[0].ip == "1.2.3.4");
-    CHECK(a.peers[0].port == 6881);
+    CHECK(a.peers[0].ip() == "1.2.3.4");
+    CHECK(a.peers[0].port() == 6881);
 }
 
 TEST_CASE("announce parse: peers6 (compact IPv6)") {
@@ -192,8 +193,8 @@ TEST_CASE("announce parse: peers6 (compact IPv6)") {
     auto r = tracker.announce(req, "http://t/announce");
     REQUIRE(r.has_value());
     REQUIRE(r.get().peers.size() == 1);
-    CHECK(r.get().peers[0].ip == "::1");
-    CHECK(r.get().peers[0].port == 51413);
+    CHECK(r.get().peers[0].ip() == "::1");
+    CHECK(r.get().peers[0].port() == 51413);
 }
 
 TEST_CASE("announce parse: non-compact peer list of dicts") {
@@ -222,10 +223,10 @@ TEST_CASE("announce parse: non-compact peer list of dicts") {
     REQUIRE(r.has_value());
     const auto& peers = r.get().peers;
     REQUIRE(peers.size() == 2);
-    CHECK(peers[0].ip == "9.8.7.6");
-    CHECK(peers[0].port == 1234);
-    CHECK(peers[1].ip == "127.0.0.1");
-    CHECK(peers[1].port == 80);
+    CHECK(peers[0].ip() == "9.8.7.6");
+    CHECK(peers[0].port() == 1234);
+    CHECK(peers[1].ip() == "127.0.0.1");
+    CHECK(peers[1].port() == 80);
 }
 
 TEST_CASE("announce parse: not a dict -> error") {
@@ -303,3 +304,119 @@ TEST_CASE("scrape parse: non-dict root -> error") {
     auto r = tracker.scrape({}, "http://t/scrape");
     REQUIRE_FALSE(r.has_value());
 }
+
+TEST_CASE("scrape parse: malformed bencode -> error, not an exception") {
+    auto http = std::make_shared<CapturingHttp>();
+    HttpTracker tracker(http);
+
+    http->body = "d5:files";
+
+    auto r = tracker.scrape({}, "http://t/scrape");
+    REQUIRE_FALSE(r.has_value());
+    CHECK(r.error->message.rfind("scrape body: ", 0) == 0);
+}
+
+// ---------- Async forms ------------------------------------------------------
+
+TEST_CASE("announceAsync/scrapeAsync: same URL and parsing as the blocking calls") {
+    auto http = std::make_shared<CapturingHttp>();
+    HttpTracker tracker(http);
+
+    std::map<std::string, bencode::BencodeValue> root;
+    root["interval"] = bencode::BencodeValue((int64_t)900);
+    root["peers"] = bencode::BencodeValue(std::string("\x0A\x00\x00\x01\x1A\xE1", 6));
+    http->body = ben(bencode::BencodeValue(std::move(root)));
+
+    AnnounceRequest req{}; req.infoHash.bytes = seq20(); req.peerId.bytes = seq20(); req.port = 6881;
+    (void)tracker.announce(req, "http://t/announce");
+    const std::string syncUrl = http->last_url;
+
+    std::optional<Expected<AnnounceResponse>> got;
+    tracker.announceAsync(req, "http://t/announce", [&](Expected<AnnounceResponse> r) { got = std::move(r); });
+
+    // CapturingHttp has no event loop, so the default getAsync completes inline.
+    REQUIRE(got.has_value());
+    CHECK(http->last_url == syncUrl);
+    REQUIRE(got->has_value());
+    CHECK(got->get().interval == 900);
+    REQUIRE(got->get().peers.size() == 1);
+    CHECK(got->get().peers[0].ip() == "10.0.0.1");
+    CHECK(got->get().peers[0].port() == 6881);
+
+    http->status = 503;
+    std::optional<Expected<std::map<InfoHash, ScrapeStats>>> scraped;
+    tracker.scrapeAsync({}, "http://t/scrape", [&](Expected<std::map<InfoHash, ScrapeStats>> r) { scraped = std::move(r); });
+    REQUIRE(scraped.has_value());
+    REQUIRE_FALSE(scraped->has_value());
+    CHECK(scraped->error->message == "HTTP status 503");
+}
+
+// ---------- Multi-hash scrape ------------------------------------------------
+
+// Answers every scrape with stats for the (percent-decoded) info_hash values in its query.
+struct ScrapeEchoHttp : IHttpClient {
+    std::vector<std::string> urls;
+
+    static std::string decode(std::string_view s) {
+        std::string out;
+        for (size_t i = 0; i < s.size(); ++i) {
+            if (s[i] == '%' && i + 2 < s.size()) { out += static_cast<char>(std::stoi(std::string(s.substr(i + 1, 2)), nullptr, 16)); i += 2; }
+            else out += s[i];
+        }
+        return out;
+    }
+
+    Expected<HttpResponse> get(const std::string& url, int, int, bool) override {
+        urls.push_back(url);
+        std::map<std::string, bencode::BencodeValue> files;
+        for (size_t at = url.find("info_hash="); at != std::string::npos; at = url.find("info_hash=", at + 1)) {
+            const size_t start = at + 10, end = url.find('&', start);
+            const std::string ih = decode(std::string_view(url).substr(start, end == std::string::npos ? std::string::npos : end - start));
+            files[ih] = bencode::BencodeValue(std::map<std::string, bencode::BencodeValue>{
+                {"complete", bencode::BencodeValue((int64_t)(unsigned char)ih[0])}});
+        }
+        return Expected<HttpResponse>::success({200, ben(bencode::BencodeValue(std::map<std::string, bencode::BencodeValue>{
+            {"files", bencode::BencodeValue(std::move(files))}}))});
+    }
+};
+
+TEST_CASE("scrape: repeated info_hash parameters, split by URL length, merged into one map") {
+    auto http = std::make_shared<ScrapeEchoHttp>();
+    HttpTrackerConfig cfg;
+    cfg.maxScrapeUrlLength = 500;
+    HttpTracker tracker(http, cfg);
+
+    std::vector<InfoHash> hashes(100);
+    for (size_t i = 0; i < hashes.size(); ++i) { hashes[i].bytes = seq20(); hashes[i].bytes[0] = static_cast<std::uint8_t>(i); }
+
+    auto r = tracker.scrape(hashes, "http://t/scrape?passkey=abc");
+    REQUIRE(r.has_value());
+    CHECK(r.get().size() == 100);
+    for (const auto& ih : hashes) {
+        auto it = r.get().find(ih);
+        REQUIRE(it != r.get().end());
+        CHECK(it->second.complete == ih.bytes[0]);
+    }
+
+    // 27-byte base + 71 bytes per "&info_hash=<60 encoded>" -> 6 hashes per URL, 17 requests.
+    CHECK(http->urls.size() == 17);
+    size_t params = 0;
+    for (const auto& u : http->urls) {
+        CHECK(u.size() <= 500);
+        CHECK(u.rfind("http://t/scrape?passkey=abc&info_hash=", 0) == 0);
+        for (size_t at = u.find("info_hash="); at != std::string::npos; at = u.find("info_hash=", at + 1)) ++params;
+    }
+    CHECK(params == 100);
+}
+
+TEST_CASE("scrape: no hashes fetches the URL as-is; tracker failure reason is an error") {
+    auto http = std::make_shared<CapturingHttp>();
+    HttpTracker tracker(http);
+
+    http->body = ben(bencode::BencodeValue(std::map<std::string, bencode::BencodeValue>{
+        {"failure reason", bencode::BencodeValue(std::string("scrape disabled"))}}));
+    auto r = tracker.scrape({}, "http://t/scrape");
+    CHECK(http->last_url == "http://t/scrape");
+    REQUIRE_FALSE(r.has_value());
+    CHECK(r.error->message == "scrape disabled");
+}
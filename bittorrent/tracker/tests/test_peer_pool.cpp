@@ -0,0 +1,140 @@
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "../include/peer_pool.hpp"
+
+using namespace bittorrent::tracker;
+using namespace std::chrono_literals;
+
+// --------------------- helpers ---------------------
+static const PeerPool::Clock::time_point T0{};
+
+static PeerEndpoint ep4(uint32_t n, uint16_t port = 6881) {
+    const uint8_t a[4] = {10, static_cast<uint8_t>(n >> 16), static_cast<uint8_t>(n >> 8), static_cast<uint8_t>(n)};
+    return PeerEndpoint::v4(a, port);
+}
+
+// --------------------- TESTS ---------------------
+
+TEST_CASE("PeerPool: duplicates from any source are merged and drained once") {
+    PeerPool pool(100);
+    std::vector<PeerEndpoint> fresh;
+
+    CHECK(pool.add({ep4(1), ep4(2), ep4(1), ep4(3)}, PeerSource::tracker, T0, &fresh) == 3);
+    CHECK(fresh == std::vector<PeerEndpoint>{ep4(1), ep4(2), ep4(3)});
+    CHECK_FALSE(pool.add(ep4(2), PeerSource::dht, T0 + 1s));
+    CHECK(pool.add(ep4(2, 6882), PeerSource::pex, T0 + 1s));    // other port, other peer
+    CHECK_FALSE(pool.add(PeerEndpoint{}, PeerSource::pex, T0)); // empty endpoints are ignored
+    CHECK(pool.size() == 4);
+    CHECK(pool.pendingCount() == 4);
+
+    const auto* e = pool.find(ep4(2));
+    REQUIRE(e != nullptr);
+    CHECK(e->source == PeerSource::tracker);
+    CHECK(e->sources == ((1u << int(PeerSource::tracker)) | (1u << int(PeerSource::dht))));
+    CHECK(e->firstSeen == T0);
+
+    CHECK(pool.drainNew().size() == 4);
+    CHECK(pool.pendingCount() == 0);
+    CHECK(pool.drainNew().empty());
+
+    // Seen again after being handed out: still known, not handed out again.
+    fresh.clear();
+    CHECK(pool.add({ep4(1), ep4(3)}, PeerSource::tracker, T0 + 5s, &fresh) == 0);
+    CHECK(fresh.empty());
+    CHECK(pool.drainNew().empty());
+    CHECK(pool.size() == 4);
+}
+
+TEST_CASE("PeerPool: drainNew ranks by source, corroboration and failures") {
+    PeerPool pool(100);
+    pool.add(ep4(1), PeerSource::dht, T0);
+    pool.add(ep4(2), PeerSource::pex, T0);
+    pool.add(ep4(3), PeerSource::tracker, T0 + 2s);
+    pool.add(ep4(4), PeerSource::tracker, T0 + 1s);
+    pool.add(ep4(5), PeerSource::lsd, T0);
+    pool.add(ep4(6), PeerSource::dht, T0 + 1s);
+    pool.add(ep4(6), PeerSource::pex, T0 + 1s);     // two sources beat one
+    pool.add(ep4(7), PeerSource::tracker, T0);
+    pool.recordFailure(ep4(7));                     // a failed connect sinks it
+
+    CHECK(pool.find(ep4(6))->score > pool.find(ep4(1))->score);
+    CHECK(pool.find(ep4(7))->failures == 1);
+
+    // Top three only; equal scores (4 and 3, later 2 and 6) go to the earlier sighting.
+    CHECK(pool.drainNew(3) == std::vector<PeerEndpoint>{ep4(5), ep4(4), ep4(3)});
+    CHECK(pool.pendingCount() == 4);
+    CHECK(pool.drainNew() == std::vector<PeerEndpoint>{ep4(2), ep4(6), ep4(1), ep4(7)});
+
+    pool.recordSuccess(ep4(7));
+    CHECK(pool.find(ep4(7))->failures == 0);
+    pool.recordFailure(ep4(99));                    // unknown endpoints are ignored
+    CHECK(pool.find(ep4(99)) == nullptr);
+}
+
+TEST_CASE("PeerPool: the cap holds and eviction prefers peers already handed out") {
+    PeerPool pool(64);
+    for (uint32_t i = 0; i < 64; ++i) pool.add(ep4(i), PeerSource::tracker, T0);
+    CHECK(pool.drainNew().size() == 64);
+
+    for (uint32_t i = 1000; i < 1032; ++i) CHECK(pool.add(ep4(i), PeerSource::tracker, T0 + 1s));
+    CHECK(pool.size() == 64);
+    CHECK(pool.evictions() == 32);
+
+    // None of the 32 newcomers was evicted to make room for another.
+    const auto next = pool.drainNew();
+    CHECK(next.size() == 32);
+    for (uint32_t i = 1000; i < 1032; ++i) CHECK(pool.find(ep4(i)) != nullptr);
+
+    // A flood far past the cap never grows the pool.
+    for (uint32_t i = 0; i < 100000; ++i) pool.add(ep4(50000 + i), PeerSource::dht, T0 + 2s);
+    CHECK(pool.size() == 64);
+    CHECK(pool.pendingCount() <= 64);
+    CHECK(pool.drainNew().size() == pool.size());
+}
+
+TEST_CASE("PeerPool: the table starts small and grows only as far as the cap needs") {
+    PeerPool pool(2000);
+    CHECK(pool.slotCount() == 16);              // nothing sized for 2000 peers up front
+
+    for (uint32_t i = 0; i < 8; ++i) pool.add(ep4(i), PeerSource::tracker, T0);
+    CHECK(pool.slotCount() == 16);
+    pool.add(ep4(8), PeerSource::tracker, T0);
+    CHECK(pool.slotCount() == 32);              // doubles once more than half full
+
+    for (uint32_t i = 9; i < 2000; ++i) pool.add(ep4(i), PeerSource::tracker, T0);
+    CHECK(pool.slotCount() == 4096);
+    std::size_t found = 0;                      // every entry survived each rehash
+    for (uint32_t i = 0; i < 2000; ++i) found += pool.find(ep4(i)) != nullptr;
+    CHECK(found == 2000);
+
+    for (uint32_t i = 2000; i < 10000; ++i) pool.add(ep4(i), PeerSource::tracker, T0);
+    CHECK(pool.size() == 2000);
+    CHECK(pool.slotCount() == 4096);            // the cap, not the traffic, bounds the table
+}
+
+TEST_CASE("PeerPool: random inserts and erases agree with a reference set") {
+    PeerPool pool(512);                             // never full below: no evictions
+    std::set<PeerEndpoint> ref;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint32_t> pick(0, 700);
+
+    for (int step = 0; step < 20000; ++step) {
+        const auto e = ep4(pick(rng), static_cast<uint16_t>(6881 + pick(rng) % 3));
+        if (rng() % 3 == 0) {
+            CHECK(pool.erase(e) == (ref.erase(e) == 1));
+        } else if (ref.size() < 512) {
+            CHECK(pool.add(e, PeerSource::tracker, T0) == ref.insert(e).second);
+        }
+    }
+    CHECK(pool.evictions() == 0);
+    REQUIRE(pool.size() == ref.size());
+    for (const auto& e : ref) CHECK(pool.find(e) != nullptr);
+
+    const auto all = pool.drainNew();
+    CHECK(std::set<PeerEndpoint>(all.begin(), all.end()) == ref);
+}
@@ -0,0 +1,134 @@
+#include <catch2/catch_all.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "../include/peer_queue.hpp"
+
+using namespace bittorrent::tracker;
+using PushResult = PeerBatchQueue::PushResult;
+
+// --------------------- helpers ---------------------
+static PeerEndpoint endpointOf(std::uint32_t producer, std::uint32_t seq) {
+    // 10.p.s.s:port, with the low bits of seq in the port so every (producer, seq) is distinct.
+    const std::array<std::uint8_t, 4> ip{10, static_cast<std::uint8_t>(producer),
+                                         static_cast<std::uint8_t>(seq >> 16), static_cast<std::uint8_t>(seq >> 8)};
+    return PeerEndpoint::v4(ip.data(), static_cast<std::uint16_t>(seq & 0xff) | 0x100);
+}
+
+static PeerBatch batchOf(std::uint32_t producer, std::uint32_t seq, PeerSource src = PeerSource::tracker) {
+    return PeerBatch{src, {endpointOf(producer, seq)}};
+}
+
+// --------------------- TESTS ---------------------
+
+TEST_CASE("PeerBatchQueue: FIFO order, power-of-two capacity, wrap-around") {
+    PeerBatchQueue q(5);
+    CHECK(q.capacity() == 8);
+
+    PeerBatch out;
+    CHECK_FALSE(q.tryPop(out));
+    for (std::uint32_t lap = 0; lap < 5; ++lap) {
+        for (std::uint32_t i = 0; i < 6; ++i) CHECK(q.tryPush(batchOf(0, lap * 6 + i)) != PushResult::full);
+        CHECK(q.size() == 6);
+        for (std::uint32_t i = 0; i < 6; ++i) {
+            REQUIRE(q.tryPop(out));
+            REQUIRE(out.peers.size() == 1);
+            CHECK(out.peers[0] == endpointOf(0, lap * 6 + i));
+        }
+        CHECK_FALSE(q.tryPop(out));
+        CHECK(q.size() == 0);
+    }
+}
+
+TEST_CASE("PeerBatchQueue: a full queue refuses pushes and leaves the batch with the producer") {
+    PeerBatchQueue q(4);
+    for (std::uint32_t i = 0; i < 4; ++i) REQUIRE(q.tryPush(batchOf(1, i)) != PushResult::full);
+
+    PeerBatch extra{PeerSource::dht, {endpointOf(2, 1), endpointOf(2, 2)}};
+    CHECK(q.tryPush(std::move(extra)) == PushResult::full);
+    CHECK(extra.peers.size() == 2);             // still the producer's to drop or retry
+    CHECK(extra.source == PeerSource::dht);
+    CHECK(q.rejected() == 1);
+
+    PeerBatch out;
+    REQUIRE(q.tryPop(out));
+    CHECK(out.peers[0] == endpointOf(1, 0));
+    CHECK(q.tryPush(std::move(extra)) != PushResult::full);
+    for (std::uint32_t i = 1; i < 4; ++i) {
+        REQUIRE(q.tryPop(out));
+        CHECK(out.peers[0] == endpointOf(1, i));
+    }
+    REQUIRE(q.tryPop(out));
+    CHECK(out.source == PeerSource::dht);
+    CHECK(out.peers.size() == 2);
+    CHECK(q.rejected() == 1);
+}
+
+TEST_CASE("PeerBatchQueue: only the first push after park() wakes the consumer") {
+    PeerBatchQueue q(8);
+    PeerBatch out;
+    CHECK_FALSE(q.tryPop(out));                  // no ring allocated yet
+    CHECK(q.park());
+    CHECK(q.tryPush(batchOf(0, 0)) == PushResult::wakeConsumer);    // starts parked
+    CHECK(q.tryPush(batchOf(0, 1)) == PushResult::queued);
+
+    CHECK_FALSE(q.park());                       // batches waiting: drain first
+    CHECK(q.tryPush(batchOf(0, 2)) == PushResult::queued);
+
+    while (q.tryPop(out)) {}
+    CHECK(q.park());
+    CHECK(q.tryPush(batchOf(0, 3)) == PushResult::wakeConsumer);
+    CHECK(q.tryPush(batchOf(0, 4)) == PushResult::queued);
+}
+
+TEST_CASE("PeerBatchQueue: concurrent producers lose nothing and keep their own order") {
+    constexpr std::uint32_t kProducers = 4;
+    constexpr std::uint32_t kPerProducer = 50000;
+    PeerBatchQueue q(64);
+
+    std::atomic<bool> go{false};
+    std::atomic<std::uint64_t> retries{0}, wakes{0};
+    std::vector<std::thread> producers;
+    for (std::uint32_t p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            while (!go) std::this_thread::yield();
+            for (std::uint32_t i = 0; i < kPerProducer; ++i) {
+                PeerBatch b = batchOf(p, i, static_cast<PeerSource>(p % 4));
+                PushResult r;
+                while ((r = q.tryPush(std::move(b))) == PushResult::full) {
+                    ++retries;
+                    std::this_thread::yield();
+                }
+                if (r == PushResult::wakeConsumer) ++wakes;
+            }
+        });
+    }
+
+    std::vector<std::uint32_t> next(kProducers, 0);
+    std::uint64_t received = 0, bad = 0;
+    go = true;
+    PeerBatch out;
+    while (received < std::uint64_t{kProducers} * kPerProducer) {
+        if (!q.tryPop(out)) {
+            (void)q.park();
+            std::this_thread::yield();
+            continue;
+        }
+        ++received;
+        const auto& ep = out.peers.at(0);
+        const std::uint32_t p = ep.addr[1];
+        if (p >= kProducers || ep != endpointOf(p, next[p]) || out.source != static_cast<PeerSource>(p % 4)) ++bad;
+        else ++next[p];
+    }
+    for (auto& t : producers) t.join();
+
+    CHECK(bad == 0);
+    for (auto n : next) CHECK(n == kPerProducer);
+    CHECK_FALSE(q.tryPop(out));
+    CHECK(q.rejected() == retries.load());
+    CHECK(wakes.load() >= 1);
+}
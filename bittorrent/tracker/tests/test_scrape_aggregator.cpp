@@ -0,0 +1,231 @@
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/scrape_aggregator.hpp"
+#include "../include/types.hpp"
+#include "fake_udp_tracker.hpp"
+#include "fake_http_server.hpp"
+#include "../../bencode/bencode.hpp"
+
+using namespace bittorrent::tracker;
+using namespace std::chrono_literals;
+
+// --------------------- helpers ---------------------
+static InfoHash make_infohash(uint32_t seed) {
+    InfoHash ih{};
+    for (size_t i = 0; i < ih.bytes.size(); ++i) ih.bytes[i] = static_cast<uint8_t>((seed >> (8 * (i % 4))) + i);
+    return ih;
+}
+
+static std::string url_for(const FakeUdpTrackerServer& s) {
+    return "udp://127.0.0.1:" + std::to_string(s.port()) + "/scrape";
+}
+
+static std::shared_ptr<UdpTrackerEngine> started_engine() {
+    UdpEngineConfig cfg;
+    cfg.timeout = 100ms;
+    cfg.maxRetransmits = 2;
+    auto eng = std::make_shared<UdpTrackerEngine>(cfg);
+    REQUIRE(eng->start().has_value());
+    return eng;
+}
+
+// Multi-hash HTTP scrape handler: stats for every info_hash= in the query (complete = first byte).
+static FakeHttpReply http_scrape(const std::string& target) {
+    std::map<std::string, bencode::BencodeValue> files;
+    for (size_t at = target.find("info_hash="); at != std::string::npos; at = target.find("info_hash=", at + 1)) {
+        std::string ih;
+        for (size_t i = at + 10; i < target.size() && target[i] != '&'; ++i) {
+            if (target[i] == '%') { ih += static_cast<char>(std::stoi(target.substr(i + 1, 2), nullptr, 16)); i += 2; }
+            else ih += target[i];
+        }
+        files[ih] = bencode::BencodeValue(std::map<std::string, bencode::BencodeValue>{
+            {"complete", bencode::BencodeValue((int64_t)(unsigned char)ih[0])}});
+    }
+    return {200, bencode::BencodeParser::encode(bencode::BencodeValue(std::map<std::string, bencode::BencodeValue>{
+        {"files", bencode::BencodeValue(std::move(files))}}))};
+}
+
+struct Results {
+    std::atomic<int> ok{0}, failed{0};
+    std::string lastError;
+    std::mutex mu;
+
+    ScrapeAggregator::Callback cb() {
+        return [this](Expected<ScrapeStats> r) {
+            if (r.has_value()) { ++ok; return; }
+            std::lock_guard<std::mutex> lk(mu);
+            lastError = r.error->message;
+            ++failed;
+        };
+    }
+    bool waitFor(int n, std::chrono::milliseconds limit = 3000ms) {
+        auto until = std::chrono::steady_clock::now() + limit;
+        while (ok + failed < n && std::chrono::steady_clock::now() < until) std::this_thread::sleep_for(5ms);
+        return ok + failed >= n;
+    }
+};
+
+// --------------------- TESTS ---------------------
+
+TEST_CASE("ScrapeAggregator: 200 torrents become three packets of <= 74 hashes") {
+    FakeUdpTrackerServer server;
+    REQUIRE(server.start());
+    server.setScrapeTriplet(4, 5, 6);
+
+    ScrapeAggregatorConfig cfg;
+    cfg.flushDelay = 50ms;
+    ScrapeAggregator agg(started_engine(), cfg);
+
+    Results res;
+    for (uint32_t i = 0; i < 200; ++i) agg.request(url_for(server), make_infohash(i), res.cb());
+
+    REQUIRE(res.waitFor(200));
+    CHECK(res.ok == 200);
+    CHECK(server.scrapeCount() == 3);   // 74 + 74 + 52 (last one on the flush timer)
+
+    auto st = agg.stats();
+    CHECK(st.requests == 200);
+    CHECK(st.packets == 3);
+    CHECK(st.hashes == 200);
+}
+
+TEST_CASE("ScrapeAggregator: duplicate info-hashes share a slot and all get stats") {
+    FakeUdpTrackerServer server;
+    REQUIRE(server.start());
+    server.setScrapeTriplet(10, 20, 30);
+
+    ScrapeAggregatorConfig cfg;
+    cfg.flushDelay = 20ms;
+    ScrapeAggregator agg(started_engine(), cfg);
+
+    std::promise<ScrapeStats> a, b;
+    agg.request(url_for(server), make_infohash(1), [&](Expected<ScrapeStats> r) { a.set_value(r.get()); });
+    agg.request(url_for(server), make_infohash(1), [&](Expected<ScrapeStats> r) { b.set_value(r.get()); });
+
+    auto fa = a.get_future(), fb = b.get_future();
+    REQUIRE(fa.wait_for(2s) == std::future_status::ready);
+    REQUIRE(fb.wait_for(2s) == std::future_status::ready);
+    CHECK(fa.get().downloaded == 20);
+    CHECK(fb.get().incomplete == 30);
+    CHECK(agg.stats().hashes == 1);
+}
+
+TEST_CASE("ScrapeAggregator: batches are per tracker; flush() sends immediately") {
+    FakeUdpTrackerServer s1, s2;
+    REQUIRE(s1.start());
+    REQUIRE(s2.start());
+
+    ScrapeAggregatorConfig cfg;
+    cfg.flushDelay = 10s;   // only flush() can send these
+    ScrapeAggregator agg(started_engine(), cfg);
+
+    Results res;
+    for (uint32_t i = 0; i < 5; ++i) {
+        agg.request(url_for(s1), make_infohash(i), res.cb());
+        agg.request(url_for(s2), make_infohash(i), res.cb());
+    }
+    std::this_thread::sleep_for(50ms);
+    CHECK(res.ok == 0);
+
+    agg.flush();
+    REQUIRE(res.waitFor(10));
+    CHECK(res.ok == 10);
+    CHECK(s1.scrapeCount() == 1);
+    CHECK(s2.scrapeCount() == 1);
+}
+
+TEST_CASE("ScrapeAggregator: tracker error fans out to every requester") {
+    FakeUdpTrackerServer server;
+    REQUIRE(server.start());
+    server.setErrorOnScrape(true, "scrape disabled");
+
+    ScrapeAggregatorConfig cfg;
+    cfg.flushDelay = 20ms;
+    ScrapeAggregator agg(started_engine(), cfg);
+
+    Results res;
+    for (uint32_t i = 0; i < 3; ++i) agg.request(url_for(server), make_infohash(i), res.cb());
+    agg.request("http://not-udp/scrape", make_infohash(9), res.cb());    // rejected inline
+
+    REQUIRE(res.waitFor(4));
+    CHECK(res.failed == 4);
+    CHECK(res.lastError.find("scrape disabled") != std::string::npos);
+}
+
+TEST_CASE("ScrapeAggregator: stopping the engine fails open batches instead of stranding them") {
+    FakeUdpTrackerServer server;
+    REQUIRE(server.start());
+
+    ScrapeAggregatorConfig cfg;
+    cfg.flushDelay = 10s;
+    auto engine = started_engine();
+    ScrapeAggregator agg(engine, cfg);
+
+    Results res;
+    agg.request(url_for(server), make_infohash(1), res.cb());
+    agg.request(url_for(server), make_infohash(2), res.cb());
+    engine->stop();                             // drops the 10 s flush timer; the batch must not wait on it
+
+    REQUIRE(res.waitFor(2, 1000ms));
+    CHECK(res.failed == 2);
+    CHECK(server.scrapeCount() == 0);
+
+    agg.request(url_for(server), make_infohash(3), res.cb());    // opened after the stop: fails at once
+    CHECK(res.failed == 3);
+}
+
+TEST_CASE("ScrapeAggregator: an HTTP batch still goes out when its timer engine stops") {
+    FakeHttpServer server(http_scrape);
+    REQUIRE(server.start());
+
+    ScrapeAggregatorConfig cfg;
+    cfg.flushDelay = 10s;
+    auto timers = started_engine();
+    ScrapeAggregator agg(std::make_shared<HttpTracker>(makeCurlMultiClient(nullptr, {})), timers, cfg);
+
+    Results res;
+    agg.request(server.url("/scrape"), make_infohash(1), res.cb());
+    agg.request(server.url("/scrape"), make_infohash(2), res.cb());
+    timers->stop();
+
+    REQUIRE(res.waitFor(2, 2000ms));
+    CHECK(res.ok == 2);
+    CHECK(server.requests() == 1);
+}
+
+TEST_CASE("ScrapeAggregator: HTTP scrapes from 200 torrents take a handful of requests") {
+    FakeHttpServer server(http_scrape);
+    REQUIRE(server.start());
+
+    ScrapeAggregatorConfig cfg;
+    cfg.flushDelay = 50ms;
+    ScrapeAggregator agg(std::make_shared<HttpTracker>(makeCurlMultiClient(nullptr, {})), started_engine(), cfg);
+
+    std::atomic<int> ok{0}, wrong{0};
+    for (uint32_t i = 0; i < 200; ++i) {
+        const InfoHash ih = make_infohash(i);
+        agg.request(server.url("/scrape?passkey=k"), ih, [&, ih](Expected<ScrapeStats> r) {
+            if (r.has_value() && r.get().complete == ih.bytes[0]) ++ok; else ++wrong;
+        });
+    }
+    agg.request("udp://not-http/scrape", make_infohash(9), [&](Expected<ScrapeStats> r) {
+        if (!r.has_value()) ++wrong;
+    });
+
+    auto until = std::chrono::steady_clock::now() + 5s;
+    while (ok + wrong < 201 && std::chrono::steady_clock::now() < until) std::this_thread::sleep_for(5ms);
+    CHECK(ok == 200);
+    CHECK(wrong == 1);
+
+    // 74 + 74 + 52 hashes, each batch split into <= 2048-byte URLs (28 hashes each): 3 + 3 + 2.
+    CHECK(agg.stats().packets == 3);
+    CHECK(server.requests() == 8);
+}
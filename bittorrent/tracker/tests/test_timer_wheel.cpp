@@ -0,0 +1,126 @@
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "../include/timer_wheel.hpp"
+
+using namespace bittorrent::tracker;
+using namespace std::chrono_literals;
+
+// Virtual time: every test drives the wheel with explicit time points.
+static const TimerWheel::Clock::time_point T0{};
+
+TEST_CASE("TimerWheel: fires in deadline order, never early") {
+    TimerWheel w(1ms, T0);
+    std::vector<int> order;
+
+    w.schedule(T0 + 30ms, [&] { order.push_back(30); });
+    w.schedule(T0 + 10ms, [&] { order.push_back(10); });
+    w.schedule(T0 + 20ms, [&] { order.push_back(20); });
+    REQUIRE(w.size() == 3);
+    CHECK(w.nextExpiry() == T0 + 10ms);
+
+    CHECK(w.advance(T0 + 9ms) == 0);
+    CHECK(w.advance(T0 + 10ms) == 1);
+    CHECK(w.advance(T0 + 100ms) == 2);
+    CHECK(order == std::vector<int>{10, 20, 30});
+    CHECK(w.size() == 0);
+    CHECK_FALSE(w.nextExpiry().has_value());
+}
+
+TEST_CASE("TimerWheel: cancel removes a pending timer") {
+    TimerWheel w(1ms, T0);
+    int fired = 0;
+    auto a = w.schedule(T0 + 5ms, [&] { ++fired; });
+    w.schedule(T0 + 7ms, [&] { ++fired; });
+
+    CHECK(w.cancel(a));
+    CHECK_FALSE(w.cancel(a));
+    CHECK(w.nextExpiry() == T0 + 7ms);
+    w.advance(T0 + 10ms);
+    CHECK(fired == 1);
+}
+
+TEST_CASE("TimerWheel: BEP 15 style deadlines cascade through all levels") {
+    TimerWheel w(1ms, T0);
+    std::vector<TimerWheel::Clock::time_point> firedAt;
+    TimerWheel::Clock::time_point now = T0;
+
+    // 15 s * 2^n for n = 0..8 (up to 64 minutes), all outstanding at once
+    std::vector<TimerWheel::Clock::time_point> due;
+    for (int n = 0; n <= 8; ++n) {
+        due.push_back(T0 + 15s * (1 << n));
+        w.schedule(due.back(), [&] { firedAt.push_back(now); });
+    }
+
+    // Sleep exactly until nextExpiry() each time, like an event loop would
+    while (auto next = w.nextExpiry()) {
+        REQUIRE(*next > now);
+        now = *next;
+        w.advance(now);
+    }
+    CHECK(firedAt == due);
+}
+
+TEST_CASE("TimerWheel: deadlines beyond the wheel span still fire on time") {
+    TimerWheel w(1ms, T0);
+    bool fired = false;
+    const auto when = T0 + 10h;     // span is 64^4 ms (~4.66 h)
+    w.schedule(when, [&] { fired = true; });
+
+    auto now = T0;
+    while (auto next = w.nextExpiry()) {
+        now = *next;
+        w.advance(now);
+    }
+    CHECK(fired);
+    CHECK(now == when);
+}
+
+TEST_CASE("TimerWheel: callbacks may reschedule; past deadlines fire next tick") {
+    TimerWheel w(1ms, T0);
+    int runs = 0;
+    std::function<void()> again = [&] {
+        if (++runs < 3) w.schedule(T0, again);  // in the past
+    };
+    w.schedule(T0 + 1ms, again);
+
+    w.advance(T0 + 1ms);
+    CHECK(runs == 1);
+    w.advance(T0 + 2ms);
+    CHECK(runs == 2);
+    w.advance(T0 + 50ms);
+    CHECK(runs == 3);
+}
+
+TEST_CASE("TimerWheel: random schedule matches a sorted reference") {
+    TimerWheel w(1ms, T0);
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> ms(1, 600'000);
+
+    std::vector<std::pair<int, int>> expected;  // (due ms, id)
+    std::vector<std::pair<int, int>> got;
+    int now_ms = 0;
+    for (int i = 0; i < 2000; ++i) {
+        const int d = ms(rng);
+        expected.emplace_back(d, i);
+        w.schedule(T0 + std::chrono::milliseconds(d), [&, i] { got.emplace_back(now_ms, i); });
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](auto& a, auto& b) { return a.first < b.first; });
+
+    // Advance in uneven steps rather than following nextExpiry()
+    while (w.size() > 0) {
+        now_ms += 1 + (rng() % 5000);
+        w.advance(T0 + std::chrono::milliseconds(now_ms));
+    }
+
+    REQUIRE(got.size() == expected.size());
+    for (std::size_t i = 0; i < got.size(); ++i) {
+        // Each fires in the first advance() at or after its deadline
+        CHECK(got[i].first >= expected[i].first);
+        CHECK(got[i].first - expected[i].first <= 5000);
+    }
+}
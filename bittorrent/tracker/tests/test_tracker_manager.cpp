@@ -1,5 +1,6 @@
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <condition_variable>
@@ -9,10 +10,13 @@
 #include <unordered_map>
 #include <vector>
 #include <chrono>
+#include <thread>
 
 #include "../include/manager.hpp"
 #include "../include/http_client.hpp"
 #include "../include/types.hpp"
+#include "fake_http_server.hpp"
+#include "fake_udp_tracker.hpp"
 #include "../../bencode/bencode.hpp"
 
 using namespace bencode;
@@ -51,6 +55,8 @@ struct FakeHttpClient : public bt::IHttpClient {
 
     // Exact URL -> response mapping
     std::unordered_map<std::string, Mapping> responses;
+    // URL prefix -> response, for URLs not mapped exactly (guarded by mu)
+    std::vector<std::pair<std::string, Mapping>> prefixes;
 
     // Capture called URLs & allow tests to wait until a call happens
     std::mutex mu;
@@ -61,21 +67,40 @@ struct FakeHttpClient : public bt::IHttpClient {
     bt::Expected<bt::HttpResponse>
     get(const std::string& url, int /*connectTimeoutSec*/, int /*transferTimeoutSec*/, bool /*followRedirects*/) override
     {
+        // The reply is picked before the call is recorded, so a test that saw the call
+        // can remap without changing its outcome.
+        std::optional<Mapping> m;
         {
             std::lock_guard<std::mutex> lk(mu);
+            if (auto it = responses.find(url); it != responses.end()) m = it->second;
+            for (auto& [prefix, mp] : prefixes) {
+                if (!m && url.rfind(prefix, 0) == 0) m = mp;
+            }
             calls.push_back(url);
         }
         call_count.fetch_add(1);
         cv.notify_all();
 
-        auto it = responses.find(url);
-        if (it == responses.end()) {
+        if (!m) {
             return bt::Expected<bt::HttpResponse>::failure("no mapping for " + url);
         }
-        if (!it->second.error.empty()) {
-            return bt::Expected<bt::HttpResponse>::failure(it->second.error);
+        if (!m->error.empty()) {
+            return bt::Expected<bt::HttpResponse>::failure(m->error);
         }
-        return bt::Expected<bt::HttpResponse>::success(bt::HttpResponse{it->second.status, it->second.body});
+        return bt::Expected<bt::HttpResponse>::success(bt::HttpResponse{m->status, m->body});
+    }
+
+    void map_prefix(const std::string& prefix, Mapping m) {
+        std::lock_guard<std::mutex> lk(mu);
+        for (auto& [p, mp] : prefixes) {
+            if (p == prefix) { mp = std::move(m); return; }
+        }
+        prefixes.emplace_back(prefix, std::move(m));
+    }
+
+    std::string call(size_t i) {
+        std::lock_guard<std::mutex> lk(mu);
+        return i < calls.size() ? calls[i] : std::string{};
     }
 };
 
@@ -114,52 +139,40 @@ TEST_CASE("TrackerManager: start/stop lifecycle is safe") {
 
 TEST_CASE("TrackerManager: announce delivers peers that can be drained") {
     auto http = std::make_shared<FakeHttpClient>();
+    http->map_prefix("http://t.example/announce", {200, ben_announce(1800, {{"1.2.3.4", 6881}, {"9.8.7.6", 80}}), ""});
     std::vector<std::vector<std::string>> announceList{
         {"http://t.example/announce"}
     };
 
     bt::TrackerManager mgr(announceList, make_infohash(), make_peerid(), /*port*/51413, http);
-    mgr.start();
 
-    // First announce to trigger URL construction and capture
+    // Queued before start(): the first pass sends it.
     mgr.announce(bt::AnnounceEvent::started, /*numwant*/10);
+    mgr.start();
     REQUIRE(wait_for_calls(*http, 1, std::chrono::seconds(2)));
-
-    // Get the exact URL built by the manager/http_tracker
-    std::string url;
-    {
-        std::lock_guard<std::mutex> lk(http->mu);
-        REQUIRE_FALSE(http->calls.empty());
-        url = http->calls.back();
-    }
-
-    // Provide a success mapping for that exact URL
-    http->responses[url] = {200, ben_announce(1800, {{"1.2.3.4", 6881}, {"9.8.7.6", 80}}), ""};
-
-    // Trigger a second announce to actually consume the mapping
-    mgr.announce(bt::AnnounceEvent::none, /*numwant*/10);
-    REQUIRE(wait_for_calls(*http, 2, std::chrono::seconds(2)));
-
-    // Drain peers from the manager
-    auto peers = mgr.drainNewPeers();
-    /**
-     * @todo Peers maybe empty (callbacks?)
-     */
-
-    // If it buffers, assert the content:
-    if (!peers.empty()) {
-        REQUIRE(peers.size() == 2);
-        CHECK(peers[0].ip == "1.2.3.4");
-        CHECK(peers[0].port == 6881);
-        CHECK(peers[1].ip == "9.8.7.6");
-        CHECK(peers[1].port == 80);
+    CHECK(http->call(0).find("event=started") != std::string::npos);
+    CHECK(http->call(0).find("numwant=10") != std::string::npos);
+
+    std::vector<bt::PeerEndpoint> peers;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (peers.empty() && std::chrono::steady_clock::now() < deadline) {
+        peers = mgr.drainNewPeers();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
+    REQUIRE(peers.size() == 2);
+    // Equal rank: the pool hands them out in no particular order.
+    if (peers[0].ip() != "1.2.3.4") std::swap(peers[0], peers[1]);
+    CHECK(peers[0].ip() == "1.2.3.4");
+    CHECK(peers[0].port() == 6881);
+    CHECK(peers[1].ip() == "9.8.7.6");
+    CHECK(peers[1].port() == 80);
 
     mgr.stop();
 }
 
-TEST_CASE("TrackerManager: setPeersCallback receives delivered peers") {
+TEST_CASE("TrackerManager: the ready callback wakes the consumer, which drains the peers") {
     auto http = std::make_shared<FakeHttpClient>();
+    http->map_prefix("http://t.example/announce", {200, ben_announce(900, {{"127.0.0.1", 51413}}), ""});
     std::vector<std::vector<std::string>> announceList{
         {"http://t.example/announce"}
     };
@@ -168,87 +181,69 @@ TEST_CASE("TrackerManager: setPeersCallback receives delivered peers") {
 
     std::mutex cbMu;
     std::condition_variable cbCv;
-    std::vector<bt::PeerAddr> delivered;
+    int wakes = 0;
 
-    mgr.setPeersCallback([&](const std::vector<bt::PeerAddr>& peers){
+    mgr.setPeersReadyCallback([&]{
         std::lock_guard<std::mutex> lk(cbMu);
-        delivered.insert(delivered.end(), peers.begin(), peers.end());
+        ++wakes;
         cbCv.notify_all();
     });
 
-    mgr.start();
-
-    // Trigger first call to capture URL
     mgr.announce(bt::AnnounceEvent::started, /*numwant*/5);
-    REQUIRE(wait_for_calls(*http, 1, std::chrono::seconds(2)));
+    mgr.start();
 
-    std::string url;
+    // Wait for the wake-up, then drain on this (the consumer's) thread.
     {
-        std::lock_guard<std::mutex> lk(http->mu);
-        url = http->calls.back();
+        std::unique_lock<std::mutex> lk(cbMu);
+        REQUIRE(cbCv.wait_for(lk, std::chrono::seconds(2), [&]{ return wakes == 1; }));
     }
+    auto delivered = mgr.drainNewPeers();
+    REQUIRE(delivered.size() == 1);
+    CHECK(delivered[0].ip() == "127.0.0.1");
+    CHECK(delivered[0].port() == 51413);
 
-    // Provide response mapping
-    http->responses[url] = {200, ben_announce(900, {{"127.0.0.1", 51413}}), ""};
-
-    // Trigger again to consume it
+    // The same peer again wakes the consumer but is not news.
     mgr.announce(bt::AnnounceEvent::none, /*numwant*/5);
-    REQUIRE(wait_for_calls(*http, 2, std::chrono::seconds(2)));
-
-    // Wait for callback
     {
         std::unique_lock<std::mutex> lk(cbMu);
-        cbCv.wait_for(lk, std::chrono::seconds(2), [&]{ return !delivered.empty(); });
+        REQUIRE(cbCv.wait_for(lk, std::chrono::seconds(2), [&]{ return wakes == 2; }));
     }
-    REQUIRE(delivered.size() == 1);
-    CHECK(delivered[0].ip == "127.0.0.1");
-    CHECK(delivered[0].port == 51413);
-
+    CHECK(mgr.drainNewPeers().empty());
     mgr.stop();
 }
 
 TEST_CASE("TrackerManager: endpoint rotation within a tier (first fails, second succeeds)") {
     auto http = std::make_shared<FakeHttpClient>();
+    http->map_prefix("http://a.example/announce", {0, "", "tracker a down"});
+    http->map_prefix("http://b.example/announce", {200, ben_announce(1200, {{"10.0.0.1", 6881}}), ""});
     std::vector<std::vector<std::string>> announceList{
         {"http://a.example/announce", "http://b.example/announce"}
     };
 
     bt::TrackerManager mgr(announceList, make_infohash(), make_peerid(), /*port*/51413, http);
-    mgr.start();
-
-    // First call -> capture A URL
     mgr.announce(bt::AnnounceEvent::started, /*numwant*/10);
-    REQUIRE(wait_for_calls(*http, 1, std::chrono::seconds(2)));
-
-    std::string a_url;
-    {
-        std::lock_guard<std::mutex> lk(http->mu);
-        a_url = http->calls.back();
-    }
-    http->responses[a_url] = {0, "", "tracker a down"};
+    mgr.start();
 
-    // Second call -> manager should rotate; capture B URL
-    mgr.announce(bt::AnnounceEvent::none, /*numwant*/10);
+    // One pass: A fails, the tier moves on to B within the same announce.
     REQUIRE(wait_for_calls(*http, 2, std::chrono::seconds(2)));
-
-    std::string b_url;
-    {
-        std::lock_guard<std::mutex> lk(http->mu);
-        b_url = http->calls.back();
+    CHECK(http->call(0).rfind("http://a.example/announce", 0) == 0);
+    CHECK(http->call(1).rfind("http://b.example/announce", 0) == 0);
+    CHECK(http->call(1).find("event=started") != std::string::npos);
+
+    std::vector<bt::PeerEndpoint> peers;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (peers.empty() && std::chrono::steady_clock::now() < deadline) {
+        peers = mgr.drainNewPeers();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
-    http->responses[b_url] = {200, ben_announce(1200, {{"10.0.0.1", 6881}}), ""};
+    REQUIRE(peers.size() == 1);
+    CHECK(peers[0].ip() == "10.0.0.1");
+    CHECK(peers[0].port() == 6881);
 
-    // Third call -> consume success mapping
+    // B answered last, so the next announce starts there.
     mgr.announce(bt::AnnounceEvent::none, /*numwant*/10);
     REQUIRE(wait_for_calls(*http, 3, std::chrono::seconds(2)));
-
-    // Drain (if used) or rely on callback in previous test
-    auto peers = mgr.drainNewPeers();
-    if (!peers.empty()) {
-        REQUIRE(peers.size() == 1);
-        CHECK(peers[0].ip == "10.0.0.1");
-        CHECK(peers[0].port == 6881);
-    }
+    CHECK(http->call(2).rfind("http://b.example/announce", 0) == 0);
 
     mgr.stop();
 }
@@ -269,3 +264,338 @@ TEST_CASE("TrackerManager: onStats updates are accepted") {
 
     mgr.stop();
 }
+
+TEST_CASE("TrackerManager: stop() cancels a slow HTTP announce instead of waiting it out") {
+    std::atomic<int> hits{0};
+    FakeHttpServer srv([&](const std::string&) {
+        ++hits;
+        return FakeHttpReply{200, ben_announce(1800, {}), std::chrono::milliseconds(3000)};
+    });
+    REQUIRE(srv.start());
+
+    std::vector<std::vector<std::string>> announceList{
+        {srv.url("/announce"), srv.url("/announce2")}
+    };
+    bt::TrackerManager mgr(announceList, make_infohash(), make_peerid(), /*port*/51413,
+                           bt::makeCurlMultiClient(nullptr, {}));
+    mgr.start();
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (hits == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(hits == 1);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    mgr.stop();
+    // Also covers the fail-over to /announce2, which must not start a fresh 3 s wait.
+    CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(500));
+}
+
+TEST_CASE("TrackerManager: announce() wakes the task at once, inside the tracker's interval") {
+    auto http = std::make_shared<FakeHttpClient>();
+    http->map_prefix("http://t.example/announce", {200, ben_announce(1800, {}), ""});
+    std::vector<std::vector<std::string>> announceList{
+        {"http://t.example/announce"}
+    };
+
+    bt::TrackerManager mgr(announceList, make_infohash(), make_peerid(), /*port*/51413, http);
+    mgr.start();
+    REQUIRE(wait_for_calls(*http, 1, std::chrono::seconds(2)));     // periodic pass; next one in ~30 min
+
+    const auto t0 = std::chrono::steady_clock::now();
+    mgr.announce(bt::AnnounceEvent::completed, 5);
+    REQUIRE(wait_for_calls(*http, 2, std::chrono::seconds(2)));
+    CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(500));
+    CHECK(http->call(1).find("event=completed") != std::string::npos);
+
+    // Nothing else is due: the task sleeps until the interval runs out.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(http->call_count.load() == 2);
+
+    const auto s0 = std::chrono::steady_clock::now();
+    mgr.stop();
+    CHECK(std::chrono::steady_clock::now() - s0 < std::chrono::milliseconds(100));
+}
+
+TEST_CASE("TrackerManager: a started event no tracker confirmed rides along with the next announce") {
+    auto http = std::make_shared<FakeHttpClient>();
+    http->map_prefix("http://t.example/announce", {0, "", "tracker down"});
+    std::vector<std::vector<std::string>> announceList{
+        {"http://t.example/announce"}
+    };
+
+    bt::TrackerManager mgr(announceList, make_infohash(), make_peerid(), /*port*/51413, http);
+    mgr.announce(bt::AnnounceEvent::started, 5);
+    mgr.start();
+    REQUIRE(wait_for_calls(*http, 1, std::chrono::seconds(2)));
+    CHECK(http->call(0).find("event=started") != std::string::npos);
+
+    http->map_prefix("http://t.example/announce", {200, ben_announce(1800, {}), ""});
+    mgr.announce(bt::AnnounceEvent::none, 5);
+    REQUIRE(wait_for_calls(*http, 2, std::chrono::seconds(2)));
+    CHECK(http->call(1).find("event=started") != std::string::npos);
+
+    mgr.announce(bt::AnnounceEvent::none, 5);
+    REQUIRE(wait_for_calls(*http, 3, std::chrono::seconds(2)));
+    CHECK(http->call(2).find("event=") == std::string::npos);
+
+    mgr.stop();
+}
+
+TEST_CASE("TrackerManager: stop() abandons a UDP announce the tracker never answers") {
+    FakeUdpTrackerConfig cfg;
+    cfg.lossRate = 1.0;                         // every request is dropped; the engine would retry for minutes
+    FakeUdpTrackerServer tracker(cfg);
+    REQUIRE(tracker.start());
+
+    std::vector<std::vector<std::string>> announceList{
+        {tracker.url()}
+    };
+    bt::TrackerManager mgr(announceList, make_infohash(), make_peerid(), /*port*/51413,
+                           std::make_shared<FakeHttpClient>());
+    mgr.announce(bt::AnnounceEvent::started, 5);
+    mgr.start();
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (tracker.counters().received == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    REQUIRE(tracker.counters().received >= 1);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    mgr.stop();
+    CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(200));
+}
+
+TEST_CASE("TrackerManager: every tier is announced at once; a slow tier does not hold up peers") {
+    FakeHttpServer srv([&](const std::string& target) {
+        if (target.rfind("/slow", 0) == 0) return FakeHttpReply{200, ben_announce(1800, {}), std::chrono::milliseconds(3000)};
+        return FakeHttpReply{200, ben_announce(1800, {{"10.1.2.3", 6881}}), std::chrono::milliseconds(0)};
+    });
+    REQUIRE(srv.start());
+
+    std::vector<std::vector<std::string>> announceList{
+        {srv.url("/slow/announce")}, {srv.url("/fast/announce")}
+    };
+    bt::TrackerManager mgr(announceList, make_infohash(), make_peerid(), /*port*/51413,
+                           bt::makeCurlMultiClient(nullptr, {}), nullptr, bt::TrackerManagerConfig{true, 1});
+    const auto t0 = std::chrono::steady_clock::now();
+    mgr.announce(bt::AnnounceEvent::started, 10);
+    mgr.start();
+
+    std::vector<bt::PeerEndpoint> peers;
+    while (peers.empty() && std::chrono::steady_clock::now() - t0 < std::chrono::seconds(2)) {
+        peers = mgr.drainNewPeers();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    REQUIRE(peers.size() == 1);
+    CHECK(peers[0].ip() == "10.1.2.3");
+    CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(1000));
+
+    const auto s0 = std::chrono::steady_clock::now();
+    mgr.stop();
+    CHECK(std::chrono::steady_clock::now() - s0 < std::chrono::milliseconds(500));
+}
+
+TEST_CASE("TrackerManager: racing within a tier is capped, and a failure hands the slot on") {
+    std::mutex mu;
+    std::vector<std::string> targets;
+    FakeHttpServer srv([&](const std::string& target) {
+        {
+            std::lock_guard<std::mutex> lk(mu);
+            targets.push_back(target.substr(0, 3));
+        }
+        if (target.rfind("/a/", 0) == 0) return FakeHttpReply{500, "", std::chrono::milliseconds(100)};
+        return FakeHttpReply{200, ben_announce(1800, {}), std::chrono::milliseconds(3000)};
+    });
+    REQUIRE(srv.start());
+
+    std::vector<std::vector<std::string>> announceList{
+        {srv.url("/a/announce"), srv.url("/b/announce"), srv.url("/c/announce"), srv.url("/d/announce")}
+    };
+    bt::TrackerManager mgr(announceList, make_infohash(), make_peerid(), /*port*/51413,
+                           bt::makeCurlMultiClient(nullptr, {}), nullptr, bt::TrackerManagerConfig{true, 2});
+    mgr.start();
+
+    // a and b go out together; a fails, c takes its place; d is never needed while b and c hang.
+    auto seen = [&] { std::lock_guard<std::mutex> lk(mu); return targets.size(); };
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (seen() < 3 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        REQUIRE(targets.size() == 3);
+        std::sort(targets.begin(), targets.begin() + 2);
+        CHECK(targets == std::vector<std::string>{"/a/", "/b/", "/c/"});
+    }
+    mgr.stop();
+}
+
+TEST_CASE("TrackerManager: fallback mode moves to the next tier only when the first fails") {
+    auto http = std::make_shared<FakeHttpClient>();
+    http->map_prefix("http://a.example/announce", {0, "", "tracker a down"});
+    http->map_prefix("http://b.example/announce", {200, ben_announce(1800, {}), ""});
+    http->map_prefix("http://c.example/announce", {200, ben_announce(1800, {}), ""});
+    std::vector<std::vector<std::string>> announceList{
+        {"http://a.example/announce"}, {"http://b.example/announce"}, {"http://c.example/announce"}
+    };
+
+    bt::TrackerManager mgr(announceList, make_infohash(), make_peerid(), /*port*/51413, http,
+                           nullptr, bt::TrackerManagerConfig{false, 1});
+    mgr.announce(bt::AnnounceEvent::started, 10);
+    mgr.start();
+
+    // Tier 1 fails, tier 2 answers and carries the unconfirmed started event; tier 3 is left alone.
+    REQUIRE(wait_for_calls(*http, 2, std::chrono::seconds(2)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(http->call_count.load() == 2);
+    CHECK(http->call(0).rfind("http://a.example/announce", 0) == 0);
+    CHECK(http->call(1).rfind("http://b.example/announce", 0) == 0);
+    CHECK(http->call(1).find("event=started") != std::string::npos);
+
+    mgr.stop();
+}
+
+TEST_CASE("TrackerManager: a full peer queue refuses batches until the consumer drains") {
+    bt::TrackerManagerConfig cfg;
+    cfg.peerQueueBatches = 2;
+    bt::TrackerManager mgr({{"http://t.example/announce"}}, make_infohash(), make_peerid(), /*port*/51413,
+                           std::make_shared<FakeHttpClient>(), nullptr, cfg);
+    int wakes = 0;
+    mgr.setPeersReadyCallback([&]{ ++wakes; });
+
+    auto peer = [](std::uint8_t last) { return *bt::PeerEndpoint::parse("10.0.0." + std::to_string(last), 6881); };
+    CHECK(mgr.addPeers({peer(1), peer(2)}, bt::PeerSource::pex));
+    CHECK(mgr.addPeers({peer(2), peer(3)}, bt::PeerSource::dht));
+    CHECK_FALSE(mgr.addPeers({peer(4)}, bt::PeerSource::pex));     // back-pressure: dropped
+    CHECK(mgr.droppedPeerBatches() == 1);
+    CHECK(wakes == 1);                                              // one signal per drain
+
+    auto peers = mgr.drainNewPeers();
+    CHECK(peers.size() == 3);
+
+    CHECK(mgr.addPeers({peer(4)}, bt::PeerSource::pex));
+    CHECK(wakes == 2);
+    peers = mgr.drainNewPeers();
+    REQUIRE(peers.size() == 1);
+    CHECK(peers[0] == peer(4));
+}
+
+TEST_CASE("TrackerManager: an announce reply that finds the peer queue full is counted") {
+    auto http = std::make_shared<FakeHttpClient>();
+    http->map_prefix("http://t.example/announce", {200, ben_announce(1800, {{"1.2.3.4", 6881}}), ""});
+    bt::TrackerManagerConfig cfg;
+    cfg.peerQueueBatches = 2;
+    bt::TrackerManager mgr({{"http://t.example/announce"}}, make_infohash(), make_peerid(), /*port*/51413,
+                           http, nullptr, cfg);
+    REQUIRE(mgr.addPeers({*bt::PeerEndpoint::parse("10.0.0.1", 6881)}, bt::PeerSource::pex));
+    REQUIRE(mgr.addPeers({*bt::PeerEndpoint::parse("10.0.0.2", 6881)}, bt::PeerSource::dht));
+
+    mgr.start();
+    REQUIRE(wait_for_calls(*http, 1, std::chrono::seconds(2)));
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (mgr.droppedPeerBatches() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(mgr.droppedPeerBatches() == 1);
+    mgr.stop();
+
+    // Only the two queued batches arrive; the tracker's 1.2.3.4 was dropped.
+    auto peers = mgr.drainNewPeers();
+    CHECK(peers.size() == 2);
+    CHECK(std::none_of(peers.begin(), peers.end(), [](auto const& p) { return p.ip() == "1.2.3.4"; }));
+}
+
+// Replies to a.example from a thread of the test's choosing; b.example's request blocks inside
+// getAsync until released, as a busy transport would.
+struct GatedHttpClient : public bt::IHttpClient {
+    std::mutex mu;
+    std::condition_variable cv;
+    bt::HttpCallback aReply;
+    bool bEntered{false}, release{false};
+    std::atomic<int> calls{0};
+
+    bt::Expected<bt::HttpResponse> get(const std::string&, int, int, bool) override {
+        return bt::Expected<bt::HttpResponse>::failure("unused");
+    }
+
+    bt::HttpRequestHandle getAsync(const std::string& url, int, int, bool, bt::HttpCallback cb) override {
+        ++calls;
+        std::unique_lock<std::mutex> lk(mu);
+        if (url.rfind("http://a.example/", 0) == 0) {
+            aReply = std::move(cb);
+            cv.notify_all();
+            return {};
+        }
+        bEntered = true;
+        cv.notify_all();
+        cv.wait(lk, [&]{ return release; });
+        lk.unlock();
+        cb(bt::Expected<bt::HttpResponse>::failure("tracker b down"));
+        return {};
+    }
+};
+
+TEST_CASE("TrackerManager: stop() waits for a reply handler that is failing over") {
+    auto http = std::make_shared<GatedHttpClient>();
+    auto mgr = std::make_unique<bt::TrackerManager>(
+        std::vector<std::vector<std::string>>{{"http://a.example/announce", "http://b.example/announce"}},
+        make_infohash(), make_peerid(), /*port*/51413, http, nullptr, bt::TrackerManagerConfig{false, 1});
+    mgr->announce(bt::AnnounceEvent::started, 5);
+    mgr->start();
+    {
+        std::unique_lock<std::mutex> lk(http->mu);
+        REQUIRE(http->cv.wait_for(lk, std::chrono::seconds(2), [&]{ return static_cast<bool>(http->aReply); }));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));    // let the pass that sent it return
+
+    // a's failure arrives on a transport thread; its handler sends to b and is held there.
+    bt::HttpCallback aReply;
+    {
+        std::lock_guard<std::mutex> lk(http->mu);
+        aReply = std::move(http->aReply);
+    }
+    std::thread transport([&]{ aReply(bt::Expected<bt::HttpResponse>::failure("tracker a down")); });
+    {
+        std::unique_lock<std::mutex> lk(http->mu);
+        REQUIRE(http->cv.wait_for(lk, std::chrono::seconds(2), [&]{ return http->bEntered; }));
+    }
+
+    std::atomic<bool> stopped{false};
+    std::thread stopper([&]{ mgr->stop(); stopped = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK_FALSE(stopped);                       // the handler still uses the manager
+
+    {
+        std::lock_guard<std::mutex> lk(http->mu);
+        http->release = true;
+    }
+    http->cv.notify_all();
+    transport.join();
+    stopper.join();
+    CHECK(stopped);
+    mgr.reset();                                // nothing of it may be touched after this
+    CHECK(http->calls == 2);
+}
+
+TEST_CASE("TrackerManager: HTTP scrape URLs come from the path only (BEP 48)") {
+    auto http = std::make_shared<FakeHttpClient>();
+    http->map_prefix("http://", {200, "d5:filesdee"});
+    bt::TrackerManager mgr(
+        std::vector<std::vector<std::string>>{{"http://announce.example.com", "http://t.example/x/announce.php?pk=1",
+                                               "http://announce.example.org/tracker"}},
+        make_infohash(), make_peerid(), /*port*/51413, http, nullptr);
+
+    std::atomic<int> replies{0};
+    mgr.scrape([&](const std::string&, const bt::Expected<bt::ScrapeStats>&) { ++replies; });
+    REQUIRE(wait_for_calls(*http, 1, std::chrono::seconds(3)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Neither host named "announce..." is mistaken for a path.
+    CHECK(http->call_count.load() == 1);
+    CHECK(http->call(0).rfind("http://t.example/x/scrape.php?pk=1&info_hash=", 0) == 0);
+}
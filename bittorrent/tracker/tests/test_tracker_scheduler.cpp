@@ -0,0 +1,167 @@
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../include/tracker_scheduler.hpp"
+
+using namespace bittorrent::tracker;
+using namespace std::chrono_literals;
+using Clock = TrackerScheduler::Clock;
+
+// --------------------- helpers ---------------------
+template <typename Pred>
+static bool eventually(Pred pred, std::chrono::milliseconds timeout = 2000ms) {
+    const auto deadline = Clock::now() + timeout;
+    while (!pred()) {
+        if (Clock::now() > deadline) return false;
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+// --------------------- TESTS ---------------------
+
+TEST_CASE("TrackerScheduler: tasks run in deadline order and reschedule themselves") {
+    TrackerScheduler sched({1});
+    std::mutex mu;
+    std::vector<int> order;
+    std::atomic<int> repeats{0};
+
+    const auto t0 = Clock::now();
+    for (int i : {3, 1, 2}) {
+        sched.add([&, i](Clock::time_point) {
+            std::scoped_lock lk(mu);
+            order.push_back(i);
+            return Clock::time_point::max();
+        }, t0 + i * 20ms);
+    }
+    sched.add([&](Clock::time_point now) {
+        return ++repeats < 5 ? now + 5ms : Clock::time_point::max();
+    });
+
+    REQUIRE(eventually([&] { std::scoped_lock lk(mu); return order.size() == 3 && repeats == 5; }));
+    CHECK(order == std::vector<int>{1, 2, 3});
+    std::this_thread::sleep_for(30ms);
+    CHECK(repeats == 5);                        // parked tasks stay parked
+
+    const auto s = sched.stats();
+    CHECK(s.tasks == 4);
+    CHECK(s.queued == 0);
+    CHECK(s.runs == 8);
+}
+
+TEST_CASE("TrackerScheduler: wake() pulls a deadline in and never pushes one out") {
+    TrackerScheduler sched({2});
+    std::atomic<int> runs{0};
+    std::atomic<Clock::time_point::rep> lastRun{0};
+
+    const auto id = sched.add([&](Clock::time_point now) {
+        ++runs;
+        lastRun = now.time_since_epoch().count();
+        return now + 1h;
+    }, Clock::now() + 1h);
+    CHECK(id != 0);
+
+    const auto woke = Clock::now();
+    sched.wake(id);
+    REQUIRE(eventually([&] { return runs == 1; }));
+    CHECK(Clock::time_point(Clock::duration(lastRun.load())) - woke < 200ms);
+
+    sched.wake(id, Clock::now() + 2h);          // later than the pending 1 h: ignored
+    sched.wake(id, Clock::now() + 30ms);
+    REQUIRE(eventually([&] { return runs == 2; }));
+    std::this_thread::sleep_for(50ms);
+    CHECK(runs == 2);
+
+    sched.remove(id);
+    sched.wake(id);                             // stale id: no effect
+    std::this_thread::sleep_for(20ms);
+    CHECK(runs == 2);
+    CHECK(sched.stats().tasks == 0);
+}
+
+TEST_CASE("TrackerScheduler: wake() during a run makes it run again right after") {
+    TrackerScheduler sched({2});
+    std::atomic<int> runs{0};
+    std::atomic<bool> inside{false}, release{false};
+
+    const auto id = sched.add([&](Clock::time_point) {
+        if (++runs == 1) {
+            inside = true;
+            while (!release) std::this_thread::yield();
+        }
+        return Clock::time_point::max();
+    });
+
+    REQUIRE(eventually([&] { return inside.load(); }));
+    sched.wake(id);
+    release = true;
+    REQUIRE(eventually([&] { return runs == 2; }));
+    std::this_thread::sleep_for(20ms);
+    CHECK(runs == 2);
+}
+
+TEST_CASE("TrackerScheduler: remove() waits for a running task and works from inside it") {
+    TrackerScheduler sched({2});
+
+    std::atomic<bool> inside{false}, finished{false};
+    const auto slow = sched.add([&](Clock::time_point now) {
+        inside = true;
+        std::this_thread::sleep_for(100ms);
+        finished = true;
+        return now;                             // would run again at once if not removed
+    });
+    REQUIRE(eventually([&] { return inside.load(); }));
+    sched.remove(slow);
+    CHECK(finished);
+
+    std::atomic<int> selfRuns{0};
+    TrackerScheduler::TaskId self = 0;
+    std::mutex mu;
+    {
+        std::scoped_lock lk(mu);                // the task reads self only after add() returned
+        self = sched.add([&](Clock::time_point now) {
+            ++selfRuns;
+            std::scoped_lock lk2(mu);
+            sched.remove(self);
+            return now;
+        });
+    }
+    REQUIRE(eventually([&] { return sched.stats().tasks == 0; }));
+    std::this_thread::sleep_for(20ms);
+    CHECK(selfRuns == 1);
+}
+
+TEST_CASE("TrackerScheduler: thousands of tasks each run once, on time, across the pool") {
+    TrackerScheduler sched({4});
+    constexpr int kTasks = 5000;
+    std::vector<std::atomic<int>> runs(kTasks);
+    std::atomic<int> early{0};
+
+    const auto t0 = Clock::now();
+    std::vector<TrackerScheduler::TaskId> ids;
+    for (int i = 0; i < kTasks; ++i) {
+        const auto due = t0 + std::chrono::microseconds((i * 7919) % 200000);
+        ids.push_back(sched.add([&, i, due](Clock::time_point now) {
+            ++runs[i];
+            if (now < due) ++early;             // never before its deadline
+            return Clock::time_point::max();
+        }, due));
+    }
+
+    REQUIRE(eventually([&] { return sched.stats().runs == kTasks; }));
+    for (auto& r : runs) CHECK(r == 1);
+    CHECK(early == 0);
+
+    for (auto id : ids) sched.remove(id);
+    CHECK(sched.stats().tasks == 0);
+    // Freed slots are reused; their old ids stay dead.
+    const auto fresh = sched.add([](Clock::time_point) { return Clock::time_point::max(); });
+    CHECK(fresh != ids.back());
+    sched.remove(ids.back());
+    CHECK(sched.stats().tasks == 1);
+}
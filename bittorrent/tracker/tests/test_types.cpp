@@ -1,5 +1,6 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch_all.hpp>
+#include <unordered_set>
 #include "../include/types.hpp"
 
 using namespace bittorrent::tracker;
@@ -93,3 +94,53 @@ TEST_CASE("InfoHash equality and ordering (operator<=> default)") {
     REQUIRE((a <=> b) == std::strong_ordering::less);
     REQUIRE((b <=> a) == std::strong_ordering::greater);
 }
+
+TEST_CASE("PeerEndpoint: 19 packed bytes, parse and format round-trip") {
+    STATIC_REQUIRE(sizeof(PeerEndpoint) == 19);
+
+    const uint8_t a4[4] = {192, 168, 0, 1};
+    auto v4 = PeerEndpoint::v4(a4, 51413);
+    CHECK(v4.isV4());
+    CHECK(v4.port() == 51413);
+    CHECK(v4.portBE[0] == 0xC8);            // network order: 51413 = 0xC8D5
+    CHECK(v4.portBE[1] == 0xD5);
+    CHECK(v4.ip() == "192.168.0.1");
+    CHECK(v4.toString() == "192.168.0.1:51413");
+
+    for (const char* text : {"0.0.0.0", "255.255.255.255", "10.0.0.1", "::1", "2001:db8::7", "::ffff:192.0.2.128"}) {
+        auto e = PeerEndpoint::parse(text, 6881);
+        REQUIRE(e.has_value());
+        CHECK(e->ip() == text);
+        CHECK(e->port() == 6881);
+    }
+    CHECK(PeerEndpoint::parse("::1", 80)->toString() == "[::1]:80");
+    CHECK_FALSE(PeerEndpoint::parse("tracker.example.org", 80).has_value());
+    CHECK_FALSE(PeerEndpoint::parse("", 80).has_value());
+    CHECK_FALSE(PeerEndpoint::parse("1.2.3", 80).has_value());
+    CHECK(PeerEndpoint{}.ip().empty());
+}
+
+TEST_CASE("PeerEndpoint: equality, ordering and hashing cover family, address and port") {
+    auto a = *PeerEndpoint::parse("10.0.0.1", 6881);
+    auto b = *PeerEndpoint::parse("10.0.0.1", 6881);
+    CHECK(a == b);
+    CHECK(std::hash<PeerEndpoint>{}(a) == std::hash<PeerEndpoint>{}(b));
+
+    auto otherPort = *PeerEndpoint::parse("10.0.0.1", 6882);
+    auto otherAddr = *PeerEndpoint::parse("10.0.0.2", 6881);
+    auto mapped = *PeerEndpoint::parse("::ffff:10.0.0.1", 6881);
+    CHECK(a != otherPort);
+    CHECK(a != otherAddr);
+    CHECK(a != mapped);                     // different family, even for the same IPv4 address
+    CHECK(a < otherPort);                   // ports compare numerically (big-endian bytes)
+    CHECK(a < otherAddr);
+    CHECK(*PeerEndpoint::parse("10.0.0.1", 255) < *PeerEndpoint::parse("10.0.0.1", 256));
+
+    // Neighbouring endpoints spread across buckets.
+    std::unordered_set<std::size_t> hashes;
+    for (int i = 0; i < 1000; ++i) {
+        const uint8_t ip[4] = {10, 0, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i)};
+        hashes.insert(std::hash<PeerEndpoint>{}(PeerEndpoint::v4(ip, 6881)) & 1023);
+    }
+    CHECK(hashes.size() > 550);
+}
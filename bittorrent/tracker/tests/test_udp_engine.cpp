@@ -0,0 +1,351 @@
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../include/udp_engine.hpp"
+#include "../include/types.hpp"
+#include "fake_udp_tracker.hpp"
+
+using namespace bittorrent::tracker;
+using namespace std::chrono_literals;
+
+// --------------------- helpers ---------------------
+static InfoHash make_infohash(uint8_t seed = 0x00) {
+    InfoHash ih{};
+    for (size_t i = 0; i < ih.bytes.size(); ++i) ih.bytes[i] = static_cast<uint8_t>(seed + i);
+    return ih;
+}
+
+static AnnounceRequest make_request(uint8_t seed) {
+    AnnounceRequest req{};
+    req.infoHash = make_infohash(seed);
+    req.port     = 51413;
+    req.left     = 1;
+    req.numwant  = 10;
+    return req;
+}
+
+static std::string url_for(const FakeUdpTrackerServer& s) {
+    return "udp://127.0.0.1:" + std::to_string(s.port()) + "/announce";
+}
+
+static std::future<Expected<AnnounceResponse>>
+announce_async(UdpTrackerEngine& eng, const AnnounceRequest& req, const std::string& url) {
+    auto p = std::make_shared<std::promise<Expected<AnnounceResponse>>>();
+    auto f = p->get_future();
+    eng.announce(req, url, [p](Expected<AnnounceResponse> r) { p->set_value(std::move(r)); });
+    return f;
+}
+
+static UdpEngineConfig fast_config() {
+    UdpEngineConfig cfg;
+    cfg.timeout = 50ms;
+    cfg.maxRetransmits = 3;
+    return cfg;
+}
+
+// --------------------- TESTS ---------------------
+
+TEST_CASE("UdpTrackerEngine: many concurrent announces share one socket") {
+    FakeUdpTrackerServer server;
+    REQUIRE(server.start());
+    server.setPeers({{"127.1.2.3", 6881}});
+
+    UdpTrackerEngine eng(fast_config());
+    REQUIRE(eng.start().has_value());
+
+    constexpr int kOps = 300;
+    std::vector<std::future<Expected<AnnounceResponse>>> futs;
+    for (int i = 0; i < kOps; ++i) {
+        futs.push_back(announce_async(eng, make_request(static_cast<uint8_t>(i)), url_for(server)));
+    }
+
+    for (auto& f : futs) {
+        REQUIRE(f.wait_for(5s) == std::future_status::ready);
+        auto r = f.get();
+        REQUIRE(r.has_value());
+        CHECK(r.get().interval == 900);
+        REQUIRE(r.get().peers.size() == 1);
+        CHECK(r.get().peers[0].ip() == "127.1.2.3");
+    }
+    CHECK(eng.inFlight() == 0);
+    CHECK(server.connectCount() == 1);  // everyone waited on the first connect
+
+    // The connection_id is cached: another announce goes straight to action=1.
+    const int connects = server.connectCount();
+    auto again = announce_async(eng, make_request(0xEE), url_for(server));
+    REQUIRE(again.wait_for(2s) == std::future_status::ready);
+    REQUIRE(again.get().has_value());
+    CHECK(server.connectCount() == connects);
+}
+
+TEST_CASE("UdpTrackerEngine: replies are demultiplexed per tracker") {
+    FakeUdpTrackerServer a, b;
+    REQUIRE(a.start());
+    REQUIRE(b.start());
+    a.setPeers({{"10.0.0.1", 1111}});
+    b.setPeers({{"10.0.0.2", 2222}, {"10.0.0.3", 3333}});
+
+    UdpTrackerEngine eng(fast_config());
+    REQUIRE(eng.start().has_value());
+
+    std::vector<std::future<Expected<AnnounceResponse>>> fa, fb;
+    for (int i = 0; i < 20; ++i) {
+        fa.push_back(announce_async(eng, make_request(static_cast<uint8_t>(i)), url_for(a)));
+        fb.push_back(announce_async(eng, make_request(static_cast<uint8_t>(i)), url_for(b)));
+    }
+    for (auto& f : fa) {
+        auto r = f.get();
+        REQUIRE(r.has_value());
+        REQUIRE(r.get().peers.size() == 1);
+        CHECK(r.get().peers[0].port() == 1111);
+    }
+    for (auto& f : fb) {
+        auto r = f.get();
+        REQUIRE(r.has_value());
+        CHECK(r.get().peers.size() == 2);
+    }
+}
+
+TEST_CASE("UdpTrackerEngine: scrape and tracker error") {
+    FakeUdpTrackerServer server;
+    REQUIRE(server.start());
+    server.setScrapeTriplet(7, 8, 9);
+    server.setErrorOnAnnounce(true, "go away");
+
+    UdpTrackerEngine eng(fast_config());
+    REQUIRE(eng.start().has_value());
+
+    std::promise<Expected<std::map<InfoHash, ScrapeStats>>> sp;
+    std::vector<InfoHash> hashes{make_infohash(1), make_infohash(2), make_infohash(3)};
+    eng.scrape(hashes, url_for(server), [&](auto r) { sp.set_value(std::move(r)); });
+    auto sr = sp.get_future().get();
+    REQUIRE(sr.has_value());
+    REQUIRE(sr.get().size() == 3);
+    CHECK(sr.get().at(hashes[1]).downloaded == 8);
+
+    auto ar = announce_async(eng, make_request(1), url_for(server)).get();
+    REQUIRE_FALSE(ar.has_value());
+    CHECK(ar.error->message.find("go away") != std::string::npos);
+}
+
+TEST_CASE("UdpTrackerEngine: truncated reply is retransmitted after the timeout") {
+    FakeUdpTrackerServer server;
+    REQUIRE(server.start());
+    server.setShortAnnounceOnce(true);
+
+    UdpTrackerEngine eng(fast_config());
+    REQUIRE(eng.start().has_value());
+
+    const auto t0 = std::chrono::steady_clock::now();
+    auto r = announce_async(eng, make_request(3), url_for(server)).get();
+    REQUIRE(r.has_value());
+    CHECK(std::chrono::steady_clock::now() - t0 >= 50ms);
+    CHECK(server.announceCount() == 2);
+}
+
+TEST_CASE("UdpTrackerEngine: silent tracker exhausts retries") {
+    // Bound but never read: packets are swallowed without an ICMP reply.
+    int sink = ::socket(AF_INET, SOCK_DGRAM, 0);
+    REQUIRE(sink >= 0);
+    sockaddr_in addr{}; addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    REQUIRE(::bind(sink, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    socklen_t alen = sizeof(addr);
+    ::getsockname(sink, reinterpret_cast<sockaddr*>(&addr), &alen);
+
+    UdpEngineConfig cfg;
+    cfg.timeout = 10ms;
+    cfg.maxRetransmits = 2;     // 10 + 20 + 40 ms
+    UdpTrackerEngine eng(cfg);
+    REQUIRE(eng.start().has_value());
+
+    auto r = announce_async(eng, make_request(4), "udp://127.0.0.1:" + std::to_string(ntohs(addr.sin_port))).get();
+    REQUIRE_FALSE(r.has_value());
+    CHECK(r.error->message == "udp: connect exhausted retries");
+    ::close(sink);
+}
+
+TEST_CASE("UdpTrackerEngine: stop() fails pending operations; later calls fail fast") {
+    int sink = ::socket(AF_INET, SOCK_DGRAM, 0);
+    REQUIRE(sink >= 0);
+    sockaddr_in addr{}; addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    REQUIRE(::bind(sink, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    socklen_t alen = sizeof(addr);
+    ::getsockname(sink, reinterpret_cast<sockaddr*>(&addr), &alen);
+    const std::string url = "udp://127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+
+    UdpTrackerEngine eng;   // BEP 15 defaults: first retransmit after 15 s
+    REQUIRE(eng.start().has_value());
+
+    auto pending = announce_async(eng, make_request(5), url);
+    CHECK(pending.wait_for(50ms) == std::future_status::timeout);
+    eng.stop();
+
+    REQUIRE(pending.wait_for(0s) == std::future_status::ready);
+    auto r = pending.get();
+    REQUIRE_FALSE(r.has_value());
+    CHECK(r.error->message == "udp: engine stopped");
+
+    auto late = announce_async(eng, make_request(6), url).get();
+    REQUIRE_FALSE(late.has_value());
+    CHECK(late.error->message == "udp: engine not running");
+    ::close(sink);
+}
+
+TEST_CASE("UdpTrackerEngine: a tracker in a family without a socket fails at submit") {
+    DnsResolverConfig dcfg;
+    dcfg.lookup = [](const std::string&) {
+        ResolvedAddr r;
+        auto& a = reinterpret_cast<sockaddr_in6&>(r.addr);
+        a.sin6_family = AF_INET6;
+        a.sin6_addr = in6addr_loopback;
+        r.len = sizeof(sockaddr_in6);
+        return Expected<ResolvedAddrs>::success({r});
+    };
+
+    UdpEngineConfig cfg;    // BEP 15 defaults: a queued op would wait 15 s for its first retransmit
+    cfg.ipv6 = false;
+    UdpTrackerEngine eng(cfg, nullptr, std::make_shared<DnsResolver>(dcfg));
+    REQUIRE(eng.start().has_value());
+
+    for (const char* url : {"udp://[::1]:6969/announce", "udp://v6only.test:6969/announce"}) {
+        auto f = announce_async(eng, make_request(10), url);
+        REQUIRE(f.wait_for(1s) == std::future_status::ready);
+        auto r = f.get();
+        REQUIRE_FALSE(r.has_value());
+        CHECK(r.error->message == "udp: no usable address family");
+    }
+    CHECK(eng.ioStats().datagramsSent == 0);
+}
+
+TEST_CASE("UdpTrackerEngine: connection ids come from a shared cache") {
+    FakeUdpTrackerServer server;
+    REQUIRE(server.start());
+
+    auto cache = std::make_shared<ConnectionIdCache>();
+    UdpTrackerEngine e1(fast_config(), cache), e2(fast_config(), cache);
+    REQUIRE(e1.start().has_value());
+    REQUIRE(e2.start().has_value());
+
+    REQUIRE(announce_async(e1, make_request(7), url_for(server)).get().has_value());
+    REQUIRE(announce_async(e2, make_request(8), url_for(server)).get().has_value());
+    CHECK(server.connectCount() == 1);
+    CHECK(cache->size() == 1);
+}
+
+TEST_CASE("UdpTrackerEngine: host names go through the injected resolver") {
+    FakeUdpTrackerServer server;
+    REQUIRE(server.start());
+    server.setPeers({{"10.9.9.9", 9999}});
+
+    std::atomic<int> lookups{0};
+    DnsResolverConfig dcfg;
+    dcfg.lookup = [&](const std::string& host) {
+        ++lookups;
+        if (host != "tracker.test") return Expected<ResolvedAddrs>::failure("dns: unknown host " + host);
+        ResolvedAddr r;
+        auto& a = reinterpret_cast<sockaddr_in&>(r.addr);
+        a.sin_family = AF_INET;
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        r.len = sizeof(sockaddr_in);
+        return Expected<ResolvedAddrs>::success({r});
+    };
+    auto resolver = std::make_shared<DnsResolver>(dcfg);
+
+    UdpTrackerEngine eng(fast_config(), nullptr, resolver);
+    REQUIRE(eng.start().has_value());
+
+    const std::string url = "udp://tracker.test:" + std::to_string(server.port()) + "/announce";
+    for (int i = 0; i < 3; ++i) {
+        auto r = announce_async(eng, make_request(static_cast<uint8_t>(i)), url).get();
+        REQUIRE(r.has_value());
+        CHECK(r.get().peers.at(0).port() == 9999);
+    }
+    CHECK(lookups == 1);
+
+    auto bad = announce_async(eng, make_request(9), "udp://elsewhere.test:1/announce").get();
+    REQUIRE_FALSE(bad.has_value());
+    CHECK(bad.error->message.find("unknown host") != std::string::npos);
+}
+
+TEST_CASE("UdpTrackerEngine: bursts go out in sendmmsg batches; ioBatch = 1 still works") {
+    FakeUdpTrackerServer server;
+    REQUIRE(server.start());
+
+    for (std::size_t batch : {std::size_t{32}, std::size_t{1}}) {
+        auto cfg = fast_config();
+        cfg.ioBatch = batch;
+        auto cache = std::make_shared<ConnectionIdCache>();
+        UdpTrackerEngine eng(cfg, cache);
+        REQUIRE(eng.start().has_value());
+        REQUIRE(announce_async(eng, make_request(0), url_for(server)).get().has_value());  // cache the connection id
+
+        const auto before = eng.ioStats();
+        std::vector<std::future<Expected<AnnounceResponse>>> futs;
+        for (int i = 1; i <= 200; ++i) {
+            futs.push_back(announce_async(eng, make_request(static_cast<uint8_t>(i)), url_for(server)));
+        }
+        for (auto& f : futs) {
+            REQUIRE(f.wait_for(5s) == std::future_status::ready);
+            REQUIRE(f.get().has_value());
+        }
+
+        const auto after = eng.ioStats();
+        const auto sent = after.datagramsSent - before.datagramsSent;
+        const auto calls = after.sendCalls - before.sendCalls;
+        CHECK(sent >= 200);
+        CHECK(after.datagramsReceived - before.datagramsReceived >= 200);
+        if (batch == 1) CHECK(calls == sent);
+        else CHECK(calls <= sent);
+    }
+}
+
+TEST_CASE("UdpTrackerEngine: load stand-in peers, errors and loss") {
+    auto run = [](FakeUdpTrackerConfig tc, int n) {
+        FakeUdpTrackerServer tracker(tc);
+        REQUIRE(tracker.start());
+        UdpTrackerEngine eng(fast_config(), std::make_shared<ConnectionIdCache>());
+        REQUIRE(eng.start().has_value());
+
+        std::vector<std::future<Expected<AnnounceResponse>>> futs;
+        for (int i = 0; i < n; ++i) futs.push_back(announce_async(eng, make_request(static_cast<uint8_t>(i)), tracker.url()));
+        std::vector<Expected<AnnounceResponse>> out;
+        for (auto& f : futs) {
+            REQUIRE(f.wait_for(5s) == std::future_status::ready);
+            out.push_back(f.get());
+        }
+        return out;
+    };
+
+    SECTION("peer count") {
+        FakeUdpTrackerConfig tc;
+        tc.peers = 200;
+        for (auto& r : run(tc, 20)) {
+            REQUIRE(r.has_value());
+            CHECK(r.get().peers.size() == 200);
+        }
+    }
+    SECTION("error responses") {
+        FakeUdpTrackerConfig tc;
+        tc.errorRate = 1.0;
+        for (auto& r : run(tc, 5)) {
+            REQUIRE_FALSE(r.has_value());
+            CHECK(r.error->message.find("stand-in error") != std::string::npos);
+        }
+    }
+    SECTION("total loss exhausts retries") {
+        FakeUdpTrackerConfig tc;
+        tc.lossRate = 1.0;
+        for (auto& r : run(tc, 3)) {
+            REQUIRE_FALSE(r.has_value());
+            CHECK(r.error->message.find("exhausted") != std::string::npos);
+        }
+    }
+}
@@ -0,0 +1,130 @@
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+
+#include "../include/udp_engine.hpp"
+#include "../include/dns_resolver.hpp"
+#include "../include/types.hpp"
+#include "fake_udp_tracker.hpp"
+
+using namespace bittorrent::tracker;
+using namespace std::chrono_literals;
+
+// --------------------- allocation counting ---------------------
+// A separate binary, as it replaces the global operator new. Only allocations on the
+// watched threads count: the test thread (announce()) and the engine thread (all the
+// rest). The fake tracker's thread is left out.
+namespace {
+    std::atomic<bool> g_counting{false};
+    std::atomic<std::thread::id> g_testThread{}, g_engineThread{};
+    std::atomic<std::uint64_t> g_allocs{0};
+
+    void countAllocation() {
+        if (!g_counting.load(std::memory_order_relaxed)) return;
+        const auto self = std::this_thread::get_id();
+        if (self == g_testThread.load() || self == g_engineThread.load()) g_allocs.fetch_add(1);
+    }
+}
+
+// Every replaceable form, so none falls through to a sanitizer's own (and mismatches its delete).
+static void* countedAlloc(std::size_t n, std::size_t align) {
+    countAllocation();
+    if (align <= alignof(std::max_align_t)) return std::malloc(n ? n : 1);
+    return std::aligned_alloc(align, (n + align - 1) / align * align);
+}
+static void* countedAllocOrThrow(std::size_t n, std::size_t align) {
+    if (void* p = countedAlloc(n, align)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t n) { return countedAllocOrThrow(n, 0); }
+void* operator new[](std::size_t n) { return countedAllocOrThrow(n, 0); }
+void* operator new(std::size_t n, std::align_val_t a) { return countedAllocOrThrow(n, static_cast<std::size_t>(a)); }
+void* operator new[](std::size_t n, std::align_val_t a) { return countedAllocOrThrow(n, static_cast<std::size_t>(a)); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return countedAlloc(n, 0); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return countedAlloc(n, 0); }
+void* operator new(std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return countedAlloc(n, static_cast<std::size_t>(a));
+}
+void* operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return countedAlloc(n, static_cast<std::size_t>(a));
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+// --------------------- helpers ---------------------
+struct Tally {
+    std::atomic<int> done{0}, ok{0};
+};
+
+// Sends `burst` announces and waits for all of them; false if one went unanswered.
+static bool announceBurst(UdpTrackerEngine& eng, const AnnounceRequest& req, const std::string& url,
+                          Tally& tally, int burst) {
+    const int target = tally.done.load() + burst;
+    for (int i = 0; i < burst; ++i) {
+        // One pointer: fits std::function's local buffer, so the callback costs the caller nothing.
+        eng.announce(req, url, [t = &tally](Expected<AnnounceResponse> r) {
+            g_engineThread = std::this_thread::get_id();
+            if (r.has_value()) ++t->ok;
+            ++t->done;
+        });
+    }
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (tally.done.load() < target) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+// --------------------- TESTS ---------------------
+
+TEST_CASE("UdpTrackerEngine: a warmed-up announce allocates nothing") {
+    FakeUdpTrackerServer server;
+    REQUIRE(server.start());        // no peers: a peer list is the caller's to allocate
+
+    // A private resolver, so the shared one's threads stay out of it (numeric hosts never reach them).
+    UdpTrackerEngine eng(UdpEngineConfig{}, nullptr, std::make_shared<DnsResolver>());
+    REQUIRE(eng.start().has_value());
+
+    AnnounceRequest req{};
+    req.port = 51413;
+    req.left = 1;
+    req.numwant = 10;
+    const std::string url = "udp://127.0.0.1:" + std::to_string(server.port()) + "/announce";
+
+    // Warm-up: the connect, the connection-id cache entry, and every pool and table grown past
+    // what bursts of 8 need (how many of a burst are in flight at once depends on scheduling).
+    Tally tally;
+    for (int i = 0; i < 25; ++i) REQUIRE(announceBurst(eng, req, url, tally, 32));
+    REQUIRE(tally.ok == 800);
+
+    g_testThread = std::this_thread::get_id();
+    g_allocs = 0;
+    g_counting = true;
+    bool answered = true;
+    for (int i = 0; i < 100 && answered; ++i) answered = announceBurst(eng, req, url, tally, 8);
+    g_counting = false;
+
+    REQUIRE(answered);
+    CHECK(tally.ok == 1600);
+    CHECK(g_allocs.load() == 0);
+    eng.stop();
+}
@@ -13,7 +13,9 @@
 #include <mutex>
 
 #include "../include/udp_tracker.hpp"
+#include "../include/udp_url.hpp"
 #include "../include/types.hpp"
+#include "fake_udp_tracker.hpp"
 
 #if defined(_WIN32)
   #error "UDP tests are POSIX-only in this file (sockets API). Add Winsock variant if needed."
@@ -30,297 +32,6 @@
 using namespace bittorrent::tracker;
 using namespace std::chrono_literals;
 
-// --------------------- test-side byte helpers ---------------------
-static inline void t_put_u32(std::vector<uint8_t>& b, uint32_t v) {
-    b.push_back(static_cast<uint8_t>((v >> 24) & 0xFF));
-    b.push_back(static_cast<uint8_t>((v >> 16) & 0xFF));
-    b.push_back(static_cast<uint8_t>((v >>  8) & 0xFF));
-    b.push_back(static_cast<uint8_t>( v        & 0xFF));
-}
-static inline void t_put_u64(std::vector<uint8_t>& b, uint64_t v) {
-    t_put_u32(b, static_cast<uint32_t>(v >> 32));
-    t_put_u32(b, static_cast<uint32_t>(v & 0xFFFFFFFFu));
-}
-static inline uint32_t t_get_u32(const uint8_t* p) {
-    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
-}
-static inline uint64_t t_get_u64(const uint8_t* p) {
-    return (uint64_t(t_get_u32(p)) << 32) | t_get_u32(p + 4);
-}
-
-// --------------------- Fake UDP tracker server ---------------------
-class FakeUdpTrackerServer {
-public:
-    FakeUdpTrackerServer()
-      : running_(false), sock_(-1), port_(0),
-        connId_(0x0123456789ABCDEFULL),
-        sendErrorOnAnnounce_(false), errorMsg_("nope"),
-        sendErrorOnScrape_(false), errorScrapeMsg_("scrape nope"),
-        onceShortAnnounce_(false), onceActionMismatch_(false), onceWrongTx_(false),
-        connectCount_(0), announceCount_(0), scrapeCount_(0) {}
-
-    ~FakeUdpTrackerServer() { stop(); }
-
-    // Set peers returned by announce (IPv4 strings)
-    void setPeers(std::vector<std::pair<std::string,int>> peers) {
-        std::lock_guard<std::mutex> lk(mu_);
-        peers_ = std::move(peers);
-    }
-
-    // Configure scrape stats to return (seeders, completed, leechers)
-    void setScrapeTriplet(uint32_t s, uint32_t c, uint32_t l) {
-        std::lock_guard<std::mutex> lk(mu_);
-        scrapeSeeders_ = s; scrapeCompleted_ = c; scrapeLeechers_ = l;
-    }
-
-    void setErrorOnAnnounce(bool on, std::string msg = "nope") {
-        sendErrorOnAnnounce_ = on; errorMsg_ = std::move(msg);
-    }
-    void setErrorOnScrape(bool on, std::string msg = "nope") {
-        sendErrorOnScrape_ = on; errorScrapeMsg_ = std::move(msg);
-    }
-
-    // “once” behaviors to exercise client retry paths
-    void setShortAnnounceOnce(bool on = true) { onceShortAnnounce_ = on; }
-    void setActionMismatchOnce(bool on = true) { onceActionMismatch_ = on; }
-    void setWrongTxOnce(bool on = true) { onceWrongTx_ = on; }
-
-    bool start() {
-        if (running_.load()) return true;
-
-        sock_ = ::socket(AF_INET, SOCK_DGRAM, 0);
-        if (sock_ < 0) return false;
-
-        int on = 1;
-        ::setsockopt(sock_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
-
-        // Set a short receive timeout so stop() is responsive
-        timeval tv{}; tv.tv_sec = 0; tv.tv_usec = 200'000; // 200ms
-        ::setsockopt(sock_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-
-        sockaddr_in addr{}; addr.sin_family = AF_INET;
-        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // 127.0.0.1
-        addr.sin_port = htons(0); // ephemeral
-
-        if (::bind(sock_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
-            ::close(sock_); sock_ = -1; return false;
-        }
-
-        sockaddr_in bound{}; socklen_t blen = sizeof(bound);
-        if (::getsockname(sock_, reinterpret_cast<sockaddr*>(&bound), &blen) == 0) {
-            port_ = ntohs(bound.sin_port);
-        } else {
-            ::close(sock_); sock_ = -1; return false;
-        }
-
-        running_.store(true);
-        th_ = std::thread([this]{ this->loop(); });
-        return true;
-    }
-
-    void stop() {
-        if (!running_.exchange(false)) return;
-        if (th_.joinable()) th_.join();
-        if (sock_ >= 0) {
-            ::close(sock_);
-            sock_ = -1;
-        }
-    }
-
-    uint16_t port() const { return port_; }
-
-    // stats
-    int connectCount() const { return connectCount_.load(); }
-    int announceCount() const { return announceCount_.load(); }
-    int scrapeCount() const { return scrapeCount_.load(); }
-
-private:
-    void loop() {
-        while (running_.load()) {
-            uint8_t buf[65536];
-            sockaddr_storage cli{};
-            socklen_t clen = sizeof(cli);
-
-            const ssize_t n = ::recvfrom(sock_, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&cli), &clen);
-            if (n <= 0) continue;
-
-            // Determine action (connect has protocol id first; action at offset 8)
-            if (n < 12) continue; // malformed
-
-            const uint32_t action = t_get_u32(buf + 8);
-            const uint32_t tx     = t_get_u32(buf + 12);
-
-            switch (action) {
-                case 0: // connect
-                    connectCount_.fetch_add(1);
-                    send_connect(cli, clen, tx);
-                    break;
-                case 1: // announce
-                    announceCount_.fetch_add(1);
-                    if (sendErrorOnAnnounce_) {
-                        send_error(cli, clen, tx, errorMsg_);
-                    } else if (onceShortAnnounce_) {
-                        onceShortAnnounce_ = false;
-                        send_announce_truncated(cli, clen, tx);
-                    } else if (onceActionMismatch_) {
-                        onceActionMismatch_ = false;
-                        send_announce_action_mismatch(cli, clen, tx);
-                    } else if (onceWrongTx_) {
-                        onceWrongTx_ = false;
-                        send_announce_wrong_tx(cli, clen, tx);
-                    } else {
-                        send_announce(cli, clen, tx);
-                    }
-                    break;
-                case 2: // scrape
-                    scrapeCount_.fetch_add(1);
-                    if (sendErrorOnScrape_) {
-                        send_error(cli, clen, tx, errorScrapeMsg_);
-                    } else {
-                        send_scrape(cli, clen, tx, n);
-                    }
-                    break;
-                default:
-                    send_error(cli, clen, tx, "unsupported action");
-                    break;
-            }
-        }
-    }
-
-    void send_connect(const sockaddr_storage& cli, socklen_t clen, uint32_t tx) {
-        // Response: action(0), tx, connection_id(64)
-        std::vector<uint8_t> out;
-        t_put_u32(out, 0u);
-        t_put_u32(out, tx);
-        t_put_u64(out, connId_);
-        ::sendto(sock_, out.data(), out.size(), 0, reinterpret_cast<const sockaddr*>(&cli), clen);
-    }
-
-    void send_announce_truncated(const sockaddr_storage& cli, socklen_t clen, uint32_t tx) {
-        // Only 12 bytes (action + tx), deliberately shorter than 20 required bytes.
-        std::vector<uint8_t> out;
-        t_put_u32(out, 1u);      // action=announce
-        t_put_u32(out, tx);      // same tx
-        // no body
-        ::sendto(sock_, out.data(), out.size(), 0, reinterpret_cast<const sockaddr*>(&cli), clen);
-    }
-
-    void send_announce_action_mismatch(const sockaddr_storage& cli, socklen_t clen, uint32_t tx) {
-        // action=2 (scrape) but in response to announce; include 12 more bytes so n>=20
-        std::vector<uint8_t> out;
-        t_put_u32(out, 2u);      // wrong action
-        t_put_u32(out, tx);
-        t_put_u32(out, 0);
-        t_put_u32(out, 0);
-        t_put_u32(out, 0);
-        ::sendto(sock_, out.data(), out.size(), 0, reinterpret_cast<const sockaddr*>(&cli), clen);
-    }
-
-    void send_announce_wrong_tx(const sockaddr_storage& cli, socklen_t clen, uint32_t tx) {
-        // Correct action but wrong tx; full announce body present (ignored by client).
-        uint32_t interval = 900, leech = 5, seed = 3;
-        std::vector<uint8_t> out;
-        t_put_u32(out, 1u);
-        t_put_u32(out, tx + 1u); // wrong transaction id
-        t_put_u32(out, interval);
-        t_put_u32(out, leech);
-        t_put_u32(out, seed);
-        // no peers needed; it's a mismatch anyway
-        ::sendto(sock_, out.data(), out.size(), 0, reinterpret_cast<const sockaddr*>(&cli), clen);
-    }
-
-    void send_announce(const sockaddr_storage& cli, socklen_t clen, uint32_t tx) {
-        // Response: action(1), tx, interval, leechers, seeders, peers...
-        uint32_t interval = 900, leech = 5, seed = 3;
-
-        std::vector<uint8_t> out;
-        t_put_u32(out, 1u);
-        t_put_u32(out, tx);
-        t_put_u32(out, interval);
-        t_put_u32(out, leech);
-        t_put_u32(out, seed);
-
-        std::vector<std::pair<std::string,int>> peersCopy;
-        {
-            std::lock_guard<std::mutex> lk(mu_);
-            peersCopy = peers_;
-        }
-        for (auto& [ip, port] : peersCopy) {
-            in_addr ina{};
-            ::inet_pton(AF_INET, ip.c_str(), &ina);
-            const uint32_t ipn = ntohl(ina.s_addr); // convert to host order for packing
-            t_put_u32(out, ipn);
-            out.push_back(static_cast<uint8_t>((port >> 8) & 0xFF));
-            out.push_back(static_cast<uint8_t>(port & 0xFF));
-        }
-
-        ::sendto(sock_, out.data(), out.size(), 0, reinterpret_cast<const sockaddr*>(&cli), clen);
-    }
-
-    void send_scrape(const sockaddr_storage& cli, socklen_t clen, uint32_t tx, ssize_t n) {
-        // Request body after header is 20*N info_hashes.
-        // Response: action(2), tx, then for each hash: seeders, completed, leechers.
-        (void)n;
-        uint32_t seeders, completed, leechers;
-        {
-            std::lock_guard<std::mutex> lk(mu_);
-            seeders = scrapeSeeders_; completed = scrapeCompleted_; leechers = scrapeLeechers_;
-        }
-
-        std::vector<uint8_t> out;
-        t_put_u32(out, 2u);
-        t_put_u32(out, tx);
-
-        int N = 1;
-        if (n >= 16) {
-            const ssize_t body = n - 16;
-            if (body >= 0) N = static_cast<int>(body / 20);
-        }
-        if (N <= 0) N = 1;
-
-        for (int i = 0; i < N; ++i) {
-            t_put_u32(out, seeders);
-            t_put_u32(out, completed);
-            t_put_u32(out, leechers);
-        }
-
-        ::sendto(sock_, out.data(), out.size(), 0, reinterpret_cast<const sockaddr*>(&cli), clen);
-    }
-
-    void send_error(const sockaddr_storage& cli, socklen_t clen, uint32_t tx, const std::string& msg) {
-        std::vector<uint8_t> out;
-        t_put_u32(out, 3u);
-        t_put_u32(out, tx);
-        out.insert(out.end(), msg.begin(), msg.end());
-        ::sendto(sock_, out.data(), out.size(), 0, reinterpret_cast<const sockaddr*>(&cli), clen);
-    }
-
-private:
-    std::atomic<bool> running_;
-    int sock_;
-    uint16_t port_;
-    uint64_t connId_;
-
-    std::vector<std::pair<std::string,int>> peers_;
-    uint32_t scrapeSeeders_{12}, scrapeCompleted_{34}, scrapeLeechers_{56};
-
-    std::atomic<int> connectCount_;
-    std::atomic<int> announceCount_;
-    std::atomic<int> scrapeCount_;
-
-    bool sendErrorOnAnnounce_;
-    std::string errorMsg_;
-    bool sendErrorOnScrape_;
-    std::string errorScrapeMsg_;
-
-    bool onceShortAnnounce_;
-    bool onceActionMismatch_;
-    bool onceWrongTx_;
-
-    std::thread th_;
-    std::mutex mu_;
-};
-
 // --------------------- helpers ---------------------
 static InfoHash make_infohash(uint8_t seed = 0x00) {
     InfoHash ih{};
@@ -365,10 +76,10 @@ TEST_CASE("UdpTracker: announce returns peers and stats (happy path)") {
     CHECK(ar.complete   == 3);
 
     REQUIRE(ar.peers.size() == 2);
-    CHECK(ar.peers[0].ip == "127.1.2.3");
-    CHECK(ar.peers[0].port == 6881);
-    CHECK(ar.peers[1].ip == "10.0.0.2");
-    CHECK(ar.peers[1].port == 80);
+    CHECK(ar.peers[0].ip() == "127.1.2.3");
+    CHECK(ar.peers[0].port() == 6881);
+    CHECK(ar.peers[1].ip() == "10.0.0.2");
+    CHECK(ar.peers[1].port() == 80);
 
     // Ensure server saw a connect before/with announce
     CHECK(server.connectCount() >= 1);
@@ -496,7 +207,7 @@ TEST_CASE("UdpTracker: truncated announce once -> client retries and succeeds")
 
     REQUIRE(res.has_value());
     CHECK(res.get().peers.size() == 1);
-    CHECK(res.get().peers[0].ip == "127.0.0.9");
+    CHECK(res.get().peers[0].ip() == "127.0.0.9");
 
     // Expect at least one retry delay (~ >= 1s); keep this tolerant
     CHECK(std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count() >= 1000);
@@ -527,7 +238,7 @@ TEST_CASE("UdpTracker: action mismatch once -> client retries and succeeds") {
 
     REQUIRE(res.has_value());
     CHECK(res.get().peers.size() == 1);
-    CHECK(res.get().peers[0].ip == "127.0.0.7");
+    CHECK(res.get().peers[0].ip() == "127.0.0.7");
 
     // Expect at least one retry delay (~ >= 1s)
     CHECK(std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count() >= 1000);
@@ -591,3 +302,110 @@ TEST_CASE("UdpTracker: fresh instance causes a new connect (connId is not global
 
     server.stop();
 }
+
+TEST_CASE("UdpTracker: instances sharing a ConnectionIdCache reuse the connection id") {
+    FakeUdpTrackerServer server;
+    REQUIRE(server.start());
+    server.setPeers({{"127.0.0.5", 7777}});
+
+    const std::string url = "udp://127.0.0.1:" + std::to_string(server.port()) + "/announce";
+    auto cache = std::make_shared<ConnectionIdCache>();
+
+    for (uint8_t i = 0; i < 3; ++i) {
+        UdpTracker udp(cache);
+        AnnounceRequest req{};
+        req.infoHash = make_infohash(0x50 + i);
+        req.peerId   = make_peerid(i);
+        req.left     = 1;
+        auto r = udp.announce(req, url);
+        REQUIRE(r.has_value());
+    }
+
+    CHECK(server.connectCount() == 1);
+    CHECK(server.announceCount() == 3);
+    CHECK(cache->size() == 1);
+
+    server.stop();
+}
+
+TEST_CASE("ConnectionIdCache: keyed by address and port, honours expiry") {
+    auto v4 = [](const char* ip, uint16_t port) {
+        sockaddr_storage ss{};
+        auto& a = reinterpret_cast<sockaddr_in&>(ss);
+        a.sin_family = AF_INET;
+        a.sin_port = htons(port);
+        ::inet_pton(AF_INET, ip, &a.sin_addr);
+        return ss;
+    };
+    const auto now = ConnectionIdCache::Clock::now();
+
+    ConnectionIdCache cache;
+    cache.put(v4("10.0.0.1", 6969), 11, now + 60s);
+    cache.put(v4("10.0.0.1", 6970), 22, now + 60s);
+    cache.put(v4("10.0.0.2", 6969), 33, now + 1s);
+
+    REQUIRE(cache.get(v4("10.0.0.1", 6969), now).has_value());
+    CHECK(cache.get(v4("10.0.0.1", 6969), now)->connId == 11);
+    CHECK(cache.get(v4("10.0.0.1", 6970), now)->connId == 22);
+    CHECK_FALSE(cache.get(v4("10.0.0.2", 6969), now + 2s).has_value());
+    CHECK(cache.size() == 2);
+
+    cache.invalidate(v4("10.0.0.1", 6969), 99);     // stale id: ignored
+    CHECK(cache.get(v4("10.0.0.1", 6969), now).has_value());
+    cache.invalidate(v4("10.0.0.1", 6969), 11);
+    CHECK_FALSE(cache.get(v4("10.0.0.1", 6969), now).has_value());
+}
+
+TEST_CASE("parse_udp_url_minimal: bracketed IPv6 literals") {
+    using bittorrent::tracker::detail::parse_udp_url_minimal;
+
+    auto a = parse_udp_url_minimal("udp://[2001:db8::1]:6970/announce");
+    REQUIRE(a.has_value());
+    CHECK(a->host == "2001:db8::1");
+    CHECK(a->port == 6970);
+
+    auto b = parse_udp_url_minimal("udp://[::1]/announce");
+    REQUIRE(b.has_value());
+    CHECK(b->host == "::1");
+    CHECK(b->port == 6969);
+
+    auto c = parse_udp_url_minimal("udp://tracker.example.org:1337");
+    REQUIRE(c.has_value());
+    CHECK(c->host == "tracker.example.org");
+    CHECK(c->port == 1337);
+
+    CHECK_FALSE(parse_udp_url_minimal("udp://[::1/announce").has_value());     // unclosed
+    CHECK_FALSE(parse_udp_url_minimal("udp://[::1]x/announce").has_value());   // junk after ]
+    CHECK_FALSE(parse_udp_url_minimal("udp://[]:6969/announce").has_value());  // empty host
+    CHECK_FALSE(parse_udp_url_minimal("udp://[::1]:99999/announce").has_value());
+}
+
+TEST_CASE("UdpTracker: IPv6 tracker returns 18-byte peer entries") {
+    FakeUdpTrackerServer server;
+    if (!server.start(AF_INET6)) {
+        WARN("no IPv6 loopback on this host; skipping");
+        return;
+    }
+    server.setPeers({{"2001:db8::7", 6881}, {"fe80::1", 51413}});
+
+    UdpTracker udp;
+    AnnounceRequest req{};
+    req.infoHash = make_infohash(0x06);
+    req.peerId   = make_peerid(0x66);
+    req.port     = 51413;
+    req.left     = 1;
+    req.numwant  = 10;
+
+    const std::string url = "udp://[::1]:" + std::to_string(server.port()) + "/announce";
+    auto res = udp.announce(req, url);
+    REQUIRE(res.has_value());
+    REQUIRE(res.get().peers.size() == 2);
+    CHECK(res.get().peers[0].ip() == "2001:db8::7");
+    CHECK(res.get().peers[0].port() == 6881);
+    CHECK(res.get().peers[1].ip() == "fe80::1");
+    CHECK(res.get().peers[1].port() == 51413);
+
+    auto sc = udp.scrape({make_infohash(0x06)}, "udp://[::1]:" + std::to_string(server.port()) + "/scrape");
+    REQUIRE(sc.has_value());
+    CHECK(sc.get().size() == 1);
+}
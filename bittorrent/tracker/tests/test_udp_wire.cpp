@@ -0,0 +1,123 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "../include/packet_pool.hpp"
+#include "../include/udp_wire.hpp"
+#include "../include/types.hpp"
+
+using namespace bittorrent::tracker;
+
+// --------------------- helpers ---------------------
+static AnnounceRequest make_request() {
+    AnnounceRequest req{};
+    for (std::size_t i = 0; i < 20; ++i) {
+        req.infoHash.bytes[i] = static_cast<uint8_t>(i);
+        req.peerId.bytes[i]   = static_cast<uint8_t>(0xA0 + i);
+    }
+    req.downloaded = 0x0102030405060708ULL;
+    req.left       = 7;
+    req.uploaded   = 9;
+    req.event      = AnnounceEvent::stopped;
+    req.key        = 0xCAFEBABE;
+    req.numwant    = 0;         // => -1 on the wire
+    req.port       = 51413;
+    return req;
+}
+
+// --------------------- TESTS ---------------------
+
+TEST_CASE("wire: connect request layout") {
+    uint8_t out[wire::kHeaderSize];
+    REQUIRE(wire::encodeConnect(out, 0x11223344u) == 16);
+    CHECK(wire::load_be64(out) == wire::kProtocolId);
+    CHECK(wire::load_be32(out + 8) == 0u);
+    CHECK(wire::load_be32(out + 12) == 0x11223344u);
+}
+
+TEST_CASE("wire: announce request layout (BEP 15 offsets)") {
+    const auto req = make_request();
+    uint8_t out[PacketBuffer::kCapacity] = {};
+    REQUIRE(wire::encodeAnnounce(out, 0xDEADBEEF00C0FFEEULL, 42, req) == 98);
+
+    CHECK(wire::load_be64(out) == 0xDEADBEEF00C0FFEEULL);
+    CHECK(wire::load_be32(out + 8) == 1u);
+    CHECK(wire::load_be32(out + 12) == 42u);
+    CHECK(out[16] == 0);
+    CHECK(out[35] == 19);
+    CHECK(out[36] == 0xA0);
+    CHECK(wire::load_be64(out + 56) == 0x0102030405060708ULL);
+    CHECK(wire::load_be64(out + 64) == 7);
+    CHECK(wire::load_be64(out + 72) == 9);
+    CHECK(wire::load_be32(out + 80) == 3u);            // stopped
+    CHECK(wire::load_be32(out + 84) == 0u);
+    CHECK(wire::load_be32(out + 88) == 0xCAFEBABEu);
+    CHECK(wire::load_be32(out + 92) == 0xFFFFFFFFu);
+    CHECK(out[96] == (51413 >> 8));
+    CHECK(out[97] == (51413 & 0xFF));
+}
+
+TEST_CASE("wire: scrape request is capped at 74 hashes") {
+    std::vector<InfoHash> hashes(80);
+    for (std::size_t i = 0; i < hashes.size(); ++i) hashes[i].bytes[0] = static_cast<uint8_t>(i);
+
+    PacketBuffer buf;
+    buf.len = wire::encodeScrape(buf.data, 5, 6, hashes);
+    CHECK(buf.len == 16 + 74 * 20);
+    CHECK(buf.len <= PacketBuffer::kCapacity);
+    CHECK(wire::load_be32(buf.data + 8) == 2u);
+    CHECK(buf.data[16 + 73 * 20] == 73);
+}
+
+TEST_CASE("PacketPool: aligned buffers, reuse, growth") {
+    PacketPool pool(4);
+    CHECK(pool.capacity() == 4);
+
+    std::vector<PacketBuffer*> held;
+    for (int i = 0; i < 6; ++i) {
+        held.push_back(pool.acquire());
+        CHECK(reinterpret_cast<std::uintptr_t>(held.back()->data) % 64 == 0);
+    }
+    CHECK(pool.capacity() == 8);        // grew by one slab
+    CHECK(pool.available() == 2);
+
+    for (auto* b : held) pool.release(b);
+    CHECK(pool.available() == 8);
+
+    PacketBuffer* again = pool.acquire();
+    CHECK(again == held.back());        // LIFO: the hottest buffer comes back first
+    pool.release(again);
+}
+
+TEST_CASE("PacketPool + encoders: steady state stays within the preallocated slab") {
+    PacketPool pool(64);
+    const auto req = make_request();
+    const std::vector<InfoHash> hashes(74);
+
+    std::set<PacketBuffer*> slab;
+    std::vector<PacketBuffer*> held;
+    held.reserve(64);
+    for (int i = 0; i < 64; ++i) held.push_back(pool.acquire());
+    slab.insert(held.begin(), held.end());
+    for (auto* b : held) pool.release(b);
+    held.clear();
+
+    for (int round = 0; round < 1000; ++round) {
+        for (int i = 0; i < 64; ++i) {
+            PacketBuffer* b = pool.acquire();
+            b->len = (i % 3 == 0) ? wire::encodeConnect(b->data, i)
+                   : (i % 3 == 1) ? wire::encodeAnnounce(b->data, 1, i, req)
+                                  : wire::encodeScrape(b->data, 1, i, hashes);
+            held.push_back(b);
+        }
+        for (auto* b : held) {
+            REQUIRE(slab.count(b) == 1);
+            pool.release(b);
+        }
+        held.clear();
+    }
+    CHECK(pool.capacity() == 64);       // never grew, so never allocated
+    CHECK(pool.available() == 64);
+}